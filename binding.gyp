@@ -10,6 +10,12 @@
             "src/grandiose_send.cc",
             "src/grandiose_receive.cc",
             "src/grandiose_routing.cc",
+            "src/grandiose_pool.cc",
+            "src/grandiose_convert.cc",
+            "src/grandiose_mux.cc",
+            "src/grandiose_playout.cc",
+            "src/grandiose_signal.cc",
+            "src/grandiose_framesync.cc",
             "src/grandiose.cc"
         ],
         "include_dirs": [ "ndi/include" ],
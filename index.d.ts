@@ -9,6 +9,9 @@ export interface AudioFrame {
   timestamp: [number, number] // PTP timestamp
   timecode: [number, number] // timecode as PTP value
   data: Buffer
+  channelData?: Float32Array[] // zero-copy planar float frames only
+  release?: () => void // present on zero-copy frames only
+  metadata?: string // XML sent with the frame
 }
 
 export interface VideoFrame {
@@ -23,33 +26,249 @@ export interface VideoFrame {
   frameFormatType: FrameType
   timecode: [ number, number ] // Measured in nanoseconds
   lineStrideBytes: number
-  data: Buffer
+  data: Buffer // the into buffer if one was given
+  release?: () => void // present on zero-copy, converted and pooled frames
+  metadata?: string // XML sent with the frame
+}
+
+export type VideoFormat = Pick<VideoFrame, 'xres' | 'yres' | 'frameRateN' | 'frameRateD' |
+  'fourCC' | 'pictureAspectRatio' | 'frameFormatType' | 'lineStrideBytes'> & VideoConversion
+
+// Conversion of RGBA, RGBX, BGRA, BGRX, I420, YV12 or NV12 video on send
+export interface VideoConversion {
+  convertTo?: FourCC.UYVY
+  colorMatrix?: ColorMatrix // defaults to Auto
+  roi?: VideoRegion // UYVY, RGBA, RGBX, BGRA and BGRX only
+}
+
+// Region of the frame to send, defaulting to the rest of the frame from x, y
+export interface VideoRegion {
+  x?: number
+  y?: number
+  width?: number
+  height?: number
+}
+
+export interface MetadataFrame {
+  type: 'metadata'
+  length: number
+  timecode: [number, number]
+  data: string
+}
+
+export interface StatusChange {
+  type: 'statusChange'
+}
+
+export interface CaptureOptions {
+  wait?: number // ms per native capture call, bounds how quickly stop() completes
+  queue?: number // frames queued for the main thread before dropping
+  audioFormat?: AudioFormat
+  referenceLevel?: number
+}
+
+export interface FrameCounts {
+  video: number
+  audio: number
+  metadata: number
+}
+
+export interface ReceiverStats {
+  time: number // ms since the epoch
+  connections: number
+  total: FrameCounts // received by NDI
+  dropped: FrameCounts // dropped by NDI
+  queued: FrameCounts // waiting in NDI to be captured
+  pending: FrameCounts // waiting in frame queues for JavaScript
+  discarded: FrameCounts // dropped because JavaScript fell behind
+}
+
+export interface FrameSync {
+  embedded: unknown
+  video: (params?: {
+    frameFormatType?: FrameType
+    into?: Buffer
+  }) => VideoFrame | null
+  audio: (samples: number, params?: {
+    sampleRate?: number // Hz, defaults to the source's
+    channels?: number // defaults to the source's
+    audioFormat?: AudioFormat
+    referenceLevel?: number
+    into?: Buffer
+  }) => AudioFrame
+  audioQueueDepth: () => number
+  destroy: () => void
+}
+
+export interface FrameQueueStats {
+  depth: number
+  queued: number
+  received: number
+  dropped: number
 }
 
 export interface Receiver {
   embedded: unknown
-  video: (timeout?: number) => Promise<VideoFrame>
+  video: ((timeout?: number) => Promise<VideoFrame>) &
+    ((params: { into?: Buffer }, timeout?: number) => Promise<VideoFrame>)
   audio: (params: {
     audioFormat: AudioFormat
     referenceLevel: number
+    into?: Buffer
   }, timeout?: number) => Promise<AudioFrame>
   metadata: any
   data: any
+  start: (params?: CaptureOptions) => void
+  stop: () => Promise<void>
+  transfer: () => string // token for adopt(), while not capturing
+  usePool: (size: number) => void // buffers kept for captured video, 0 for none
+  frameSync: () => FrameSync
+  stats: () => ReceiverStats
+  sampleStats: (params: { interval: number, size?: number }) => void // interval in ms, 0 stops
+  statsHistory: () => ReceiverStats[] // oldest first
+  queues: () => {
+    video: FrameQueueStats
+    audio: FrameQueueStats
+    metadata: FrameQueueStats
+  }
+  frames: (params?: CaptureOptions & {
+    highWaterMark?: number
+  }) => AsyncIterableIterator<VideoFrame | AudioFrame | MetadataFrame | StatusChange>
   source: Source
   colorFormat: ColorFormat
   bandwidth: Bandwidth
   allowVideoFields: boolean
+  zeroCopy: boolean
 }
 
 export interface Sender {
   embedded: unknown
   destroy: () => Promise<void>
-  video: (frame: VideoFrame) => Promise<void>
-  audio: (frame: AudioFrame) => Promise<void>
+  transfer: () => Promise<string> // token for adopt()
+  video: (frame: VideoFrame & VideoConversion) => Promise<{ dropped?: boolean }>
+  audio: (frame: AudioFrame) => Promise<{ dropped?: boolean }>
+  metadata: (data: string | string[], timecode?: number | bigint) => Promise<{ dropped?: boolean }>
+  configureVideo: (format: VideoFormat) => Promise<void>
+  videoData: (data: Buffer, timecode?: number | bigint) => Promise<{ dropped?: boolean }>
+  configureAudio: (format: AudioMuxFormat) => Promise<void>
+  audioData: (data: Buffer) => number
+  playFile: (path: string, options?: PlayoutOptions) => Promise<{ sent: number, skipped: number, position: number }>
+  testSignal: (options?: TestSignalOptions) => Promise<{ sent: number, skipped: number, position: number }>
+  cue: (frame: number) => void
+  stopPlayout: () => Promise<void>
+  playout: () => PlayoutStats | null
+  flush: () => Promise<void>
+  stats: () => SenderStats
+  connections: () => number
+  tally: () => { changed: boolean, on_program: boolean, on_preview: boolean }
+  sourcename: () => string
+  captureMetadata: (timeout?: number) => Promise<MetadataFrame>
+  startMetadataCapture: (listener: (frame: MetadataFrame) => void, options?: { wait?: number }) => void
+  stopMetadataCapture: () => Promise<void>
+  startMonitor: (listener: (event: SenderEvent) => void, options?: { wait?: number }) => void
+  stopMonitor: () => Promise<void>
+  allocateFrames: (count: number, options?: { size?: number, hugePages?: boolean }) => Buffer[]
+  acquireFrame: () => Buffer | null
+  framePool: () => FramePoolStats
   name: string
   groups?: string | string[]
   clockVideo: boolean
   clockAudio: boolean
+  asyncVideo: boolean
+}
+
+export interface SendGroup {
+  embedded: unknown
+  senders: Sender[]
+  video: (frame: VideoFrame & VideoConversion) => Promise<{ sent: number, dropped: number }>
+}
+
+export interface PlayoutOptions {
+  // Required for raw files, taken from the header of Y4M files
+  fourCC?: FourCC
+  xres?: number
+  yres?: number
+  lineStrideBytes?: number
+  frameFormatType?: FrameType
+  pictureAspectRatio?: number
+  frameRateN?: number
+  frameRateD?: number
+  fps?: number
+  loop?: boolean
+  inPoint?: number
+  outPoint?: number // exclusive, defaults to the end of the file
+  readahead?: number // frames, default 8
+  audio?: string | boolean // WAV file, defaults to the file's name with .wav
+}
+
+export interface PlayoutStats {
+  fourCC: FourCC
+  xres: number
+  yres: number
+  frameRateN: number
+  frameRateD: number
+  pattern?: TestPattern // test signals only
+  frames?: number // files only, as are inPoint, outPoint and loop
+  inPoint?: number
+  outPoint?: number
+  loop?: boolean
+  position: number
+  sent: number
+  skipped: number
+  sampleRate?: number
+  noChannels?: number
+}
+
+export type TestPattern = 'bars' | 'ramp' | 'zoneplate' | 'frameCounter'
+
+export interface TestSignalOptions {
+  pattern?: TestPattern // default 'bars'
+  fourCC?: FourCC // UYVY, RGBA, RGBX, BGRA, BGRX, I420 or NV12, default UYVY
+  xres?: number // default 1920
+  yres?: number // default 1080
+  frameRateN?: number // default 30000
+  frameRateD?: number // default 1001
+  fps?: number
+  audio?: boolean // 1kHz tone, default true
+  sampleRate?: number // default 48000
+  noChannels?: number // default 2
+}
+
+export interface AudioMuxFormat {
+  sampleRate: number
+  noChannels: number
+  offset?: number // samples, positive delays audio against video
+  bufferSamples?: number // default one second
+}
+
+export type SenderEvent =
+  { type: 'tally', on_program: boolean, on_preview: boolean } |
+  { type: 'connections', connections: number }
+
+export interface FramePoolStats {
+  frames: number
+  free: number
+  acquired: number
+  inFlight: number
+  hugePages: number
+  bytes: number
+}
+
+export type OverflowPolicy = 'block' | 'drop-oldest' | 'drop-newest'
+
+export interface SenderStats {
+  queueDepth: number
+  overflow: OverflowPolicy
+  queued: number
+  waiting: number
+  submitted: number
+  sent: number
+  dropped: number
+  repeated?: number // with holdLastFrame
+  stalls?: number
+  audioBuffered?: number
+  audioSilence?: number
+  audioDiscarded?: number
 }
 
 export interface Routing {
@@ -98,6 +317,13 @@ export const enum FourCC {
   RGBX = 1480738642
 }
 
+export const enum ColorMatrix {
+  BT601 = 0,
+  BT709 = 1,
+  BT2020 = 2,
+  Auto = 255 // BT.601 below 720 lines, otherwise BT.709
+}
+
 export const enum AudioFormat {
   Float32Separate = 0,
   Float32Interleaved = 1,
@@ -122,6 +348,12 @@ export function receive(params: {
   colorFormat?: ColorFormat
   bandwidth?: Bandwidth
   allowVideoFields?: boolean
+  zeroCopy?: boolean
+  outputFormat?: FourCC.RGBA | FourCC.RGBX | FourCC.BGRA | FourCC.BGRX | FourCC.I420 | FourCC.NV12
+  colorMatrix?: ColorMatrix // for RGB output, defaults to Auto
+  fullRange?: boolean // range of the source Y'CbCr for RGB output, default false
+  queueDepth?: number // frames of each type queued for video(), audio() and metadata(), default 8
+  delivery?: string // video frames passed on: 'all' (default), 'latest', 'every:N' or 'maxFps:X'
   name?: string
 }): Receiver
 
@@ -130,10 +362,60 @@ export function send(params: {
   groups?: string | string[]
   clockVideo?: boolean
   clockAudio?: boolean
+  asyncVideo?: boolean
+  holdLastFrame?: boolean
+  queueDepth?: number
+  overflow?: OverflowPolicy
 }): Sender
 
+export function sendGroup(senders: Sender[]): SendGroup
+
+export function testSignal(params: {
+  name: string
+  groups?: string | string[]
+  clockVideo?: boolean
+  clockAudio?: boolean
+} & TestSignalOptions): Promise<Sender & {
+  ended: Promise<{ sent: number, skipped: number, position: number }>
+}>
+
+// Takes a sender or receiver handed on with transfer(), in any worker thread
+export function adopt(token: string): Promise<Sender | Receiver>
+
 export function routing(params: {
   name: string
   groups?: string | string[]
 }): Routing
 
+
+export interface WorkerLaneStats {
+  size: number // maximum threads, before those reserved
+  reserved: number // threads added for open receivers
+  threads: number // threads started
+  busy: number
+  queued: number
+  maxQueued: number
+  submitted: number
+  totalWait: number // ms spent queued, summed over all work
+  maxWait: number // ms
+  totalRun: number // ms spent running, summed over all work
+}
+
+export interface WorkerStats {
+  video: WorkerLaneStats
+  audio: WorkerLaneStats
+  metadata: WorkerLaneStats
+  data: WorkerLaneStats
+  send: WorkerLaneStats
+}
+
+export function configureWorkers(params: {
+  size?: number
+  video?: number
+  audio?: number
+  metadata?: number
+  data?: number
+  send?: number
+}): WorkerStats
+
+export function workerStats(): WorkerStats
@@ -49,6 +49,13 @@ const COLOR_FORMAT_BGRX_BGRA_FLIPPED = 200;
 
 const COLOR_FORMAT_FASTEST = 100;
 
+// Colour matrices for video converted with convertTo. Automatic selection
+// uses BT.601 below 720 lines and BT.709 otherwise.
+const COLOR_MATRIX_BT601 = 0;
+const COLOR_MATRIX_BT709 = 1;
+const COLOR_MATRIX_BT2020 = 2;
+const COLOR_MATRIX_AUTO = 255;
+
 const BANDWIDTH_METADATA_ONLY = -10; // Receive metadata.
 const BANDWIDTH_AUDIO_ONLY    =  10; // Receive metadata, audio.
 const BANDWIDTH_LOWEST        =  0; // Receive metadata, audio, video at a lower bandwidth and resolution.
@@ -80,21 +87,142 @@ let find = function (...args) {
   return addon.find.apply(null, args);
 }
 
+// Async iterator over the frames delivered by a receiver's capture thread.
+// Frames are queued up to highWaterMark, beyond which the oldest is dropped.
+let frameIterator = function (iterators, highWaterMark) {
+  let queue = [];
+  let waiting = [];
+  let done = false;
+  let release = frame => { if (typeof frame.release === 'function') frame.release(); };
+  let sink = {
+    push: frame => {
+      if (waiting.length > 0) return waiting.shift()({ value: frame, done: false });
+      queue.push(frame);
+      if (queue.length > highWaterMark) release(queue.shift());
+    },
+    end: () => {
+      done = true;
+      iterators.delete(sink);
+      waiting.forEach(resolve => resolve({ value: undefined, done: true }));
+      waiting = [];
+    }
+  };
+  iterators.add(sink);
+  return {
+    next: () => {
+      if (queue.length > 0) return Promise.resolve({ value: queue.shift(), done: false });
+      if (done) return Promise.resolve({ value: undefined, done: true });
+      return new Promise(resolve => waiting.push(resolve));
+    },
+    return: () => {
+      queue.forEach(release);
+      queue = [];
+      sink.end();
+      return Promise.resolve({ value: undefined, done: true });
+    },
+    [Symbol.asyncIterator]: function () { return this; }
+  };
+}
+
+// A frame with release() that is pushed to several iterators gets one view
+// per iterator, each with its own release(). The frame itself is released
+// once every iterator has released or dropped its view.
+let shareFrame = function (frame, count) {
+  let release = frame.release;
+  return () => {
+    let held = true;
+    return Object.assign({}, frame, {
+      release: () => {
+        if (!held) return;
+        held = false;
+        if (--count === 0) release.call(frame);
+      }
+    });
+  };
+}
+
+// Adds frames() and its capture thread handling to a native receiver
+let wrapReceiver = function (receiver) {
+  let start = receiver.start;
+  let stop = receiver.stop;
+  let iterators = new Set();
+  let running = false;
+  receiver.start = function (options) {
+    start.call(receiver, frame => {
+      if (iterators.size > 1 && typeof frame.release === 'function') {
+        let view = shareFrame(frame, iterators.size);
+        iterators.forEach(sink => sink.push(view()));
+        return;
+      }
+      if (iterators.size === 0 && typeof frame.release === 'function') frame.release();
+      iterators.forEach(sink => sink.push(frame));
+    }, options);
+    running = true;
+  };
+  receiver.stop = function () {
+    running = false;
+    return stop.call(receiver).then(() => {
+      iterators.forEach(sink => sink.end());
+    });
+  };
+  receiver.frames = function (options) {
+    let highWaterMark = (options && options.highWaterMark) || 8;
+    let iterator = frameIterator(iterators, highWaterMark);
+    if (!running) receiver.start(options);
+    return iterator;
+  };
+  return receiver;
+}
+
+let receive = function (...args) {
+  return addon.receive.apply(null, args).then(wrapReceiver);
+}
+
+// Takes a sender or receiver handed on with transfer(), from this or another
+// worker thread
+let adopt = function (token) {
+  return addon.adopt(token).then(handle =>
+    typeof handle.start === 'function' ? wrapReceiver(handle) : handle);
+}
+
+// Creates a sender that sends a test signal rendered on its own thread.
+// Resolves with the sender once the signal has started, with the promise of
+// how the signal ended as its ended property.
+let testSignal = function (options) {
+  return addon.send(options).then(sender => {
+    let ended = sender.testSignal(options);
+    if (sender.playout() === null) { // Options were rejected
+      return ended.catch(err => sender.destroy().then(() => { throw err; }));
+    }
+    // Handled here so that a signal nobody waits on is not an unhandled
+    // rejection, while sender.ended still rejects for those who do
+    ended.catch(() => {});
+    sender.ended = ended;
+    return sender;
+  });
+}
+
 module.exports = {
   version: addon.version,
   isSupportedCPU: addon.isSupportedCPU,
   initialize: addon.initialize,
   destroy: addon.destroy,
   find: find,
-  receive: addon.receive,
+  receive: receive,
   send: addon.send,
+  sendGroup: addon.sendGroup,
+  testSignal: testSignal,
   routing: addon.routing,
+  adopt: adopt,
+  configureWorkers: addon.configureWorkers,
+  workerStats: addon.workerStats,
   COLOR_FORMAT_BGRX_BGRA, COLOR_FORMAT_UYVY_BGRA,
   COLOR_FORMAT_RGBX_RGBA, COLOR_FORMAT_UYVY_RGBA,
   COLOR_FORMAT_BGRX_BGRA_FLIPPED, COLOR_FORMAT_FASTEST,
   FOURCC_UYVY, FOURCC_UYVA, FOURCC_P216, FOURCC_PA16, FOURCC_YV12,
   FOURCC_I420, FOURCC_NV12, FOURCC_BGRA, FOURCC_BGRX, FOURCC_RGBA, FOURCC_RGBX,
   FOURCC_FLTp,
+  COLOR_MATRIX_BT601, COLOR_MATRIX_BT709, COLOR_MATRIX_BT2020, COLOR_MATRIX_AUTO,
   BANDWIDTH_METADATA_ONLY, BANDWIDTH_AUDIO_ONLY,
   BANDWIDTH_LOWEST, BANDWIDTH_HIGHEST,
   FORMAT_TYPE_PROGRESSIVE, FORMAT_TYPE_INTERLACED,
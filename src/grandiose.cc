@@ -15,6 +15,8 @@
 
 #include <cstdio>
 #include <chrono>
+#include <mutex>
+#include <string>
 #include <Processing.NDI.Lib.h>
 
 #ifdef _WIN32
@@ -30,6 +32,7 @@
 #include "grandiose_send.h"
 #include "grandiose_receive.h"
 #include "grandiose_routing.h"
+#include "grandiose_pool.h"
 #include "node_api.h"
 
 napi_value version(napi_env env, napi_callback_info info) {
@@ -53,10 +56,47 @@ napi_value isSupportedCPU(napi_env env, napi_callback_info info) {
   return result;
 }
 
+// The NDI library is shared by every environment that loads the addon. Each
+// environment holds one reference from load, or from initialize(), until it
+// calls destroy() or is torn down. The library is destroyed when the last
+// reference is dropped by destroy(). It is left for process exit when the last
+// holder is torn down instead, as lane threads may still be in NDI calls.
+static std::mutex ndiLock;
+static uint32_t ndiReferences = 0;
+static bool ndiLive = false;
+
+bool acquireNDI(grandioseEnv* g) {
+  std::lock_guard<std::mutex> lock(ndiLock);
+  if (g->ndiInitialized) return true;
+  if (!ndiLive) ndiLive = NDIlib_initialize();
+  if (!ndiLive) return false;
+  ndiReferences++;
+  g->ndiInitialized = true;
+  return true;
+}
+
+void releaseNDI(grandioseEnv* g, bool destroy) {
+  std::lock_guard<std::mutex> lock(ndiLock);
+  if (!g->ndiInitialized) return;
+  g->ndiInitialized = false;
+  if ((--ndiReferences == 0) && destroy && ndiLive) {
+    NDIlib_destroy();
+    ndiLive = false;
+  }
+}
+
+void finalizeGrandioseEnv(napi_env env, void* data, void* hint) {
+  grandioseEnv* g = (grandioseEnv*) data;
+  cancelTransfers(env);
+  releaseNDI(g, false);
+  releaseCompletion(g->completion);
+  delete g;
+}
+
 napi_value initialize(napi_env env, napi_callback_info info) {
   napi_status status;
 
-  bool ok = NDIlib_initialize();
+  bool ok = acquireNDI(getGrandioseEnv(env));
   napi_value result;
   status = napi_get_boolean(env, ok, &result);
   CHECK_STATUS;
@@ -64,10 +104,12 @@ napi_value initialize(napi_env env, napi_callback_info info) {
   return result;
 }
 
+// Drops this environment's reference, destroying the library only once no
+// other worker thread holds one
 napi_value destroy(napi_env env, napi_callback_info info) {
   napi_status status;
 
-  NDIlib_destroy();
+  releaseNDI(getGrandioseEnv(env), true);
   napi_value result;
   status = napi_get_boolean(env, true, &result);
   CHECK_STATUS;
@@ -75,8 +117,65 @@ napi_value destroy(napi_env env, napi_callback_info info) {
   return result;
 }
 
-napi_value Init(napi_env env, napi_value exports) {
+// grandiose.adopt(token) takes a sender or receiver handed on with its
+// transfer() method, in this or another thread, resolving with a new sender
+// or receiver object in this thread.
+napi_value adopt(napi_env env, napi_callback_info info) {
+  napi_valuetype type;
+  carrier* c = new carrier;
+
+  napi_value promise;
+  c->status = napi_create_promise(env, &c->_deferred, &promise);
+  REJECT_RETURN;
+
+  size_t argc = 1;
+  napi_value args[1];
+  c->status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+  REJECT_RETURN;
+  if (argc == 1) {
+    c->status = napi_typeof(env, args[0], &type);
+    REJECT_RETURN;
+  }
+  if ((argc != 1) || (type != napi_string)) REJECT_ERROR_RETURN(
+    "A sender or receiver must be adopted with the token from its transfer method.",
+    GRANDIOSE_INVALID_ARGS);
+
+  size_t tokenl;
+  c->status = napi_get_value_string_utf8(env, args[0], nullptr, 0, &tokenl);
+  REJECT_RETURN;
+  std::string token(tokenl, '\0');
+  c->status = napi_get_value_string_utf8(env, args[0], &token[0], tokenl + 1, &tokenl);
+  REJECT_RETURN;
+
+  const char* kind;
+  carrier* t = takeTransfer(token, &kind);
+  if (t == nullptr) REJECT_ERROR_RETURN(
+    "No sender or receiver is waiting to be adopted with this token.",
+    GRANDIOSE_NOT_FOUND);
+
+  // Completed as if just created in this environment
+  t->_deferred = c->_deferred;
+  c->_deferred = nullptr;
+  tidyCarrier(env, c);
+  if (std::string(kind) == "sender")
+    sendComplete(env, napi_ok, t);
+  else
+    receiveComplete(env, napi_ok, t);
+
+  return promise;
+}
+
+// Context aware, so that the addon can be loaded in any number of worker
+// threads, each with its own instance data
+NAPI_MODULE_INIT() {
   napi_status status;
+
+  grandioseEnv* g = new grandioseEnv;
+  status = napi_set_instance_data(env, g, finalizeGrandioseEnv, nullptr);
+  if (status != napi_ok) delete g;
+  CHECK_STATUS;
+  acquireNDI(g);
+
   napi_property_descriptor desc[] = {
     DECLARE_NAPI_METHOD("version", version),
     DECLARE_NAPI_METHOD("isSupportedCPU", isSupportedCPU),
@@ -84,13 +183,15 @@ napi_value Init(napi_env env, napi_value exports) {
     DECLARE_NAPI_METHOD("destroy", destroy),
     DECLARE_NAPI_METHOD("find", find),
     DECLARE_NAPI_METHOD("send", send),
+    DECLARE_NAPI_METHOD("sendGroup", sendGroup),
     DECLARE_NAPI_METHOD("receive", receive),
-    DECLARE_NAPI_METHOD("routing", routing)
+    DECLARE_NAPI_METHOD("routing", routing),
+    DECLARE_NAPI_METHOD("adopt", adopt),
+    DECLARE_NAPI_METHOD("configureWorkers", configureWorkers),
+    DECLARE_NAPI_METHOD("workerStats", workerStats)
    };
   status = napi_define_properties(env, exports, sizeof(desc) / sizeof(desc[0]), desc);
   CHECK_STATUS;
 
   return exports;
 }
-
-NAPI_MODULE(nodencl, Init)
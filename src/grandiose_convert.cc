@@ -0,0 +1,814 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "grandiose_convert.h"
+
+// Vector kernels are chosen at build time for ARM and at run time for x86,
+// where AVX2 cannot be assumed. Each kernel converts as much of a row as it
+// can and leaves the remainder to the scalar code.
+#if defined(__aarch64__) || defined(__ARM_NEON)
+#define GRANDIOSE_NEON 1
+#include <arm_neon.h>
+#elif (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define GRANDIOSE_X86 1
+#include <immintrin.h>
+#endif
+
+// RGB to limited range Y'CbCr, scaled by 2^15. Chroma rows sum to zero so
+// that greys have no colour.
+struct rgbToYuv {
+  int16_t yr, yg, yb;
+  int16_t ur, ug, ub;
+  int16_t vr, vg, vb;
+};
+
+static const rgbToYuv rgbCoeffs[3] = {
+  { 8414, 16519, 3208, -4857, -9535, 14392, 14392, -12051, -2341 }, // BT.601
+  { 5983, 20127, 2032, -3298, -11094, 14392, 14392, -13072, -1320 }, // BT.709
+  { 7393, 19080, 1669, -4019, -10373, 14392, 14392, -13234, -1158 } // BT.2020
+};
+
+// Offsets include rounding. Chroma is computed from the sum of a pair of
+// pixels, so it has one more bit of scale.
+#define Y_OFFSET ((16 << 15) + (1 << 14))
+#define C_OFFSET ((128 << 16) + (1 << 15))
+
+bool validColorMatrix(Grandiose_color_matrix_e matrix) {
+  switch (matrix) {
+    case Grandiose_color_matrix_bt601:
+    case Grandiose_color_matrix_bt709:
+    case Grandiose_color_matrix_bt2020:
+    case Grandiose_color_matrix_auto:
+      return true;
+    default:
+      return false;
+  }
+}
+
+Grandiose_color_matrix_e resolveColorMatrix(Grandiose_color_matrix_e matrix, int32_t yres) {
+  if (matrix != Grandiose_color_matrix_auto) return matrix;
+  return (yres < 720) ? Grandiose_color_matrix_bt601 : Grandiose_color_matrix_bt709;
+}
+
+size_t videoFrameBytes(NDIlib_FourCC_video_type_e fourCC, int32_t xres, int32_t yres,
+    int32_t lineStrideBytes) {
+  size_t stride = (size_t) lineStrideBytes;
+  size_t lines = (size_t) yres;
+  switch (fourCC) {
+    case NDIlib_FourCC_video_type_UYVY:
+    case NDIlib_FourCC_video_type_RGBA:
+    case NDIlib_FourCC_video_type_RGBX:
+    case NDIlib_FourCC_video_type_BGRA:
+    case NDIlib_FourCC_video_type_BGRX:
+      return stride * lines;
+    case NDIlib_FourCC_video_type_UYVA:
+      return stride * lines + (size_t) xres * lines;
+    case NDIlib_FourCC_video_type_P216:
+      return 2 * stride * lines;
+    case NDIlib_FourCC_video_type_PA16:
+      return 3 * stride * lines;
+    case NDIlib_FourCC_video_type_I420:
+    case NDIlib_FourCC_video_type_YV12:
+      return stride * lines + 2 * (stride / 2) * (lines / 2);
+    case NDIlib_FourCC_video_type_NV12:
+      return stride * lines * 3 / 2;
+    default:
+      return 0;
+  }
+}
+
+int32_t defaultLineStride(NDIlib_FourCC_video_type_e fourCC, int32_t xres) {
+  switch (fourCC) {
+    case NDIlib_FourCC_video_type_UYVY:
+      return (xres + 1) / 2 * 4;
+    case NDIlib_FourCC_video_type_UYVA:
+    case NDIlib_FourCC_video_type_P216:
+    case NDIlib_FourCC_video_type_PA16:
+      return xres * 2;
+    case NDIlib_FourCC_video_type_RGBA:
+    case NDIlib_FourCC_video_type_RGBX:
+    case NDIlib_FourCC_video_type_BGRA:
+    case NDIlib_FourCC_video_type_BGRX:
+      return xres * 4;
+    case NDIlib_FourCC_video_type_I420:
+    case NDIlib_FourCC_video_type_YV12:
+    case NDIlib_FourCC_video_type_NV12:
+      return xres;
+    default:
+      return 0;
+  }
+}
+
+bool canConvertToUYVY(NDIlib_FourCC_video_type_e fourCC) {
+  switch (fourCC) {
+    case NDIlib_FourCC_video_type_RGBA:
+    case NDIlib_FourCC_video_type_RGBX:
+    case NDIlib_FourCC_video_type_BGRA:
+    case NDIlib_FourCC_video_type_BGRX:
+    case NDIlib_FourCC_video_type_I420:
+    case NDIlib_FourCC_video_type_YV12:
+    case NDIlib_FourCC_video_type_NV12:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Packed 4 byte RGB pixels, with red and blue at the given byte offsets, to
+// UYVY. An odd final pixel is paired with itself.
+static void rgbRowToUYVYScalar(const uint8_t* src, uint8_t* dst, int32_t width,
+    const rgbToYuv& k, int32_t rOff, int32_t bOff, int32_t from) {
+  for ( int32_t x = from ; x < width ; x += 2 ) {
+    const uint8_t* p0 = src + x * 4;
+    const uint8_t* p1 = (x + 1 < width) ? p0 + 4 : p0;
+    int32_t r0 = p0[rOff], g0 = p0[1], b0 = p0[bOff];
+    int32_t r1 = p1[rOff], g1 = p1[1], b1 = p1[bOff];
+    int32_t rs = r0 + r1, gs = g0 + g1, bs = b0 + b1;
+    uint8_t* d = dst + x * 2;
+    d[0] = (uint8_t) ((k.ur * rs + k.ug * gs + k.ub * bs + C_OFFSET) >> 16);
+    d[1] = (uint8_t) ((k.yr * r0 + k.yg * g0 + k.yb * b0 + Y_OFFSET) >> 15);
+    d[2] = (uint8_t) ((k.vr * rs + k.vg * gs + k.vb * bs + C_OFFSET) >> 16);
+    d[3] = (uint8_t) ((k.yr * r1 + k.yg * g1 + k.yb * b1 + Y_OFFSET) >> 15);
+  }
+}
+
+// Planar or semi-planar 4:2:0 rows to UYVY. Chroma samples are uvStep bytes
+// apart, 1 for I420 and YV12 or 2 for NV12. An odd final pixel is repeated.
+static void planarRowToUYVYScalar(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+    int32_t uvStep, uint8_t* dst, int32_t width, int32_t from) {
+  for ( int32_t x = from ; x < width ; x += 2 ) {
+    int32_t c = (x / 2) * uvStep;
+    uint8_t* d = dst + x * 2;
+    d[0] = u[c];
+    d[1] = y[x];
+    d[2] = v[c];
+    d[3] = (x + 1 < width) ? y[x + 1] : y[x];
+  }
+}
+
+#ifdef GRANDIOSE_X86
+
+// Eight pixels at a time. Each pixel's components are isolated in 32-bit
+// lanes, pair sums formed by swapping neighbouring lanes and the four UYVY
+// words of each group gathered from the even lanes.
+__attribute__((target("avx2")))
+static int32_t rgbRowToUYVYAVX2(const uint8_t* src, uint8_t* dst, int32_t width,
+    const rgbToYuv& k, int32_t rOff, int32_t bOff) {
+  const __m256i mask = _mm256_set1_epi32(0xff);
+  const __m128i rShift = _mm_cvtsi32_si128(rOff * 8);
+  const __m128i bShift = _mm_cvtsi32_si128(bOff * 8);
+  const __m256i yr = _mm256_set1_epi32(k.yr), yg = _mm256_set1_epi32(k.yg),
+    yb = _mm256_set1_epi32(k.yb);
+  const __m256i ur = _mm256_set1_epi32(k.ur), ug = _mm256_set1_epi32(k.ug),
+    ub = _mm256_set1_epi32(k.ub);
+  const __m256i vr = _mm256_set1_epi32(k.vr), vg = _mm256_set1_epi32(k.vg),
+    vb = _mm256_set1_epi32(k.vb);
+  const __m256i yOff = _mm256_set1_epi32(Y_OFFSET);
+  const __m256i cOff = _mm256_set1_epi32(C_OFFSET);
+  const __m256i evens = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+
+  int32_t x = 0;
+  for ( ; x + 8 <= width ; x += 8 ) {
+    __m256i p = _mm256_loadu_si256((const __m256i*) (src + x * 4));
+    __m256i r = _mm256_and_si256(_mm256_srl_epi32(p, rShift), mask);
+    __m256i g = _mm256_and_si256(_mm256_srli_epi32(p, 8), mask);
+    __m256i b = _mm256_and_si256(_mm256_srl_epi32(p, bShift), mask);
+
+    __m256i y = _mm256_add_epi32(
+      _mm256_add_epi32(_mm256_mullo_epi32(r, yr), _mm256_mullo_epi32(g, yg)),
+      _mm256_add_epi32(_mm256_mullo_epi32(b, yb), yOff));
+    y = _mm256_srai_epi32(y, 15);
+
+    __m256i rs = _mm256_add_epi32(r, _mm256_shuffle_epi32(r, 0xb1));
+    __m256i gs = _mm256_add_epi32(g, _mm256_shuffle_epi32(g, 0xb1));
+    __m256i bs = _mm256_add_epi32(b, _mm256_shuffle_epi32(b, 0xb1));
+    __m256i u = _mm256_add_epi32(
+      _mm256_add_epi32(_mm256_mullo_epi32(rs, ur), _mm256_mullo_epi32(gs, ug)),
+      _mm256_add_epi32(_mm256_mullo_epi32(bs, ub), cOff));
+    u = _mm256_srai_epi32(u, 16);
+    __m256i v = _mm256_add_epi32(
+      _mm256_add_epi32(_mm256_mullo_epi32(rs, vr), _mm256_mullo_epi32(gs, vg)),
+      _mm256_add_epi32(_mm256_mullo_epi32(bs, vb), cOff));
+    v = _mm256_srai_epi32(v, 16);
+
+    __m256i word = _mm256_or_si256(
+      _mm256_or_si256(u, _mm256_slli_epi32(y, 8)),
+      _mm256_or_si256(_mm256_slli_epi32(v, 16),
+        _mm256_slli_epi32(_mm256_shuffle_epi32(y, 0xb1), 24)));
+    word = _mm256_permutevar8x32_epi32(word, evens);
+    _mm_storeu_si128((__m128i*) (dst + x * 2), _mm256_castsi256_si128(word));
+  }
+  return x;
+}
+
+#ifdef __SSE2__
+// Sixteen pixels at a time by interleaving bytes. No arithmetic is needed.
+static int32_t planarRowToUYVYSSE2(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+    int32_t uvStep, uint8_t* dst, int32_t width) {
+  const __m128i mask = _mm_set1_epi16(0xff);
+  int32_t x = 0;
+  for ( ; x + 16 <= width ; x += 16 ) {
+    __m128i luma = _mm_loadu_si128((const __m128i*) (y + x));
+    __m128i cb, cr;
+    if (uvStep == 1) {
+      cb = _mm_loadl_epi64((const __m128i*) (u + x / 2));
+      cr = _mm_loadl_epi64((const __m128i*) (v + x / 2));
+    } else {
+      __m128i uv = _mm_loadu_si128((const __m128i*) (u + x));
+      cb = _mm_packus_epi16(_mm_and_si128(uv, mask), _mm_setzero_si128());
+      cr = _mm_packus_epi16(_mm_srli_epi16(uv, 8), _mm_setzero_si128());
+    }
+    __m128i chroma = _mm_unpacklo_epi8(cb, cr);
+    _mm_storeu_si128((__m128i*) (dst + x * 2), _mm_unpacklo_epi8(chroma, luma));
+    _mm_storeu_si128((__m128i*) (dst + x * 2 + 16), _mm_unpackhi_epi8(chroma, luma));
+  }
+  return x;
+}
+#endif
+
+static bool hasAVX2() {
+  static const bool avx2 = __builtin_cpu_supports("avx2");
+  return avx2;
+}
+
+#endif // GRANDIOSE_X86
+
+#ifdef GRANDIOSE_NEON
+
+// Sixteen pixels at a time. vld4 separates the components, pairwise adds
+// give the chroma sums and vst4 writes the UYVY pairs.
+static int32_t rgbRowToUYVYNEON(const uint8_t* src, uint8_t* dst, int32_t width,
+    const rgbToYuv& k, int32_t rOff, int32_t bOff) {
+  const int32x4_t yOff = vdupq_n_s32(Y_OFFSET);
+  const int32x4_t cOff = vdupq_n_s32(C_OFFSET);
+
+  int32_t x = 0;
+  for ( ; x + 16 <= width ; x += 16 ) {
+    uint8x16x4_t p = vld4q_u8(src + x * 4);
+    uint8x16_t r = p.val[rOff], g = p.val[1], b = p.val[bOff];
+
+    int16x8_t rw[2] = { vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(r))),
+      vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(r))) };
+    int16x8_t gw[2] = { vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(g))),
+      vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(g))) };
+    int16x8_t bw[2] = { vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(b))),
+      vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(b))) };
+    int16x4_t yq[4];
+    for ( int q = 0 ; q < 4 ; q++ ) {
+      int16x4_t rq = (q & 1) ? vget_high_s16(rw[q / 2]) : vget_low_s16(rw[q / 2]);
+      int16x4_t gq = (q & 1) ? vget_high_s16(gw[q / 2]) : vget_low_s16(gw[q / 2]);
+      int16x4_t bq = (q & 1) ? vget_high_s16(bw[q / 2]) : vget_low_s16(bw[q / 2]);
+      int32x4_t acc = vmlal_n_s16(yOff, rq, k.yr);
+      acc = vmlal_n_s16(acc, gq, k.yg);
+      acc = vmlal_n_s16(acc, bq, k.yb);
+      yq[q] = vmovn_s32(vshrq_n_s32(acc, 15));
+    }
+    uint8x8_t yLow = vqmovun_s16(vcombine_s16(yq[0], yq[1]));
+    uint8x8_t yHigh = vqmovun_s16(vcombine_s16(yq[2], yq[3]));
+    uint8x8x2_t ySplit = vuzp_u8(yLow, yHigh);
+
+    int16x8_t rs = vreinterpretq_s16_u16(vpaddlq_u8(r));
+    int16x8_t gs = vreinterpretq_s16_u16(vpaddlq_u8(g));
+    int16x8_t bs = vreinterpretq_s16_u16(vpaddlq_u8(b));
+    int16x4_t uq[2], vq[2];
+    for ( int h = 0 ; h < 2 ; h++ ) {
+      int16x4_t rh = h ? vget_high_s16(rs) : vget_low_s16(rs);
+      int16x4_t gh = h ? vget_high_s16(gs) : vget_low_s16(gs);
+      int16x4_t bh = h ? vget_high_s16(bs) : vget_low_s16(bs);
+      int32x4_t acc = vmlal_n_s16(cOff, rh, k.ur);
+      acc = vmlal_n_s16(acc, gh, k.ug);
+      acc = vmlal_n_s16(acc, bh, k.ub);
+      uq[h] = vmovn_s32(vshrq_n_s32(acc, 16));
+      acc = vmlal_n_s16(cOff, rh, k.vr);
+      acc = vmlal_n_s16(acc, gh, k.vg);
+      acc = vmlal_n_s16(acc, bh, k.vb);
+      vq[h] = vmovn_s32(vshrq_n_s32(acc, 16));
+    }
+
+    uint8x8x4_t out;
+    out.val[0] = vqmovun_s16(vcombine_s16(uq[0], uq[1]));
+    out.val[1] = ySplit.val[0];
+    out.val[2] = vqmovun_s16(vcombine_s16(vq[0], vq[1]));
+    out.val[3] = ySplit.val[1];
+    vst4_u8(dst + x * 2, out);
+  }
+  return x;
+}
+
+static int32_t planarRowToUYVYNEON(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+    int32_t uvStep, uint8_t* dst, int32_t width) {
+  int32_t x = 0;
+  for ( ; x + 16 <= width ; x += 16 ) {
+    uint8x8x2_t luma = vld2_u8(y + x);
+    uint8x8x4_t out;
+    if (uvStep == 1) {
+      out.val[0] = vld1_u8(u + x / 2);
+      out.val[2] = vld1_u8(v + x / 2);
+    } else {
+      uint8x8x2_t uv = vld2_u8(u + x);
+      out.val[0] = uv.val[0];
+      out.val[2] = uv.val[1];
+    }
+    out.val[1] = luma.val[0];
+    out.val[3] = luma.val[1];
+    vst4_u8(dst + x * 2, out);
+  }
+  return x;
+}
+
+#endif // GRANDIOSE_NEON
+
+static void rgbRowToUYVY(const uint8_t* src, uint8_t* dst, int32_t width,
+    const rgbToYuv& k, int32_t rOff, int32_t bOff) {
+  int32_t done = 0;
+#if defined(GRANDIOSE_NEON)
+  done = rgbRowToUYVYNEON(src, dst, width, k, rOff, bOff);
+#elif defined(GRANDIOSE_X86)
+  if (hasAVX2()) done = rgbRowToUYVYAVX2(src, dst, width, k, rOff, bOff);
+#endif
+  rgbRowToUYVYScalar(src, dst, width, k, rOff, bOff, done);
+}
+
+static void planarRowToUYVY(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+    int32_t uvStep, uint8_t* dst, int32_t width) {
+  int32_t done = 0;
+#if defined(GRANDIOSE_NEON)
+  done = planarRowToUYVYNEON(y, u, v, uvStep, dst, width);
+#elif defined(GRANDIOSE_X86) && defined(__SSE2__)
+  done = planarRowToUYVYSSE2(y, u, v, uvStep, dst, width);
+#endif
+  planarRowToUYVYScalar(y, u, v, uvStep, dst, width, done);
+}
+
+void convertToUYVY(const NDIlib_video_frame_v2_t* src, uint8_t* dst, int32_t dstStride,
+    Grandiose_color_matrix_e matrix) {
+  const rgbToYuv& k = rgbCoeffs[resolveColorMatrix(matrix, src->yres)];
+  const uint8_t* data = src->p_data;
+  int32_t stride = src->line_stride_in_bytes;
+  int32_t width = src->xres;
+  int32_t height = src->yres;
+
+  switch (src->FourCC) {
+    case NDIlib_FourCC_video_type_RGBA:
+    case NDIlib_FourCC_video_type_RGBX:
+      for ( int32_t y = 0 ; y < height ; y++ )
+        rgbRowToUYVY(data + y * stride, dst + y * dstStride, width, k, 0, 2);
+      break;
+    case NDIlib_FourCC_video_type_BGRA:
+    case NDIlib_FourCC_video_type_BGRX:
+      for ( int32_t y = 0 ; y < height ; y++ )
+        rgbRowToUYVY(data + y * stride, dst + y * dstStride, width, k, 2, 0);
+      break;
+    case NDIlib_FourCC_video_type_I420:
+    case NDIlib_FourCC_video_type_YV12: {
+      // Chroma lines are repeated to go from 4:2:0 to 4:2:2. The width and
+      // height are even, as checked by parseVideoConversion.
+      int32_t chromaStride = stride / 2;
+      const uint8_t* first = data + stride * height;
+      const uint8_t* second = first + chromaStride * (height / 2);
+      const uint8_t* cb = (src->FourCC == NDIlib_FourCC_video_type_I420) ? first : second;
+      const uint8_t* cr = (src->FourCC == NDIlib_FourCC_video_type_I420) ? second : first;
+      for ( int32_t y = 0 ; y < height ; y++ ) {
+        int32_t c = (y / 2) * chromaStride;
+        planarRowToUYVY(data + y * stride, cb + c, cr + c, 1, dst + y * dstStride, width);
+      }
+      break;
+    }
+    case NDIlib_FourCC_video_type_NV12: {
+      const uint8_t* uv = data + stride * height;
+      for ( int32_t y = 0 ; y < height ; y++ ) {
+        int32_t c = (y / 2) * stride;
+        planarRowToUYVY(data + y * stride, uv + c, uv + c + 1, 2, dst + y * dstStride, width);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+// Y'CbCr to RGB, scaled by 2^13, for a source in limited or full range
+struct yuvToRgb {
+  int32_t y, rv, gu, gv, bu;
+  int32_t yOffset;
+};
+
+static yuvToRgb makeYuvToRgb(Grandiose_color_matrix_e matrix, bool fullRange) {
+  static const double kr[3] = { 0.299, 0.2126, 0.2627 };
+  static const double kb[3] = { 0.114, 0.0722, 0.0593 };
+  double r = kr[matrix], b = kb[matrix], g = 1.0 - r - b;
+  double ys = fullRange ? 1.0 : 255.0 / 219.0;
+  double cs = fullRange ? 1.0 : 255.0 / 224.0;
+  yuvToRgb t;
+  t.y = (int32_t) lround(ys * 8192.0);
+  t.rv = (int32_t) lround(2.0 * (1.0 - r) * cs * 8192.0);
+  t.gu = (int32_t) -lround(2.0 * b * (1.0 - b) / g * cs * 8192.0);
+  t.gv = (int32_t) -lround(2.0 * r * (1.0 - r) / g * cs * 8192.0);
+  t.bu = (int32_t) lround(2.0 * (1.0 - b) * cs * 8192.0);
+  t.yOffset = fullRange ? 0 : 16;
+  return t;
+}
+
+static inline uint8_t clampByte(int32_t v) {
+  return (uint8_t) (v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+bool canConvertFromYUV(NDIlib_FourCC_video_type_e fourCC) {
+  switch (fourCC) {
+    case NDIlib_FourCC_video_type_UYVY:
+    case NDIlib_FourCC_video_type_UYVA:
+    case NDIlib_FourCC_video_type_P216:
+    case NDIlib_FourCC_video_type_PA16:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool validOutputFormat(NDIlib_FourCC_video_type_e fourCC) {
+  switch (fourCC) {
+    case NDIlib_FourCC_video_type_RGBA:
+    case NDIlib_FourCC_video_type_RGBX:
+    case NDIlib_FourCC_video_type_BGRA:
+    case NDIlib_FourCC_video_type_BGRX:
+    case NDIlib_FourCC_video_type_I420:
+    case NDIlib_FourCC_video_type_NV12:
+      return true;
+    default:
+      return false;
+  }
+}
+
+size_t outputFrameBytes(NDIlib_FourCC_video_type_e fourCC, int32_t xres, int32_t yres,
+    int32_t* lineStrideBytes) {
+  switch (fourCC) {
+    case NDIlib_FourCC_video_type_I420:
+    case NDIlib_FourCC_video_type_NV12:
+      // Both chroma planes together are the size of one line of luma per pair
+      *lineStrideBytes = (xres + 1) & ~1;
+      return (size_t) *lineStrideBytes * (yres + (yres + 1) / 2);
+    default:
+      *lineStrideBytes = xres * 4;
+      return (size_t) *lineStrideBytes * yres;
+  }
+}
+
+// UYVY, with an optional 8-bit alpha row, to 4 byte RGB pixels with red and
+// blue at the given byte offsets.
+static void uyvyRowToRGBScalar(const uint8_t* src, const uint8_t* alpha, uint8_t* dst,
+    int32_t width, const yuvToRgb& t, int32_t rOff, int32_t bOff, int32_t from) {
+  for ( int32_t x = from ; x < width ; x += 2 ) {
+    const uint8_t* s = src + x * 2;
+    int32_t u = s[0] - 128, v = s[2] - 128;
+    int32_t rc = t.rv * v, gc = t.gu * u + t.gv * v, bc = t.bu * u;
+    for ( int32_t p = 0 ; (p < 2) && (x + p < width) ; p++ ) {
+      int32_t y = t.y * (s[1 + p * 2] - t.yOffset) + (1 << 12);
+      uint8_t* d = dst + (x + p) * 4;
+      d[rOff] = clampByte((y + rc) >> 13);
+      d[1] = clampByte((y + gc) >> 13);
+      d[bOff] = clampByte((y + bc) >> 13);
+      d[3] = (alpha != nullptr) ? alpha[x + p] : 255;
+    }
+  }
+}
+
+// Two lines of UYVY to luma lines and one averaged line of chroma, with
+// chroma samples uvStep bytes apart. y1 is nullptr for a final odd line.
+static void uyvyRowsToPlanarScalar(const uint8_t* row0, const uint8_t* row1,
+    uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v, int32_t uvStep,
+    int32_t width, int32_t from) {
+  for ( int32_t x = from ; x < width ; x += 2 ) {
+    const uint8_t* a = row0 + x * 2;
+    const uint8_t* b = row1 + x * 2;
+    int32_t c = (x / 2) * uvStep;
+    u[c] = (uint8_t) ((a[0] + b[0] + 1) >> 1);
+    v[c] = (uint8_t) ((a[2] + b[2] + 1) >> 1);
+    y0[x] = a[1];
+    if (x + 1 < width) y0[x + 1] = a[3];
+    if (y1 != nullptr) {
+      y1[x] = b[1];
+      if (x + 1 < width) y1[x + 1] = b[3];
+    }
+  }
+}
+
+#ifdef GRANDIOSE_X86
+
+// Eight pixels at a time, with each pixel's components spread into 32-bit
+// lanes and the results packed back into one 32-bit word per pixel.
+__attribute__((target("avx2")))
+static int32_t uyvyRowToRGBAVX2(const uint8_t* src, const uint8_t* alpha, uint8_t* dst,
+    int32_t width, const yuvToRgb& t, int32_t rOff, int32_t bOff) {
+  const __m128i yIdx = _mm_setr_epi8(1, 3, 5, 7, 9, 11, 13, 15, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i uIdx = _mm_setr_epi8(0, 0, 4, 4, 8, 8, 12, 12, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i vIdx = _mm_setr_epi8(2, 2, 6, 6, 10, 10, 14, 14, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i rShift = _mm_cvtsi32_si128(rOff * 8);
+  const __m128i bShift = _mm_cvtsi32_si128(bOff * 8);
+  const __m256i yc = _mm256_set1_epi32(t.y), rv = _mm256_set1_epi32(t.rv),
+    gu = _mm256_set1_epi32(t.gu), gv = _mm256_set1_epi32(t.gv), bu = _mm256_set1_epi32(t.bu);
+  const __m256i yOff = _mm256_set1_epi32(t.yOffset);
+  const __m256i cOff = _mm256_set1_epi32(128);
+  const __m256i round = _mm256_set1_epi32(1 << 12);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i max = _mm256_set1_epi32(255);
+  const __m256i opaque = _mm256_set1_epi32(255 << 24);
+
+  int32_t x = 0;
+  for ( ; x + 8 <= width ; x += 8 ) {
+    __m128i p = _mm_loadu_si128((const __m128i*) (src + x * 2));
+    __m256i y = _mm256_cvtepu8_epi32(_mm_shuffle_epi8(p, yIdx));
+    __m256i u = _mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_shuffle_epi8(p, uIdx)), cOff);
+    __m256i v = _mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_shuffle_epi8(p, vIdx)), cOff);
+    y = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(y, yOff), yc), round);
+
+    __m256i r = _mm256_srai_epi32(_mm256_add_epi32(y, _mm256_mullo_epi32(v, rv)), 13);
+    __m256i g = _mm256_srai_epi32(_mm256_add_epi32(y,
+      _mm256_add_epi32(_mm256_mullo_epi32(u, gu), _mm256_mullo_epi32(v, gv))), 13);
+    __m256i b = _mm256_srai_epi32(_mm256_add_epi32(y, _mm256_mullo_epi32(u, bu)), 13);
+    r = _mm256_min_epi32(_mm256_max_epi32(r, zero), max);
+    g = _mm256_min_epi32(_mm256_max_epi32(g, zero), max);
+    b = _mm256_min_epi32(_mm256_max_epi32(b, zero), max);
+
+    __m256i a = (alpha != nullptr) ?
+      _mm256_slli_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*) (alpha + x))), 24) :
+      opaque;
+    __m256i word = _mm256_or_si256(
+      _mm256_or_si256(_mm256_sll_epi32(r, rShift), _mm256_slli_epi32(g, 8)),
+      _mm256_or_si256(_mm256_sll_epi32(b, bShift), a));
+    _mm256_storeu_si256((__m256i*) (dst + x * 4), word);
+  }
+  return x;
+}
+
+#ifdef __SSE2__
+// Sixteen pixels at a time, splitting luma from chroma by masking and
+// shifting and averaging chroma lines with pavgb.
+static int32_t uyvyRowsToPlanarSSE2(const uint8_t* row0, const uint8_t* row1,
+    uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v, int32_t uvStep, int32_t width) {
+  const __m128i mask = _mm_set1_epi16(0xff);
+  const __m128i zero = _mm_setzero_si128();
+  int32_t x = 0;
+  for ( ; x + 16 <= width ; x += 16 ) {
+    __m128i a0 = _mm_loadu_si128((const __m128i*) (row0 + x * 2));
+    __m128i a1 = _mm_loadu_si128((const __m128i*) (row0 + x * 2 + 16));
+    __m128i b0 = _mm_loadu_si128((const __m128i*) (row1 + x * 2));
+    __m128i b1 = _mm_loadu_si128((const __m128i*) (row1 + x * 2 + 16));
+    _mm_storeu_si128((__m128i*) (y0 + x),
+      _mm_packus_epi16(_mm_srli_epi16(a0, 8), _mm_srli_epi16(a1, 8)));
+    if (y1 != nullptr)
+      _mm_storeu_si128((__m128i*) (y1 + x),
+        _mm_packus_epi16(_mm_srli_epi16(b0, 8), _mm_srli_epi16(b1, 8)));
+    __m128i chroma = _mm_avg_epu8(
+      _mm_packus_epi16(_mm_and_si128(a0, mask), _mm_and_si128(a1, mask)),
+      _mm_packus_epi16(_mm_and_si128(b0, mask), _mm_and_si128(b1, mask)));
+    if (uvStep == 2) {
+      _mm_storeu_si128((__m128i*) (u + x), chroma);
+    } else {
+      _mm_storel_epi64((__m128i*) (u + x / 2),
+        _mm_packus_epi16(_mm_and_si128(chroma, mask), zero));
+      _mm_storel_epi64((__m128i*) (v + x / 2),
+        _mm_packus_epi16(_mm_srli_epi16(chroma, 8), zero));
+    }
+  }
+  return x;
+}
+#endif
+
+#endif // GRANDIOSE_X86
+
+#ifdef GRANDIOSE_NEON
+
+// Red, green or blue for eight pixels from luma and the chroma term
+static inline uint8x8_t neonChannel(int32x4_t yLow, int32x4_t yHigh,
+    int32x4_t cLow, int32x4_t cHigh) {
+  int16x4_t low = vqmovn_s32(vshrq_n_s32(vaddq_s32(yLow, cLow), 13));
+  int16x4_t high = vqmovn_s32(vshrq_n_s32(vaddq_s32(yHigh, cHigh), 13));
+  return vqmovun_s16(vcombine_s16(low, high));
+}
+
+// Sixteen pixels at a time. vld4 separates chroma from the even and odd
+// luma, which share the chroma terms, and vzip restores pixel order.
+static int32_t uyvyRowToRGBNEON(const uint8_t* src, const uint8_t* alpha, uint8_t* dst,
+    int32_t width, const yuvToRgb& t, int32_t rOff, int32_t bOff) {
+  const uint8x8_t cOff = vdup_n_u8(128);
+  const uint8x8_t yOff = vdup_n_u8((uint8_t) t.yOffset);
+  const int32x4_t round = vdupq_n_s32(1 << 12);
+  const uint8x8_t opaque = vdup_n_u8(255);
+
+  int32_t x = 0;
+  for ( ; x + 16 <= width ; x += 16 ) {
+    uint8x8x4_t p = vld4_u8(src + x * 2);
+    int16x8_t u = vreinterpretq_s16_u16(vsubl_u8(p.val[0], cOff));
+    int16x8_t v = vreinterpretq_s16_u16(vsubl_u8(p.val[2], cOff));
+    int32x4_t rc[2], gc[2], bc[2];
+    for ( int h = 0 ; h < 2 ; h++ ) {
+      int16x4_t uh = h ? vget_high_s16(u) : vget_low_s16(u);
+      int16x4_t vh = h ? vget_high_s16(v) : vget_low_s16(v);
+      rc[h] = vmulq_n_s32(vmovl_s16(vh), t.rv);
+      gc[h] = vmlaq_n_s32(vmulq_n_s32(vmovl_s16(uh), t.gu), vmovl_s16(vh), t.gv);
+      bc[h] = vmulq_n_s32(vmovl_s16(uh), t.bu);
+    }
+
+    uint8x8_t r[2], g[2], b[2];
+    for ( int e = 0 ; e < 2 ; e++ ) {
+      int16x8_t y = vreinterpretq_s16_u16(vsubl_u8(p.val[1 + e * 2], yOff));
+      int32x4_t yLow = vmlaq_n_s32(round, vmovl_s16(vget_low_s16(y)), t.y);
+      int32x4_t yHigh = vmlaq_n_s32(round, vmovl_s16(vget_high_s16(y)), t.y);
+      r[e] = neonChannel(yLow, yHigh, rc[0], rc[1]);
+      g[e] = neonChannel(yLow, yHigh, gc[0], gc[1]);
+      b[e] = neonChannel(yLow, yHigh, bc[0], bc[1]);
+    }
+    uint8x8x2_t rz = vzip_u8(r[0], r[1]);
+    uint8x8x2_t gz = vzip_u8(g[0], g[1]);
+    uint8x8x2_t bz = vzip_u8(b[0], b[1]);
+    for ( int h = 0 ; h < 2 ; h++ ) {
+      uint8x8x4_t out;
+      out.val[rOff] = rz.val[h];
+      out.val[1] = gz.val[h];
+      out.val[bOff] = bz.val[h];
+      out.val[3] = (alpha != nullptr) ? vld1_u8(alpha + x + h * 8) : opaque;
+      vst4_u8(dst + (x + h * 8) * 4, out);
+    }
+  }
+  return x;
+}
+
+static int32_t uyvyRowsToPlanarNEON(const uint8_t* row0, const uint8_t* row1,
+    uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v, int32_t uvStep, int32_t width) {
+  int32_t x = 0;
+  for ( ; x + 16 <= width ; x += 16 ) {
+    uint8x8x4_t a = vld4_u8(row0 + x * 2);
+    uint8x8x4_t b = vld4_u8(row1 + x * 2);
+    uint8x8x2_t luma;
+    luma.val[0] = a.val[1];
+    luma.val[1] = a.val[3];
+    vst2_u8(y0 + x, luma);
+    if (y1 != nullptr) {
+      luma.val[0] = b.val[1];
+      luma.val[1] = b.val[3];
+      vst2_u8(y1 + x, luma);
+    }
+    uint8x8_t cb = vrhadd_u8(a.val[0], b.val[0]);
+    uint8x8_t cr = vrhadd_u8(a.val[2], b.val[2]);
+    if (uvStep == 2) {
+      uint8x8x2_t chroma;
+      chroma.val[0] = cb;
+      chroma.val[1] = cr;
+      vst2_u8(u + x, chroma);
+    } else {
+      vst1_u8(u + x / 2, cb);
+      vst1_u8(v + x / 2, cr);
+    }
+  }
+  return x;
+}
+
+#endif // GRANDIOSE_NEON
+
+static void uyvyRowToRGB(const uint8_t* src, const uint8_t* alpha, uint8_t* dst,
+    int32_t width, const yuvToRgb& t, int32_t rOff, int32_t bOff) {
+  int32_t done = 0;
+#if defined(GRANDIOSE_NEON)
+  done = uyvyRowToRGBNEON(src, alpha, dst, width, t, rOff, bOff);
+#elif defined(GRANDIOSE_X86)
+  if (hasAVX2()) done = uyvyRowToRGBAVX2(src, alpha, dst, width, t, rOff, bOff);
+#endif
+  uyvyRowToRGBScalar(src, alpha, dst, width, t, rOff, bOff, done);
+}
+
+static void uyvyRowsToPlanar(const uint8_t* row0, const uint8_t* row1,
+    uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v, int32_t uvStep, int32_t width) {
+  int32_t done = 0;
+#if defined(GRANDIOSE_NEON)
+  done = uyvyRowsToPlanarNEON(row0, row1, y0, y1, u, v, uvStep, width);
+#elif defined(GRANDIOSE_X86) && defined(__SSE2__)
+  done = uyvyRowsToPlanarSSE2(row0, row1, y0, y1, u, v, uvStep, width);
+#endif
+  uyvyRowsToPlanarScalar(row0, row1, y0, y1, u, v, uvStep, width, done);
+}
+
+// Rounds 16-bit samples to 8 bits
+static inline uint8_t narrowSample(uint16_t s) {
+  return (uint8_t) (std::min((uint32_t) s + 128, (uint32_t) 65535) >> 8);
+}
+
+// Returns a line of a UYVY or UYVA frame in place, or of a P216 or PA16 frame
+// narrowed into scratch, which holds at least one line of UYVY.
+static const uint8_t* sourceLine(const NDIlib_video_frame_v2_t* src, int32_t line,
+    uint8_t* scratch) {
+  int32_t stride = src->line_stride_in_bytes;
+  if ((src->FourCC == NDIlib_FourCC_video_type_UYVY) ||
+      (src->FourCC == NDIlib_FourCC_video_type_UYVA))
+    return src->p_data + line * stride;
+
+  // P216 has a plane of luma followed by a plane of interleaved chroma
+  const uint16_t* luma = (const uint16_t*) (src->p_data + line * stride);
+  const uint16_t* chroma = (const uint16_t*) (src->p_data + (src->yres + line) * stride);
+  for ( int32_t x = 0 ; x < src->xres ; x += 2 ) {
+    uint8_t* d = scratch + x * 2;
+    d[0] = narrowSample(chroma[x]);
+    d[1] = narrowSample(luma[x]);
+    d[2] = narrowSample(chroma[x + 1]);
+    d[3] = narrowSample((x + 1 < src->xres) ? luma[x + 1] : luma[x]);
+  }
+  return scratch;
+}
+
+// Returns a line of 8-bit alpha, or nullptr for formats without alpha
+static const uint8_t* sourceAlpha(const NDIlib_video_frame_v2_t* src, int32_t line,
+    uint8_t* scratch) {
+  int32_t stride = src->line_stride_in_bytes;
+  switch (src->FourCC) {
+    case NDIlib_FourCC_video_type_UYVA:
+      return src->p_data + stride * src->yres + line * src->xres;
+    case NDIlib_FourCC_video_type_PA16: {
+      const uint16_t* alpha = (const uint16_t*) (src->p_data + (2 * src->yres + line) * stride);
+      for ( int32_t x = 0 ; x < src->xres ; x++ ) scratch[x] = narrowSample(alpha[x]);
+      return scratch;
+    }
+    default:
+      return nullptr;
+  }
+}
+
+void convertFromYUV(const NDIlib_video_frame_v2_t* src, uint8_t* dst,
+    NDIlib_FourCC_video_type_e fourCC, int32_t dstStride,
+    Grandiose_color_matrix_e matrix, bool fullRange) {
+  int32_t width = src->xres;
+  int32_t height = src->yres;
+  // Two lines of narrowed UYVY and one of alpha
+  int32_t lineBytes = (width + 1) / 2 * 4;
+  std::vector<uint8_t> scratch;
+  if (src->FourCC != NDIlib_FourCC_video_type_UYVY)
+    scratch.resize(lineBytes * 2 + width);
+  uint8_t* line0 = scratch.data();
+  uint8_t* line1 = line0 + lineBytes;
+  uint8_t* alphaLine = line1 + lineBytes;
+
+  switch (fourCC) {
+    case NDIlib_FourCC_video_type_RGBA:
+    case NDIlib_FourCC_video_type_RGBX:
+    case NDIlib_FourCC_video_type_BGRA:
+    case NDIlib_FourCC_video_type_BGRX: {
+      yuvToRgb t = makeYuvToRgb(resolveColorMatrix(matrix, height), fullRange);
+      bool rgb = (fourCC == NDIlib_FourCC_video_type_RGBA) ||
+        (fourCC == NDIlib_FourCC_video_type_RGBX);
+      bool keepAlpha = (fourCC == NDIlib_FourCC_video_type_RGBA) ||
+        (fourCC == NDIlib_FourCC_video_type_BGRA);
+      for ( int32_t y = 0 ; y < height ; y++ ) {
+        const uint8_t* alpha = keepAlpha ? sourceAlpha(src, y, alphaLine) : nullptr;
+        uyvyRowToRGB(sourceLine(src, y, line0), alpha, dst + y * dstStride, width, t,
+          rgb ? 0 : 2, rgb ? 2 : 0);
+      }
+      break;
+    }
+    case NDIlib_FourCC_video_type_I420:
+    case NDIlib_FourCC_video_type_NV12: {
+      bool nv12 = (fourCC == NDIlib_FourCC_video_type_NV12);
+      int32_t chromaStride = nv12 ? dstStride : dstStride / 2;
+      uint8_t* cb = dst + dstStride * height;
+      uint8_t* cr = nv12 ? cb + 1 : cb + chromaStride * ((height + 1) / 2);
+      for ( int32_t y = 0 ; y < height ; y += 2 ) {
+        bool pair = (y + 1 < height);
+        const uint8_t* row0 = sourceLine(src, y, line0);
+        const uint8_t* row1 = pair ? sourceLine(src, y + 1, line1) : row0;
+        int32_t c = (y / 2) * chromaStride;
+        uyvyRowsToPlanar(row0, row1, dst + y * dstStride,
+          pair ? dst + (y + 1) * dstStride : nullptr, cb + c, cr + c, nv12 ? 2 : 1, width);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+const char* convertKernel() {
+#if defined(GRANDIOSE_NEON)
+  return "neon";
+#elif defined(GRANDIOSE_X86)
+  if (hasAVX2()) return "avx2";
+#ifdef __SSE2__
+  return "sse2";
+#else
+  return "scalar";
+#endif
+#else
+  return "scalar";
+#endif
+}
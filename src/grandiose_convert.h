@@ -0,0 +1,72 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef GRANDIOSE_CONVERT_H
+#define GRANDIOSE_CONVERT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <Processing.NDI.Lib.h>
+
+// Colour matrices for conversion between RGB and Y'CbCr
+typedef enum Grandiose_color_matrix_e {
+  Grandiose_color_matrix_bt601 = 0,
+  Grandiose_color_matrix_bt709 = 1,
+  Grandiose_color_matrix_bt2020 = 2,
+  // BT.601 for standard definition, otherwise BT.709
+  Grandiose_color_matrix_auto = 255
+} Grandiose_color_matrix_e;
+
+bool validColorMatrix(Grandiose_color_matrix_e matrix);
+Grandiose_color_matrix_e resolveColorMatrix(Grandiose_color_matrix_e matrix, int32_t yres);
+
+// Number of bytes of a frame with the given format, or 0 if not known
+size_t videoFrameBytes(NDIlib_FourCC_video_type_e fourCC, int32_t xres, int32_t yres,
+  int32_t lineStrideBytes);
+
+// Line stride of tightly packed frames in the given format, or 0 if not known
+int32_t defaultLineStride(NDIlib_FourCC_video_type_e fourCC, int32_t xres);
+
+// Whether frames in the given format can be converted to UYVY
+bool canConvertToUYVY(NDIlib_FourCC_video_type_e fourCC);
+
+// Converts a frame from RGBA, RGBX, BGRA, BGRX, I420, YV12 or NV12 into
+// limited range UYVY, with RGB treated as full range. Rows of the destination
+// must hold a whole number of pixel pairs, so at least (xres + 1) / 2 * 4 bytes.
+void convertToUYVY(const NDIlib_video_frame_v2_t* src, uint8_t* dst, int32_t dstStride,
+  Grandiose_color_matrix_e matrix);
+
+// Whether received frames in the given format can be converted by convertFromYUV
+bool canConvertFromYUV(NDIlib_FourCC_video_type_e fourCC);
+
+// Whether convertFromYUV can produce frames in the given format
+bool validOutputFormat(NDIlib_FourCC_video_type_e fourCC);
+
+// Number of bytes and line stride of a frame converted by convertFromYUV
+size_t outputFrameBytes(NDIlib_FourCC_video_type_e fourCC, int32_t xres, int32_t yres,
+  int32_t* lineStrideBytes);
+
+// Converts a frame from UYVY, UYVA, P216 or PA16 into RGBA, RGBX, BGRA, BGRX,
+// I420 or NV12. fullRange gives the range of the source Y'CbCr, which only
+// affects RGB. Alpha is kept for RGBA and BGRA. Chroma lines are averaged to
+// go from 4:2:2 to 4:2:0.
+void convertFromYUV(const NDIlib_video_frame_v2_t* src, uint8_t* dst,
+  NDIlib_FourCC_video_type_e fourCC, int32_t dstStride,
+  Grandiose_color_matrix_e matrix, bool fullRange);
+
+// Name of the conversion kernels in use: "avx2", "sse2", "neon" or "scalar"
+const char* convertKernel();
+
+#endif /* GRANDIOSE_CONVERT_H */
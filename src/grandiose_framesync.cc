@@ -0,0 +1,339 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <cstdio>
+#include <Processing.NDI.Lib.h>
+
+#include "grandiose_framesync.h"
+#include "grandiose_receive.h"
+#include "grandiose_util.h"
+
+void destroyFrameSync(frameSyncInstance* f) {
+  if (f->sync == nullptr) return;
+  NDIlib_framesync_destroy(f->sync);
+  f->sync = nullptr;
+  f->instance->synced = false;
+  releaseReceive(f->instance);
+  f->instance = nullptr;
+}
+
+void finalizeFrameSync(napi_env env, void* data, void* hint) {
+  frameSyncInstance* f = (frameSyncInstance*) data;
+  destroyFrameSync(f);
+  delete f;
+}
+
+// The frame synchronizer of the object a method is called on
+napi_status getFrameSync(napi_env env, napi_value thisValue, frameSyncInstance** f) {
+  napi_status status;
+  napi_value syncValue;
+  status = napi_get_named_property(env, thisValue, "embedded", &syncValue);
+  PASS_STATUS;
+  void* syncData;
+  status = napi_get_value_external(env, syncValue, &syncData);
+  PASS_STATUS;
+  *f = (frameSyncInstance*) syncData;
+  return napi_ok;
+}
+
+// The calls here are synchronous, so errors set on the carrier by the shared
+// receive helpers are thrown rather than rejected
+napi_value throwCarrierError(napi_env env, carrier* c) {
+  char errorCode[20];
+  sprintf(errorCode, "%d", c->status);
+  napi_throw_error(env, errorCode, c->errorMsg.c_str());
+  tidyCarrier(env, c);
+  return nullptr;
+}
+
+// receiver.frameSync() creates a frame synchronizer that takes the receiver's
+// video and audio. Queued video and audio frames are dropped, while metadata
+// can still be received with receiver.metadata().
+napi_value receiveFrameSync(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &thisValue, nullptr);
+  CHECK_STATUS;
+
+  napi_value recvValue;
+  status = napi_get_named_property(env, thisValue, "embedded", &recvValue);
+  CHECK_STATUS;
+  void* recvData;
+  status = napi_get_value_external(env, recvValue, &recvData);
+  CHECK_STATUS;
+  receiveInstance* r = (receiveInstance*) recvData;
+
+  if (r->captureFn != nullptr)
+    NAPI_THROW_ERROR("Capture must be stopped before a frame synchronizer is created.");
+  if (r->synced)
+    NAPI_THROW_ERROR("Receiver already has a frame synchronizer.");
+
+  stopDemux(r);
+  frameSyncInstance* f = new frameSyncInstance;
+  f->sync = NDIlib_framesync_create(r->recv);
+  if (f->sync == nullptr) {
+    delete f;
+    NAPI_THROW_ERROR("Failed to create a frame synchronizer.");
+  }
+  f->instance = r;
+  retainReceive(r);
+  r->synced = true;
+
+  napi_value result;
+  status = napi_create_object(env, &result);
+  CHECK_STATUS;
+
+  napi_value embedded;
+  status = napi_create_external(env, f, finalizeFrameSync, nullptr, &embedded);
+  if (status != napi_ok) finalizeFrameSync(env, f, nullptr);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "embedded", embedded);
+  CHECK_STATUS;
+
+  napi_value fn;
+  status = napi_create_function(env, "video", NAPI_AUTO_LENGTH, frameSyncVideo,
+    nullptr, &fn);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "video", fn);
+  CHECK_STATUS;
+
+  status = napi_create_function(env, "audio", NAPI_AUTO_LENGTH, frameSyncAudio,
+    nullptr, &fn);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "audio", fn);
+  CHECK_STATUS;
+
+  status = napi_create_function(env, "audioQueueDepth", NAPI_AUTO_LENGTH,
+    frameSyncAudioQueueDepth, nullptr, &fn);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "audioQueueDepth", fn);
+  CHECK_STATUS;
+
+  status = napi_create_function(env, "destroy", NAPI_AUTO_LENGTH, frameSyncDestroy,
+    nullptr, &fn);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "destroy", fn);
+  CHECK_STATUS;
+
+  return result;
+}
+
+// frameSync.video({ frameFormatType, into }) returns the frame to show now,
+// repeating or skipping frames to follow the caller's clock, or null if no
+// video has arrived yet. Any outputFormat of the receiver applies.
+napi_value frameSyncVideo(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_valuetype type;
+
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  CHECK_STATUS;
+  frameSyncInstance* f;
+  status = getFrameSync(env, thisValue, &f);
+  CHECK_STATUS;
+  if (f->sync == nullptr)
+    NAPI_THROW_ERROR("Frame synchronizer has been destroyed.");
+
+  dataCarrier* c = new dataCarrier;
+  NDIlib_frame_format_type_e fieldType = NDIlib_frame_format_type_progressive;
+  if (argc >= 1) {
+    status = napi_typeof(env, args[0], &type);
+    if (status != napi_ok) tidyCarrier(env, c);
+    CHECK_STATUS;
+    if (type == napi_object) {
+      napi_value param;
+      status = napi_get_named_property(env, args[0], "frameFormatType", &param);
+      if (status == napi_ok) status = napi_typeof(env, param, &type);
+      if (status != napi_ok) tidyCarrier(env, c);
+      CHECK_STATUS;
+      if (type == napi_number) {
+        status = napi_get_value_int32(env, param, (int32_t*) &fieldType);
+        if (status != napi_ok) tidyCarrier(env, c);
+        CHECK_STATUS;
+        if (!validFrameFormat(fieldType)) {
+          c->status = GRANDIOSE_INVALID_ARGS;
+          c->errorMsg = "Invalid frame format type value.";
+          return throwCarrierError(env, c);
+        }
+      }
+      else if (type != napi_undefined) {
+        c->status = GRANDIOSE_INVALID_ARGS;
+        c->errorMsg = "Frame format type must be a number if present.";
+        return throwCarrierError(env, c);
+      }
+      readIntoOption(env, args[0], c);
+      if (c->status != GRANDIOSE_SUCCESS) return throwCarrierError(env, c);
+    }
+  }
+
+  c->instance = f->instance;
+  retainReceive(c->instance);
+  c->recv = c->instance->recv;
+  c->sync = f->sync;
+  NDIlib_framesync_capture_video(f->sync, &c->videoFrame, fieldType);
+  if (c->videoFrame.p_data == nullptr) {
+    freeVideoFrame(c);
+    tidyCarrier(env, c);
+    napi_value result;
+    status = napi_get_null(env, &result);
+    CHECK_STATUS;
+    return result;
+  }
+
+  convertVideoFrame(c);
+  if (c->status != GRANDIOSE_SUCCESS) return throwCarrierError(env, c);
+
+  napi_value result;
+  status = makeVideoFrame(env, c, &result);
+  tidyCarrier(env, c);
+  CHECK_STATUS;
+  return result;
+}
+
+// frameSync.audio(samples, { sampleRate, channels, audioFormat,
+// referenceLevel, into }) returns exactly the number of samples asked for,
+// resampled to follow the caller's clock and padded with silence when too
+// few have arrived. The sample rate and channels default to the source's.
+napi_value frameSyncAudio(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_valuetype type;
+
+  size_t argc = 2;
+  napi_value args[2];
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  CHECK_STATUS;
+  frameSyncInstance* f;
+  status = getFrameSync(env, thisValue, &f);
+  CHECK_STATUS;
+  if (f->sync == nullptr)
+    NAPI_THROW_ERROR("Frame synchronizer has been destroyed.");
+
+  if (argc < 1)
+    NAPI_THROW_ERROR("Number of samples must be a positive number.");
+  status = napi_typeof(env, args[0], &type);
+  CHECK_STATUS;
+  if (type != napi_number)
+    NAPI_THROW_ERROR("Number of samples must be a positive number.");
+  int32_t samples;
+  status = napi_get_value_int32(env, args[0], &samples);
+  CHECK_STATUS;
+  if (samples <= 0)
+    NAPI_THROW_ERROR("Number of samples must be a positive number.");
+
+  dataCarrier* c = new dataCarrier;
+  int32_t sampleRate = 0;
+  int32_t channels = 0;
+  if (argc >= 2) {
+    status = napi_typeof(env, args[1], &type);
+    if (status != napi_ok) tidyCarrier(env, c);
+    CHECK_STATUS;
+    if (type == napi_object) {
+      const char* names[] = { "sampleRate", "channels", "audioFormat", "referenceLevel" };
+      int32_t values[] = { 0, 0, (int32_t) c->audioFormat, c->referenceLevel };
+      for ( int x = 0 ; x < 4 ; x++ ) {
+        napi_value param;
+        status = napi_get_named_property(env, args[1], names[x], &param);
+        if (status == napi_ok) status = napi_typeof(env, param, &type);
+        if (status != napi_ok) tidyCarrier(env, c);
+        CHECK_STATUS;
+        if (type == napi_number) {
+          status = napi_get_value_int32(env, param, &values[x]);
+          if (status != napi_ok) tidyCarrier(env, c);
+          CHECK_STATUS;
+        }
+        else if (type != napi_undefined) {
+          c->status = GRANDIOSE_INVALID_ARGS;
+          c->errorMsg = std::string("Frame synchronizer audio ") + names[x] +
+            " must be a number if present.";
+          return throwCarrierError(env, c);
+        }
+      }
+      sampleRate = values[0];
+      channels = values[1];
+      if ((sampleRate < 0) || (channels < 0)) {
+        c->status = GRANDIOSE_INVALID_ARGS;
+        c->errorMsg = "Sample rate and channels must not be negative.";
+        return throwCarrierError(env, c);
+      }
+      if (!validAudioFormat((Grandiose_audio_format_e) values[2])) {
+        c->status = GRANDIOSE_INVALID_ARGS;
+        c->errorMsg = "Invalid audio format specified.";
+        return throwCarrierError(env, c);
+      }
+      c->audioFormat = (Grandiose_audio_format_e) values[2];
+      c->referenceLevel = values[3];
+      readIntoOption(env, args[1], c);
+      if (c->status != GRANDIOSE_SUCCESS) return throwCarrierError(env, c);
+    }
+  }
+
+  c->instance = f->instance;
+  retainReceive(c->instance);
+  c->recv = c->instance->recv;
+  c->sync = f->sync;
+  NDIlib_framesync_capture_audio(f->sync, &c->audioFrame, sampleRate, channels, samples);
+
+  convertAudioFrame(c);
+  if (c->status != GRANDIOSE_SUCCESS) return throwCarrierError(env, c);
+
+  napi_value result;
+  status = makeAudioFrame(env, c, &result);
+  tidyCarrier(env, c);
+  CHECK_STATUS;
+  return result;
+}
+
+// frameSync.audioQueueDepth() is the number of samples buffered, for callers
+// that pull audio when enough has arrived rather than on a clock
+napi_value frameSyncAudioQueueDepth(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &thisValue, nullptr);
+  CHECK_STATUS;
+  frameSyncInstance* f;
+  status = getFrameSync(env, thisValue, &f);
+  CHECK_STATUS;
+  if (f->sync == nullptr)
+    NAPI_THROW_ERROR("Frame synchronizer has been destroyed.");
+
+  napi_value result;
+  status = napi_create_int32(env, NDIlib_framesync_audio_queue_depth(f->sync), &result);
+  CHECK_STATUS;
+  return result;
+}
+
+// frameSync.destroy() hands video and audio back to the receiver
+napi_value frameSyncDestroy(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &thisValue, nullptr);
+  CHECK_STATUS;
+
+  frameSyncInstance* f;
+  status = getFrameSync(env, thisValue, &f);
+  CHECK_STATUS;
+  destroyFrameSync(f);
+
+  napi_value undefined;
+  status = napi_get_undefined(env, &undefined);
+  CHECK_STATUS;
+  return undefined;
+}
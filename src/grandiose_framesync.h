@@ -0,0 +1,40 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef GRANDIOSE_FRAMESYNC_H
+#define GRANDIOSE_FRAMESYNC_H
+
+#include <Processing.NDI.Lib.h>
+#include "node_api.h"
+#include "grandiose_util.h"
+
+struct receiveInstance;
+
+// NDI frame synchronizer on a receiver, created with receiver.frameSync().
+// It takes over the receiver's video and audio, which are then pulled on the
+// caller's own clock with synchronous calls that return immediately. Holds a
+// reference on the receiver until destroyed or garbage collected.
+struct frameSyncInstance {
+  NDIlib_framesync_instance_t sync = nullptr;
+  receiveInstance* instance = nullptr;
+};
+
+napi_value receiveFrameSync(napi_env env, napi_callback_info info);
+napi_value frameSyncVideo(napi_env env, napi_callback_info info);
+napi_value frameSyncAudio(napi_env env, napi_callback_info info);
+napi_value frameSyncAudioQueueDepth(napi_env env, napi_callback_info info);
+napi_value frameSyncDestroy(napi_env env, napi_callback_info info);
+
+#endif /* GRANDIOSE_FRAMESYNC_H */
@@ -0,0 +1,165 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <algorithm>
+#include <cstring>
+#include "grandiose_mux.h"
+
+uint64_t cadenceStart(uint64_t frame, int32_t sampleRate, int32_t frameRateN, int32_t frameRateD) {
+  // Whole cycles of N frames hold exactly rate * D samples
+  uint64_t perCycle = (uint64_t) sampleRate * frameRateD;
+  return (frame / frameRateN) * perCycle + (frame % frameRateN) * perCycle / frameRateN;
+}
+
+void audioMux::configure(int32_t sampleRate, int32_t channels, uint32_t samples, int32_t newOffset) {
+  std::lock_guard<std::mutex> guard(lock);
+  int64_t delta = (int64_t) newOffset - offset;
+  if (!on || (sampleRate != rate) || (channels != chans) || (samples != capacity)) {
+    ring.assign((size_t) channels * samples, 0.0f);
+    capacity = samples;
+    head = tail = 0;
+    pendingDiscard = 0;
+    cadenceN = cadenceD = 0;
+    frame = 0;
+    delta = newOffset;
+  }
+  on = true;
+  rate = sampleRate;
+  chans = channels;
+  offset = newOffset;
+
+  // Silence first cancels any discard still to come
+  if (delta > 0) {
+    uint32_t cancel = std::min(pendingDiscard, (uint32_t) delta);
+    pendingDiscard -= cancel;
+    delta -= cancel;
+  }
+  if (delta > 0) append(nullptr, (uint32_t) std::min<int64_t>(delta, capacity), 0);
+  if (delta < 0) discard((uint32_t) -delta);
+  buffered = (uint32_t) (tail - head);
+}
+
+bool audioMux::enabled() {
+  std::lock_guard<std::mutex> guard(lock);
+  return on;
+}
+
+int32_t audioMux::channels() {
+  std::lock_guard<std::mutex> guard(lock);
+  return chans;
+}
+
+void audioMux::push(const float* data, uint32_t samples, int32_t channelStride) {
+  std::lock_guard<std::mutex> guard(lock);
+  if (on) append(data, samples, channelStride);
+}
+
+// Lock held. Null data appends silence.
+void audioMux::append(const float* data, uint32_t samples, int32_t channelStride) {
+  uint32_t skip = std::min(pendingDiscard, samples);
+  pendingDiscard -= skip;
+  // Only the newest samples can fit
+  if (samples - skip > capacity) {
+    discarded += samples - skip - capacity;
+    skip = samples - capacity;
+  }
+  uint32_t count = samples - skip;
+  if (count == 0) return;
+
+  uint64_t room = capacity - (tail - head);
+  if (count > room) {
+    discarded += count - room;
+    head += count - room;
+  }
+  for ( int32_t ch = 0 ; ch < chans ; ch++ ) {
+    float* dst = ring.data() + (size_t) ch * capacity;
+    const float* src = (data == nullptr) ? nullptr :
+      (const float*) ((const uint8_t*) data + (size_t) ch * channelStride) + skip;
+    uint32_t at = (uint32_t) (tail % capacity);
+    uint32_t first = std::min(count, capacity - at);
+    if (src == nullptr) {
+      memset(dst + at, 0, first * sizeof(float));
+      memset(dst, 0, (count - first) * sizeof(float));
+    } else {
+      memcpy(dst + at, src, first * sizeof(float));
+      memcpy(dst, src + first, (count - first) * sizeof(float));
+    }
+  }
+  tail += count;
+  buffered = (uint32_t) (tail - head);
+}
+
+// Lock held
+void audioMux::discard(uint32_t samples) {
+  uint32_t available = (uint32_t) (tail - head);
+  uint32_t now = std::min(samples, available);
+  head += now;
+  pendingDiscard += samples - now;
+}
+
+void audioMux::skip() {
+  skipped++;
+}
+
+// Lock held. Samples for the next frame in the cadence.
+uint32_t audioMux::cadence(int32_t frameRateN, int32_t frameRateD) {
+  if ((frameRateN != cadenceN) || (frameRateD != cadenceD)) {
+    cadenceN = frameRateN;
+    cadenceD = frameRateD;
+    frame = 0;
+  }
+  uint64_t samples = cadenceStart(frame + 1, rate, frameRateN, frameRateD) -
+    cadenceStart(frame, rate, frameRateN, frameRateD);
+  // The cadence repeats every N frames
+  frame = (frame + 1) % (uint64_t) frameRateN;
+  return (uint32_t) samples;
+}
+
+bool audioMux::take(int32_t frameRateN, int32_t frameRateD, int64_t timecode,
+    NDIlib_audio_frame_v3_t* audioFrame) {
+  std::lock_guard<std::mutex> guard(lock);
+  if (!on || (frameRateN <= 0) || (frameRateD <= 0)) return false;
+
+  uint32_t frames = skipped.exchange(0) + 1;
+  uint32_t samples = 0;
+  for ( uint32_t x = 0 ; x < frames ; x++ )
+    samples += cadence(frameRateN, frameRateD);
+
+  out.resize((size_t) chans * samples);
+  uint32_t count = std::min(samples, (uint32_t) (tail - head));
+  uint32_t at = (uint32_t) (head % std::max(capacity, 1u));
+  uint32_t first = std::min(count, capacity - at);
+  for ( int32_t ch = 0 ; ch < chans ; ch++ ) {
+    const float* src = ring.data() + (size_t) ch * capacity;
+    float* dst = out.data() + (size_t) ch * samples;
+    memcpy(dst, src + at, first * sizeof(float));
+    memcpy(dst + first, src, (count - first) * sizeof(float));
+    memset(dst + count, 0, (samples - count) * sizeof(float));
+  }
+  head += count;
+  silence += samples - count;
+  buffered = (uint32_t) (tail - head);
+
+  audioFrame->sample_rate = rate;
+  audioFrame->no_channels = chans;
+  audioFrame->no_samples = (int) samples;
+  audioFrame->timecode = timecode;
+  audioFrame->FourCC = NDIlib_FourCC_audio_type_FLTP;
+  audioFrame->p_data = (uint8_t*) out.data();
+  audioFrame->channel_stride_in_bytes = (int) (samples * sizeof(float));
+  audioFrame->p_metadata = nullptr;
+  audioFrame->timestamp = 0;
+  return true;
+}
@@ -0,0 +1,93 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef GRANDIOSE_MUX_H
+#define GRANDIOSE_MUX_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <Processing.NDI.Lib.h>
+
+// First sample of the audio that goes with the given video frame, counting
+// from the start of both, so frame k has cadenceStart(k + 1) - cadenceStart(k)
+uint64_t cadenceStart(uint64_t frame, int32_t sampleRate, int32_t frameRateN, int32_t frameRateD);
+
+// Buffers a sender's audio, as planar 32-bit float, and slices it into
+// frames that match the video frames being sent. Frame k of a video with
+// frame rate N/D carries floor((k+1)*rate*D/N) - floor(k*rate*D/N) samples,
+// so 48kHz at 59.94fps gives the 800/801 cadence. Audio is added on the main
+// thread and taken on the sender's thread.
+class audioMux {
+public:
+  audioMux() = default;
+  audioMux(const audioMux&) = delete;
+  audioMux& operator=(const audioMux&) = delete;
+
+  // Sets the format and capacity of the buffer, in samples per channel. The
+  // offset delays audio against video when positive, by inserting silence,
+  // and advances it when negative, by discarding samples. Buffered audio is
+  // kept if the format is unchanged, moved by the change in offset.
+  void configure(int32_t sampleRate, int32_t channels, uint32_t capacity, int32_t offset);
+  bool enabled();
+  int32_t channels();
+
+  // Appends samples, each channel channelStride bytes after the last. The
+  // oldest samples are discarded once the buffer is full.
+  void push(const float* data, uint32_t samples, int32_t channelStride);
+
+  // Counts a video frame dropped before it was sent. Its audio goes with
+  // the next frame that is sent, so that the audio stays continuous.
+  void skip();
+
+  // Fills the audio frame for the next video frame, with the video frame's
+  // timecode, padding with silence if too little audio is buffered. The
+  // frame's data is valid until the next call. Returns false if muxing is
+  // not enabled.
+  bool take(int32_t frameRateN, int32_t frameRateD, int64_t timecode,
+    NDIlib_audio_frame_v3_t* frame);
+
+  std::atomic<uint32_t> buffered { 0 };
+  std::atomic<uint64_t> silence { 0 };
+  std::atomic<uint64_t> discarded { 0 };
+
+private:
+  void append(const float* data, uint32_t samples, int32_t channelStride);
+  void discard(uint32_t samples);
+  uint32_t cadence(int32_t frameRateN, int32_t frameRateD);
+
+  std::mutex lock;
+  bool on = false;
+  int32_t rate = 0;
+  int32_t chans = 0;
+  int32_t offset = 0;
+  // Planar ring of capacity samples per channel
+  std::vector<float> ring;
+  uint32_t capacity = 0;
+  uint64_t head = 0;
+  uint64_t tail = 0;
+  // Samples still to be discarded as they arrive, for a negative offset
+  uint32_t pendingDiscard = 0;
+  // Position in the cadence, restarted when the frame rate changes
+  int32_t cadenceN = 0;
+  int32_t cadenceD = 0;
+  uint64_t frame = 0;
+  std::atomic<uint32_t> skipped { 0 };
+  // Sender's thread only
+  std::vector<float> out;
+};
+
+#endif /* GRANDIOSE_MUX_H */
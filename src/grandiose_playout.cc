@@ -0,0 +1,989 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "grandiose_playout.h"
+#include "grandiose_send.h"
+#include "grandiose_util.h"
+#include "grandiose_convert.h"
+#include "grandiose_mux.h"
+
+#ifdef _WIN32
+
+bool mapFile(const std::string& path, mappedFile* f) {
+  f->file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (f->file == INVALID_HANDLE_VALUE) return false;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(f->file, &size) || (size.QuadPart == 0)) {
+    unmapFile(f);
+    return false;
+  }
+  f->mapping = CreateFileMappingA(f->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (f->mapping == nullptr) {
+    unmapFile(f);
+    return false;
+  }
+  f->data = (uint8_t*) MapViewOfFile(f->mapping, FILE_MAP_READ, 0, 0, 0);
+  if (f->data == nullptr) {
+    unmapFile(f);
+    return false;
+  }
+  f->size = (size_t) size.QuadPart;
+  return true;
+}
+
+void unmapFile(mappedFile* f) {
+  if (f->data != nullptr) UnmapViewOfFile(f->data);
+  if (f->mapping != nullptr) CloseHandle(f->mapping);
+  if (f->file != INVALID_HANDLE_VALUE) CloseHandle(f->file);
+  f->data = nullptr;
+  f->mapping = nullptr;
+  f->file = INVALID_HANDLE_VALUE;
+  f->size = 0;
+}
+
+void prefetchFile(const mappedFile* f, size_t offset, size_t length) {
+#if _WIN32_WINNT >= 0x0602
+  if ((f->data == nullptr) || (offset >= f->size)) return;
+  WIN32_MEMORY_RANGE_ENTRY range;
+  range.VirtualAddress = f->data + offset;
+  range.NumberOfBytes = std::min(length, f->size - offset);
+  PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+}
+
+#else
+
+bool mapFile(const std::string& path, mappedFile* f) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  struct stat info;
+  if ((fstat(fd, &info) != 0) || (info.st_size <= 0)) {
+    close(fd);
+    return false;
+  }
+  void* data = mmap(nullptr, (size_t) info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping keeps the file open
+  close(fd);
+  if (data == MAP_FAILED) return false;
+  f->data = (uint8_t*) data;
+  f->size = (size_t) info.st_size;
+  return true;
+}
+
+void unmapFile(mappedFile* f) {
+  if (f->data != nullptr) munmap(f->data, f->size);
+  f->data = nullptr;
+  f->size = 0;
+}
+
+void prefetchFile(const mappedFile* f, size_t offset, size_t length) {
+  if ((f->data == nullptr) || (offset >= f->size)) return;
+  // madvise needs a page aligned start
+  size_t page = (size_t) sysconf(_SC_PAGESIZE);
+  size_t start = offset / page * page;
+  size_t end = std::min(offset + length, f->size);
+  madvise(f->data + start, end - start, MADV_WILLNEED);
+}
+
+#endif
+
+// Reads the stream header of a YUV4MPEG2 file. Only 4:2:0 is sent, as I420,
+// and each frame must have a plain FRAME header.
+bool parseY4M(playoutInstance* p, std::string* error) {
+  const char* text = (const char*) p->video.data;
+  size_t limit = std::min(p->video.size, (size_t) 4096);
+  const char* end = (const char*) memchr(text, '\n', limit);
+  if (end == nullptr) {
+    *error = "Y4M stream header is not terminated.";
+    return false;
+  }
+  std::string header(text + 10, end);
+  std::string colorSpace = "420jpeg";
+  int32_t parN = 0, parD = 0;
+  p->format.frame_format_type = NDIlib_frame_format_type_progressive;
+
+  size_t at = 0;
+  while (at < header.size()) {
+    size_t next = header.find(' ', at);
+    if (next == std::string::npos) next = header.size();
+    std::string token = header.substr(at, next - at);
+    at = next + 1;
+    if (token.empty()) continue;
+    const char* value = token.c_str() + 1;
+    switch (token[0]) {
+      case 'W':
+        p->format.xres = atoi(value);
+        break;
+      case 'H':
+        p->format.yres = atoi(value);
+        break;
+      case 'F':
+        if (sscanf(value, "%d:%d", &p->format.frame_rate_N, &p->format.frame_rate_D) != 2) {
+          *error = "Y4M frame rate is not valid.";
+          return false;
+        }
+        break;
+      case 'A':
+        if (sscanf(value, "%d:%d", &parN, &parD) != 2) parN = parD = 0;
+        break;
+      case 'I':
+        if ((token[1] == 't') || (token[1] == 'b'))
+          p->format.frame_format_type = NDIlib_frame_format_type_interleaved;
+        break;
+      case 'C':
+        colorSpace = value;
+        break;
+      default:
+        break;
+    }
+  }
+
+  // Only 8-bit 4:2:0 is played, not C420p10 and the like
+  if ((colorSpace != "420") && (colorSpace != "420jpeg") &&
+      (colorSpace != "420mpeg2") && (colorSpace != "420paldv")) {
+    *error = "Y4M files must be 4:2:0 to be played.";
+    return false;
+  }
+  if ((p->format.xres <= 0) || (p->format.yres <= 0) ||
+      (p->format.xres % 2 != 0) || (p->format.yres % 2 != 0)) {
+    *error = "Y4M frame size must be given and even.";
+    return false;
+  }
+  p->format.FourCC = NDIlib_FourCC_video_type_I420;
+  p->format.line_stride_in_bytes = p->format.xres;
+  p->format.picture_aspect_ratio = ((parN > 0) && (parD > 0)) ?
+    (float) ((double) p->format.xres * parN / ((double) p->format.yres * parD)) : 0.0f;
+
+  size_t headerBytes = (size_t) (end - text) + 1;
+  size_t frameBytes = videoFrameBytes(p->format.FourCC, p->format.xres, p->format.yres,
+    p->format.line_stride_in_bytes);
+  p->firstFrame = headerBytes + 6;
+  p->frameSpacing = frameBytes + 6;
+  if ((p->video.size >= p->firstFrame) && (memcmp(p->video.data + headerBytes, "FRAME\n", 6) != 0)) {
+    *error = "Y4M frame parameters are not supported.";
+    return false;
+  }
+  p->frames = (uint32_t) ((p->video.size - headerBytes) / p->frameSpacing);
+  return true;
+}
+
+// Finds the format and sample data of a WAV file with 16-bit or 32-bit float
+// samples.
+bool parseWAV(playoutInstance* p, std::string* error) {
+  const uint8_t* data = p->audio.data;
+  size_t size = p->audio.size;
+  if ((size < 12) || (memcmp(data, "RIFF", 4) != 0) || (memcmp(data + 8, "WAVE", 4) != 0)) {
+    *error = "Audio file is not a WAV file.";
+    return false;
+  }
+
+  uint16_t format = 0, bits = 0;
+  bool haveFormat = false;
+  size_t at = 12;
+  while (at + 8 <= size) {
+    uint32_t chunkSize;
+    memcpy(&chunkSize, data + at + 4, 4);
+    const uint8_t* chunk = data + at + 8;
+    if ((memcmp(data + at, "fmt ", 4) == 0) && (chunkSize >= 16) && (at + 8 + 16 <= size)) {
+      uint16_t channels;
+      uint32_t rate;
+      memcpy(&format, chunk, 2);
+      memcpy(&channels, chunk + 2, 2);
+      memcpy(&rate, chunk + 4, 4);
+      memcpy(&bits, chunk + 14, 2);
+      // WAVE_FORMAT_EXTENSIBLE gives the format in its sub-format GUID
+      if ((format == 0xFFFE) && (chunkSize >= 40) && (at + 8 + 26 <= size))
+        memcpy(&format, chunk + 24, 2);
+      p->channels = channels;
+      p->sampleRate = (int32_t) rate;
+      haveFormat = true;
+    }
+    else if (memcmp(data + at, "data", 4) == 0) {
+      if (!haveFormat) break;
+      p->audioOffset = at + 8;
+      size_t bytes = std::min((size_t) chunkSize, size - p->audioOffset);
+      p->audioFloat = (format == 3) && (bits == 32);
+      if (!p->audioFloat && !((format == 1) && (bits == 16))) {
+        *error = "WAV audio must be 16-bit PCM or 32-bit float.";
+        return false;
+      }
+      if ((p->channels <= 0) || (p->sampleRate <= 0)) {
+        *error = "WAV audio format is not valid.";
+        return false;
+      }
+      p->audioSamples = bytes / ((size_t) p->channels * (bits / 8));
+      return true;
+    }
+    at += 8 + chunkSize + (chunkSize & 1);
+  }
+  *error = "WAV file has no audio data.";
+  return false;
+}
+
+// Next frame to play after the given one, or outPoint at the end
+uint32_t nextFrame(const playoutInstance* p, uint32_t frame) {
+  frame++;
+  if ((frame >= p->outPoint) && p->loop) frame = p->inPoint;
+  return frame;
+}
+
+void prefetchFrames(playoutInstance* p, uint32_t frame, uint32_t count) {
+  for ( uint32_t x = 0 ; (x < count) && (frame < p->outPoint) ; x++ ) {
+    prefetchFile(&p->video, p->firstFrame + (size_t) frame * p->frameSpacing, p->frameSpacing);
+    if (p->audioSamples > 0) {
+      uint64_t start = cadenceStart(frame, p->sampleRate, p->format.frame_rate_N, p->format.frame_rate_D);
+      uint64_t end = cadenceStart(frame + 1, p->sampleRate, p->format.frame_rate_N, p->format.frame_rate_D);
+      size_t sampleBytes = (size_t) p->channels * (p->audioFloat ? 4 : 2);
+      prefetchFile(&p->audio, p->audioOffset + start * sampleBytes, (end - start) * sampleBytes);
+    }
+    frame = nextFrame(p, frame);
+  }
+}
+
+// Sends the audio that spans a frame straight from the mapped WAV file
+void sendFrameAudio(playoutInstance* p, uint32_t frame) {
+  if (p->audioSamples == 0) return;
+  uint64_t start = cadenceStart(frame, p->sampleRate, p->format.frame_rate_N, p->format.frame_rate_D);
+  if (start >= p->audioSamples) return;
+  uint64_t end = std::min(p->audioSamples,
+    cadenceStart(frame + 1, p->sampleRate, p->format.frame_rate_N, p->format.frame_rate_D));
+  size_t sampleBytes = (size_t) p->channels * (p->audioFloat ? 4 : 2);
+  uint8_t* data = p->audio.data + p->audioOffset + start * sampleBytes;
+
+  if (p->audioFloat) {
+    NDIlib_audio_frame_interleaved_32f_t audioFrame;
+    audioFrame.sample_rate = p->sampleRate;
+    audioFrame.no_channels = p->channels;
+    audioFrame.no_samples = (int) (end - start);
+    audioFrame.timecode = NDIlib_send_timecode_synthesize;
+    audioFrame.p_data = (float*) data;
+    NDIlib_util_send_send_audio_interleaved_32f(p->send, &audioFrame);
+  } else {
+    NDIlib_audio_frame_interleaved_16s_t audioFrame;
+    audioFrame.sample_rate = p->sampleRate;
+    audioFrame.no_channels = p->channels;
+    audioFrame.no_samples = (int) (end - start);
+    audioFrame.timecode = NDIlib_send_timecode_synthesize;
+    audioFrame.reference_level = 0;
+    audioFrame.p_data = (int16_t*) data;
+    NDIlib_util_send_send_audio_interleaved_16s(p->send, &audioFrame);
+  }
+}
+
+// Time from the start of playout to the given tick of the frame clock
+std::chrono::nanoseconds frameTime(const playoutInstance* p, uint64_t tick) {
+  uint64_t n = (uint64_t) p->format.frame_rate_N;
+  uint64_t perCycle = (uint64_t) p->format.frame_rate_D * 1000000000;
+  return std::chrono::nanoseconds((tick / n) * perCycle + (tick % n) * perCycle / n);
+}
+
+void playoutLoop(playoutInstance* p) {
+  auto start = std::chrono::steady_clock::now();
+  uint64_t tick = 0;
+  uint32_t frame = p->inPoint;
+
+  while (p->playing) {
+    int64_t cue = p->cue.exchange(-1);
+    if (cue >= 0) frame = (uint32_t) cue;
+    if (frame >= p->outPoint) break;
+
+    uint8_t* data;
+    if (p->signal != nullptr) {
+      data = renderSignal(p->signal, frame);
+      // Audio first, so that it is never behind its frame
+      sendSignalAudio(p->signal, p->send, frame, p->format.frame_rate_N, p->format.frame_rate_D);
+    } else {
+      data = p->video.data + p->firstFrame + (size_t) frame * p->frameSpacing;
+      if (p->y4m && (memcmp(data - 6, "FRAME\n", 6) != 0)) {
+        p->error = "Y4M frame parameters are not supported.";
+        break;
+      }
+      sendFrameAudio(p, frame);
+    }
+    p->format.p_data = data;
+    NDIlib_send_send_video_async_v2(p->send, &p->format);
+    p->position = frame;
+    p->sent++;
+
+    // Keep the pages of the next few frames on their way in
+    uint32_t ahead = frame;
+    for ( uint32_t x = 0 ; x < p->readahead ; x++ ) ahead = nextFrame(p, ahead);
+    prefetchFrames(p, ahead, 1);
+
+    frame = nextFrame(p, frame);
+    tick++;
+    // Frames whose time has passed are skipped to hold the frame rate
+    auto now = std::chrono::steady_clock::now();
+    while ((start + frameTime(p, tick + 1) <= now) && (frame < p->outPoint)) {
+      frame = nextFrame(p, frame);
+      tick++;
+      p->skipped++;
+    }
+    std::this_thread::sleep_until(start + frameTime(p, tick));
+  }
+
+  // Wait for NDI to finish with the last frame before it is unmapped or freed
+  NDIlib_send_send_video_async_v2(p->send, nullptr);
+  napi_release_threadsafe_function(p->endFn, napi_tsfn_release);
+}
+
+// Never called, as nothing is queued. The threadsafe function exists only so
+// that playoutFinalize runs on the JavaScript thread when playout ends, and
+// N-API requires a call_js callback when no JavaScript function is given.
+void playoutCallJS(napi_env env, napi_value callback, void* context, void* data) {
+}
+
+void playoutFinalize(napi_env env, void* data, void* hint) {
+  sendInstance* s = (sendInstance*) hint;
+  playoutInstance* p = s->playout;
+  napi_status status;
+
+  p->playing = false;
+  if (p->thread.joinable()) p->thread.join();
+  s->playout = nullptr;
+  s->holdSuspended = false;
+
+  if (p->error.empty()) {
+    napi_value result, param;
+    status = napi_create_object(env, &result);
+    FLOATING_STATUS;
+    status = napi_create_double(env, (double) p->sent, &param);
+    FLOATING_STATUS;
+    status = napi_set_named_property(env, result, "sent", param);
+    FLOATING_STATUS;
+    status = napi_create_double(env, (double) p->skipped, &param);
+    FLOATING_STATUS;
+    status = napi_set_named_property(env, result, "skipped", param);
+    FLOATING_STATUS;
+    status = napi_create_uint32(env, p->position, &param);
+    FLOATING_STATUS;
+    status = napi_set_named_property(env, result, "position", param);
+    FLOATING_STATUS;
+    status = napi_resolve_deferred(env, p->ended, result);
+    FLOATING_STATUS;
+  } else {
+    carrier* c = new carrier;
+    c->_deferred = p->ended;
+    c->status = GRANDIOSE_INVALID_ARGS;
+    c->errorMsg = p->error;
+    rejectStatus(env, c, __FILE__, __LINE__);
+  }
+
+  if (p->stopped != nullptr) {
+    napi_value undefined;
+    status = napi_get_undefined(env, &undefined);
+    FLOATING_STATUS;
+    status = napi_resolve_deferred(env, p->stopped, undefined);
+    FLOATING_STATUS;
+  }
+
+  delete p;
+  releaseSend(s);
+}
+
+void stopPlayout(sendInstance* s) {
+  if (s->playout != nullptr) s->playout->playing = false;
+}
+
+// Hands the playout to its own thread, which settles the carrier's promise
+// once playout ends
+void startPlayout(napi_env env, sendInstance* s, std::unique_ptr<playoutInstance>& owner,
+    carrier* c) {
+  playoutInstance* p = owner.get();
+  napi_value resource_name;
+  c->status = napi_create_string_utf8(env, "SendPlayout", NAPI_AUTO_LENGTH, &resource_name);
+  CARRIER_STATUS;
+  c->status = napi_create_threadsafe_function(env, nullptr, nullptr, resource_name,
+    1, 1, nullptr, playoutFinalize, s, playoutCallJS, &p->endFn);
+  CARRIER_STATUS;
+
+  owner.release();
+  retainSend(s);
+  s->playout = p;
+  s->holdSuspended = true;
+  p->send = s->send;
+  p->ended = c->_deferred;
+  c->_deferred = nullptr;
+
+  p->playing = true;
+  p->thread = std::thread(playoutLoop, p);
+}
+
+// Reads a frame number option, leaving value unchanged if undefined
+void parseFrameNumber(napi_env env, napi_value config, const char* name,
+    uint32_t* value, carrier* c) {
+  int32_t number = (int32_t) *value;
+  parseOptionalInt32(env, config, name, &number, c);
+  CARRIER_STATUS;
+  if (number < 0) CARRIER_ERROR(
+    "inPoint and outPoint must not be negative",
+    GRANDIOSE_INVALID_ARGS);
+  *value = (uint32_t) number;
+}
+
+// Reads frameRateN and frameRateD, or fps, leaving the frame rate unchanged
+// if neither is given
+void parseFrameRate(napi_env env, napi_value config, NDIlib_video_frame_v2_t* format,
+    carrier* c) {
+  napi_valuetype type;
+  napi_value param;
+
+  parseOptionalInt32(env, config, "frameRateN", &format->frame_rate_N, c);
+  CARRIER_STATUS;
+  parseOptionalInt32(env, config, "frameRateD", &format->frame_rate_D, c);
+  CARRIER_STATUS;
+  c->status = napi_get_named_property(env, config, "fps", &param);
+  CARRIER_STATUS;
+  c->status = napi_typeof(env, param, &type);
+  CARRIER_STATUS;
+  if (type == napi_number) {
+    double fps;
+    c->status = napi_get_value_double(env, param, &fps);
+    CARRIER_STATUS;
+    // Rates such as 29.97 are taken to mean 30000/1001
+    double whole = std::round(fps * 1.001);
+    if (std::fabs(fps - whole / 1.001) < 0.005 && std::fabs(fps - std::round(fps)) > 0.005) {
+      format->frame_rate_N = (int32_t) whole * 1000;
+      format->frame_rate_D = 1001;
+    } else {
+      format->frame_rate_N = (int32_t) std::round(fps * 1000);
+      format->frame_rate_D = 1000;
+    }
+  }
+  else if (type != napi_undefined) CARRIER_ERROR(
+    "fps value must be a number",
+    GRANDIOSE_INVALID_ARGS);
+}
+
+// Reads the options of sender.playFile(). The format of raw files must be
+// given, while Y4M files give their own size and format.
+void parsePlayoutOptions(napi_env env, napi_value config, playoutInstance* p, carrier* c) {
+  napi_valuetype type;
+  napi_value param;
+
+  if (!p->y4m) {
+    int32_t fourCC = 0;
+    parseOptionalInt32(env, config, "fourCC", &fourCC, c);
+    CARRIER_STATUS;
+    parseOptionalInt32(env, config, "xres", &p->format.xres, c);
+    CARRIER_STATUS;
+    parseOptionalInt32(env, config, "yres", &p->format.yres, c);
+    CARRIER_STATUS;
+    p->format.FourCC = (NDIlib_FourCC_video_type_e) fourCC;
+    p->format.line_stride_in_bytes = defaultLineStride(p->format.FourCC, p->format.xres);
+    parseOptionalInt32(env, config, "lineStrideBytes", &p->format.line_stride_in_bytes, c);
+    CARRIER_STATUS;
+    int32_t formatType = (int32_t) p->format.frame_format_type;
+    parseOptionalInt32(env, config, "frameFormatType", &formatType, c);
+    CARRIER_STATUS;
+    p->format.frame_format_type = (NDIlib_frame_format_type_e) formatType;
+  }
+
+  c->status = napi_get_named_property(env, config, "pictureAspectRatio", &param);
+  CARRIER_STATUS;
+  c->status = napi_typeof(env, param, &type);
+  CARRIER_STATUS;
+  if (type == napi_number) {
+    double ratio;
+    c->status = napi_get_value_double(env, param, &ratio);
+    CARRIER_STATUS;
+    p->format.picture_aspect_ratio = (float) ratio;
+  }
+  else if (type != napi_undefined) CARRIER_ERROR(
+    "pictureAspectRatio value must be a number",
+    GRANDIOSE_INVALID_ARGS);
+
+  parseFrameRate(env, config, &p->format, c);
+  CARRIER_STATUS;
+
+  c->status = napi_get_named_property(env, config, "loop", &param);
+  CARRIER_STATUS;
+  c->status = napi_typeof(env, param, &type);
+  CARRIER_STATUS;
+  if (type == napi_boolean) {
+    c->status = napi_get_value_bool(env, param, &p->loop);
+    CARRIER_STATUS;
+  }
+  else if (type != napi_undefined) CARRIER_ERROR(
+    "loop value must be a Boolean",
+    GRANDIOSE_INVALID_ARGS);
+
+  int32_t readahead = (int32_t) p->readahead;
+  parseOptionalInt32(env, config, "readahead", &readahead, c);
+  CARRIER_STATUS;
+  if (readahead < 1) CARRIER_ERROR(
+    "readahead must be at least one frame",
+    GRANDIOSE_INVALID_ARGS);
+  p->readahead = (uint32_t) readahead;
+}
+
+// sender.playFile(path, options) plays a raw or Y4M video file, with any
+// WAV audio alongside it, from a native thread that keeps the frame rate
+// whatever the event loop is doing. Resolves when playout ends.
+napi_value playFile(napi_env env, napi_callback_info info) {
+  napi_valuetype type;
+  carrier* c = new carrier;
+
+  napi_value promise;
+  c->status = napi_create_promise(env, &c->_deferred, &promise);
+  REJECT_RETURN;
+
+  size_t argc = 2;
+  napi_value args[2];
+  napi_value thisValue;
+  c->status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  REJECT_RETURN;
+
+  sendInstance* s;
+  c->status = getSendInstance(env, thisValue, &s);
+  REJECT_RETURN;
+  if (s->playout != nullptr) REJECT_ERROR_RETURN(
+    "Sender is already playing a file or test signal.",
+    GRANDIOSE_INVALID_ARGS);
+
+  if (argc < 1) REJECT_ERROR_RETURN(
+    "File path must be provided.",
+    GRANDIOSE_INVALID_ARGS);
+  c->status = napi_typeof(env, args[0], &type);
+  REJECT_RETURN;
+  if (type != napi_string) REJECT_ERROR_RETURN(
+    "File path must be a string.",
+    GRANDIOSE_INVALID_ARGS);
+  size_t length;
+  c->status = napi_get_value_string_utf8(env, args[0], nullptr, 0, &length);
+  REJECT_RETURN;
+  std::string path(length, '\0');
+  c->status = napi_get_value_string_utf8(env, args[0], &path[0], length + 1, &length);
+  REJECT_RETURN;
+
+  napi_value options = nullptr;
+  if (argc >= 2) {
+    c->status = napi_typeof(env, args[1], &type);
+    REJECT_RETURN;
+    if (type == napi_object) options = args[1];
+    else if (type != napi_undefined) REJECT_ERROR_RETURN(
+      "Playout options must be an object if present.",
+      GRANDIOSE_INVALID_ARGS);
+  }
+
+  playoutInstance* p = new playoutInstance;
+  std::unique_ptr<playoutInstance> owner(p);
+  if (!mapFile(path, &p->video)) REJECT_ERROR_RETURN(
+    "Failed to open and map video file.",
+    GRANDIOSE_NOT_FOUND);
+
+  p->format.frame_rate_N = 0;
+  p->format.frame_rate_D = 0;
+  p->format.frame_format_type = NDIlib_frame_format_type_progressive;
+  p->format.picture_aspect_ratio = 0.0f;
+  p->format.timecode = NDIlib_send_timecode_synthesize;
+  p->format.timestamp = 0;
+  p->format.p_metadata = nullptr;
+  p->format.FourCC = (NDIlib_FourCC_video_type_e) 0;
+  p->format.xres = 0;
+  p->format.yres = 0;
+  p->y4m = (p->video.size >= 10) && (memcmp(p->video.data, "YUV4MPEG2 ", 10) == 0);
+  if (p->y4m && !parseY4M(p, &c->errorMsg)) REJECT_ERROR_RETURN(
+    c->errorMsg,
+    GRANDIOSE_INVALID_ARGS);
+
+  if (options != nullptr) {
+    parsePlayoutOptions(env, options, p, c);
+    REJECT_RETURN;
+  }
+  if (!p->y4m) {
+    size_t frameBytes = videoFrameBytes(p->format.FourCC, p->format.xres, p->format.yres,
+      p->format.line_stride_in_bytes);
+    if ((frameBytes == 0) || (p->format.xres <= 0) || (p->format.yres <= 0)) REJECT_ERROR_RETURN(
+      "fourCC, xres and yres must be given to play a raw file.",
+      GRANDIOSE_INVALID_ARGS);
+    if (p->format.line_stride_in_bytes < defaultLineStride(p->format.FourCC, p->format.xres)) REJECT_ERROR_RETURN(
+      "lineStrideBytes is too small for the width of the frame.",
+      GRANDIOSE_INVALID_ARGS);
+    p->firstFrame = 0;
+    p->frameSpacing = frameBytes;
+    p->frames = (uint32_t) (p->video.size / frameBytes);
+  }
+  if ((p->format.frame_rate_N <= 0) || (p->format.frame_rate_D <= 0)) REJECT_ERROR_RETURN(
+    "A positive frame rate must be given.",
+    GRANDIOSE_INVALID_ARGS);
+  if (p->frames == 0) REJECT_ERROR_RETURN(
+    "File does not hold a whole frame.",
+    GRANDIOSE_INVALID_ARGS);
+
+  p->outPoint = p->frames;
+  if (options != nullptr) {
+    parseFrameNumber(env, options, "inPoint", &p->inPoint, c);
+    REJECT_RETURN;
+    parseFrameNumber(env, options, "outPoint", &p->outPoint, c);
+    REJECT_RETURN;
+  }
+  if ((p->inPoint >= p->outPoint) || (p->outPoint > p->frames)) REJECT_ERROR_RETURN(
+    "inPoint and outPoint must select at least one frame of the file.",
+    GRANDIOSE_INVALID_ARGS);
+
+  // Audio from a WAV file of the same name, unless another is named
+  std::string audioPath = path.substr(0, path.find_last_of('.')) + ".wav";
+  bool audioRequired = false;
+  if (options != nullptr) {
+    napi_value param;
+    c->status = napi_get_named_property(env, options, "audio", &param);
+    REJECT_RETURN;
+    c->status = napi_typeof(env, param, &type);
+    REJECT_RETURN;
+    if (type == napi_string) {
+      c->status = napi_get_value_string_utf8(env, param, nullptr, 0, &length);
+      REJECT_RETURN;
+      audioPath.assign(length, '\0');
+      c->status = napi_get_value_string_utf8(env, param, &audioPath[0], length + 1, &length);
+      REJECT_RETURN;
+      audioRequired = true;
+    }
+    else if (type == napi_boolean) {
+      bool audio;
+      c->status = napi_get_value_bool(env, param, &audio);
+      REJECT_RETURN;
+      if (!audio) audioPath.clear();
+    }
+    else if (type != napi_undefined) REJECT_ERROR_RETURN(
+      "audio value must be a path or a Boolean",
+      GRANDIOSE_INVALID_ARGS);
+  }
+  if (!audioPath.empty() && (audioPath != path)) {
+    if (mapFile(audioPath, &p->audio)) {
+      if (!parseWAV(p, &c->errorMsg)) REJECT_ERROR_RETURN(
+        c->errorMsg,
+        GRANDIOSE_INVALID_ARGS);
+    }
+    else if (audioRequired) REJECT_ERROR_RETURN(
+      "Failed to open and map audio file.",
+      GRANDIOSE_NOT_FOUND);
+  }
+
+  prefetchFrames(p, p->inPoint, p->readahead);
+  startPlayout(env, s, owner, c);
+  REJECT_RETURN;
+  tidyCarrier(env, c);
+  return promise;
+}
+
+// sender.testSignal(options) renders and sends a test pattern, with a tone,
+// from a native thread. Resolves when the signal is stopped.
+napi_value playSignal(napi_env env, napi_callback_info info) {
+  napi_valuetype type;
+  napi_value param;
+  carrier* c = new carrier;
+
+  napi_value promise;
+  c->status = napi_create_promise(env, &c->_deferred, &promise);
+  REJECT_RETURN;
+
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value thisValue;
+  c->status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  REJECT_RETURN;
+
+  sendInstance* s;
+  c->status = getSendInstance(env, thisValue, &s);
+  REJECT_RETURN;
+  if (s->playout != nullptr) REJECT_ERROR_RETURN(
+    "Sender is already playing a file or test signal.",
+    GRANDIOSE_INVALID_ARGS);
+
+  napi_value options = nullptr;
+  if (argc >= 1) {
+    c->status = napi_typeof(env, args[0], &type);
+    REJECT_RETURN;
+    if (type == napi_object) options = args[0];
+    else if (type != napi_undefined) REJECT_ERROR_RETURN(
+      "Test signal options must be an object if present.",
+      GRANDIOSE_INVALID_ARGS);
+  }
+
+  playoutInstance* p = new playoutInstance;
+  std::unique_ptr<playoutInstance> owner(p);
+  testSignal* t = new testSignal;
+  p->signal = t;
+  t->xres = 1920;
+  t->yres = 1080;
+  t->sampleRate = 48000;
+  t->channels = 2;
+  p->format.frame_rate_N = 30000;
+  p->format.frame_rate_D = 1001;
+  bool audio = true;
+  if (options != nullptr) {
+    c->status = napi_get_named_property(env, options, "pattern", &param);
+    REJECT_RETURN;
+    c->status = napi_typeof(env, param, &type);
+    REJECT_RETURN;
+    if (type == napi_string) {
+      char name[32];
+      size_t length;
+      c->status = napi_get_value_string_utf8(env, param, name, sizeof(name), &length);
+      REJECT_RETURN;
+      if (!parsePattern(name, &t->pattern)) REJECT_ERROR_RETURN(
+        "pattern must be one of 'bars', 'ramp', 'zoneplate' or 'frameCounter'.",
+        GRANDIOSE_INVALID_ARGS);
+    }
+    else if (type != napi_undefined) REJECT_ERROR_RETURN(
+      "pattern value must be a string",
+      GRANDIOSE_INVALID_ARGS);
+
+    int32_t fourCC = (int32_t) t->fourCC;
+    parseOptionalInt32(env, options, "fourCC", &fourCC, c);
+    REJECT_RETURN;
+    t->fourCC = (NDIlib_FourCC_video_type_e) fourCC;
+    parseOptionalInt32(env, options, "xres", &t->xres, c);
+    REJECT_RETURN;
+    parseOptionalInt32(env, options, "yres", &t->yres, c);
+    REJECT_RETURN;
+    parseFrameRate(env, options, &p->format, c);
+    REJECT_RETURN;
+
+    c->status = napi_get_named_property(env, options, "audio", &param);
+    REJECT_RETURN;
+    c->status = napi_typeof(env, param, &type);
+    REJECT_RETURN;
+    if (type == napi_boolean) {
+      c->status = napi_get_value_bool(env, param, &audio);
+      REJECT_RETURN;
+    }
+    else if (type != napi_undefined) REJECT_ERROR_RETURN(
+      "audio value must be a Boolean",
+      GRANDIOSE_INVALID_ARGS);
+    parseOptionalInt32(env, options, "sampleRate", &t->sampleRate, c);
+    REJECT_RETURN;
+    parseOptionalInt32(env, options, "noChannels", &t->channels, c);
+    REJECT_RETURN;
+  }
+
+  if ((t->fourCC != NDIlib_FourCC_video_type_UYVY) && !validOutputFormat(t->fourCC)) REJECT_ERROR_RETURN(
+    "Test signals can be sent as UYVY, RGBA, RGBX, BGRA, BGRX, I420 or NV12.",
+    GRANDIOSE_INVALID_ARGS);
+  if ((t->xres <= 0) || (t->yres <= 0) || (t->xres % 2 != 0) || (t->yres % 2 != 0)) REJECT_ERROR_RETURN(
+    "xres and yres must be positive and even.",
+    GRANDIOSE_INVALID_ARGS);
+  if ((p->format.frame_rate_N <= 0) || (p->format.frame_rate_D <= 0)) REJECT_ERROR_RETURN(
+    "A positive frame rate must be given.",
+    GRANDIOSE_INVALID_ARGS);
+  if (audio && ((t->sampleRate <= 0) || (t->channels <= 0))) REJECT_ERROR_RETURN(
+    "sampleRate and noChannels must be positive.",
+    GRANDIOSE_INVALID_ARGS);
+  if (!audio) t->channels = 0;
+  if (!prepareSignal(t)) REJECT_ERROR_RETURN(
+    "Failed to allocate test signal frames.",
+    GRANDIOSE_ALLOCATION_FAILURE);
+
+  p->format.FourCC = t->fourCC;
+  p->format.xres = t->xres;
+  p->format.yres = t->yres;
+  p->format.line_stride_in_bytes = t->lineStride;
+  p->format.frame_format_type = NDIlib_frame_format_type_progressive;
+  p->format.picture_aspect_ratio = 0.0f;
+  p->format.timecode = NDIlib_send_timecode_synthesize;
+  p->format.timestamp = 0;
+  p->format.p_metadata = nullptr;
+  // The signal plays until stopped, counting frames from zero
+  p->outPoint = UINT32_MAX;
+  p->loop = true;
+  p->sampleRate = t->channels > 0 ? t->sampleRate : 0;
+  p->channels = t->channels;
+
+  startPlayout(env, s, owner, c);
+  REJECT_RETURN;
+  tidyCarrier(env, c);
+  return promise;
+}
+
+// sender.cue(frame) moves playout to the given frame at the next frame time
+napi_value playoutCue(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_valuetype type;
+
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  CHECK_STATUS;
+
+  sendInstance* s;
+  status = getSendInstance(env, thisValue, &s);
+  CHECK_STATUS;
+  playoutInstance* p = s->playout;
+  if (p == nullptr)
+    NAPI_THROW_ERROR("Sender is not playing a file or test signal.");
+
+  if (argc < 1)
+    NAPI_THROW_ERROR("Frame to cue must be a number.");
+  status = napi_typeof(env, args[0], &type);
+  CHECK_STATUS;
+  if (type != napi_number)
+    NAPI_THROW_ERROR("Frame to cue must be a number.");
+  int64_t frame;
+  status = napi_get_value_int64(env, args[0], &frame);
+  CHECK_STATUS;
+  if ((frame < p->inPoint) || (frame >= p->outPoint))
+    NAPI_THROW_ERROR("Frame to cue must be between inPoint and outPoint.");
+
+  prefetchFrames(p, (uint32_t) frame, p->readahead);
+  p->cue = frame;
+
+  napi_value undefined;
+  status = napi_get_undefined(env, &undefined);
+  CHECK_STATUS;
+  return undefined;
+}
+
+// sender.stopPlayout() resolves once the playout thread has finished
+napi_value playoutStop(napi_env env, napi_callback_info info) {
+  carrier* c = new carrier;
+  napi_value promise;
+  c->status = napi_create_promise(env, &c->_deferred, &promise);
+  REJECT_RETURN;
+
+  size_t argc = 0;
+  napi_value thisValue;
+  c->status = napi_get_cb_info(env, info, &argc, nullptr, &thisValue, nullptr);
+  REJECT_RETURN;
+
+  sendInstance* s;
+  c->status = getSendInstance(env, thisValue, &s);
+  REJECT_RETURN;
+  playoutInstance* p = s->playout;
+
+  if (p == nullptr) {
+    napi_value undefined;
+    napi_get_undefined(env, &undefined);
+    napi_resolve_deferred(env, c->_deferred, undefined);
+  } else if (p->stopped != nullptr) {
+    REJECT_ERROR_RETURN(
+      "Sender playout is already stopping.",
+      GRANDIOSE_INVALID_ARGS);
+  } else {
+    p->stopped = c->_deferred;
+    p->playing = false;
+  }
+
+  delete c;
+  return promise;
+}
+
+// sender.playout() describes the file or test signal being played, or
+// returns null
+napi_value playoutStats(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 0;
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, &argc, nullptr, &thisValue, nullptr);
+  CHECK_STATUS;
+
+  sendInstance* s;
+  status = getSendInstance(env, thisValue, &s);
+  CHECK_STATUS;
+  playoutInstance* p = s->playout;
+
+  napi_value result, param;
+  if (p == nullptr) {
+    status = napi_get_null(env, &result);
+    CHECK_STATUS;
+    return result;
+  }
+
+  status = napi_create_object(env, &result);
+  CHECK_STATUS;
+  status = napi_create_int32(env, p->format.FourCC, &param);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "fourCC", param);
+  CHECK_STATUS;
+  status = napi_create_int32(env, p->format.xres, &param);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "xres", param);
+  CHECK_STATUS;
+  status = napi_create_int32(env, p->format.yres, &param);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "yres", param);
+  CHECK_STATUS;
+  status = napi_create_int32(env, p->format.frame_rate_N, &param);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "frameRateN", param);
+  CHECK_STATUS;
+  status = napi_create_int32(env, p->format.frame_rate_D, &param);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "frameRateD", param);
+  CHECK_STATUS;
+  if (p->signal != nullptr) {
+    status = napi_create_string_utf8(env, patternName(p->signal->pattern), NAPI_AUTO_LENGTH, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, result, "pattern", param);
+    CHECK_STATUS;
+  } else {
+    status = napi_create_uint32(env, p->frames, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, result, "frames", param);
+    CHECK_STATUS;
+    status = napi_create_uint32(env, p->inPoint, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, result, "inPoint", param);
+    CHECK_STATUS;
+    status = napi_create_uint32(env, p->outPoint, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, result, "outPoint", param);
+    CHECK_STATUS;
+    status = napi_get_boolean(env, p->loop, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, result, "loop", param);
+    CHECK_STATUS;
+  }
+  status = napi_create_uint32(env, p->position, &param);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "position", param);
+  CHECK_STATUS;
+  status = napi_create_double(env, (double) p->sent, &param);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "sent", param);
+  CHECK_STATUS;
+  status = napi_create_double(env, (double) p->skipped, &param);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "skipped", param);
+  CHECK_STATUS;
+  if (p->sampleRate > 0) {
+    status = napi_create_int32(env, p->sampleRate, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, result, "sampleRate", param);
+    CHECK_STATUS;
+    status = napi_create_int32(env, p->channels, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, result, "noChannels", param);
+    CHECK_STATUS;
+  }
+
+  return result;
+}
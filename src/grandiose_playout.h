@@ -0,0 +1,105 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef GRANDIOSE_PLAYOUT_H
+#define GRANDIOSE_PLAYOUT_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#endif
+#include <Processing.NDI.Lib.h>
+#include "node_api.h"
+#include "grandiose_signal.h"
+
+napi_value playFile(napi_env env, napi_callback_info info);
+napi_value playSignal(napi_env env, napi_callback_info info);
+napi_value playoutCue(napi_env env, napi_callback_info info);
+napi_value playoutStop(napi_env env, napi_callback_info info);
+napi_value playoutStats(napi_env env, napi_callback_info info);
+
+// A file mapped read-only into memory
+struct mappedFile {
+  uint8_t* data = nullptr;
+  size_t size = 0;
+#ifdef _WIN32
+  HANDLE file = INVALID_HANDLE_VALUE;
+  HANDLE mapping = nullptr;
+#endif
+};
+
+bool mapFile(const std::string& path, mappedFile* f);
+void unmapFile(mappedFile* f);
+// Asks the OS to start reading part of a mapped file, without waiting
+void prefetchFile(const mappedFile* f, size_t offset, size_t length);
+
+struct sendInstance;
+
+// Playout of a raw or Y4M video file, and of any WAV audio alongside it,
+// started with sender.playFile(). Frames are sent straight from the mapped
+// file on the playout thread, paced by its own clock. A test signal started
+// with sender.testSignal() is rendered on the same thread in place of a file.
+struct playoutInstance {
+  mappedFile video;
+  mappedFile audio;
+  NDIlib_video_frame_v2_t format;
+  // Offset of the pixels of frame 0, and from one frame to the next
+  size_t firstFrame = 0;
+  size_t frameSpacing = 0;
+  bool y4m = false;
+  testSignal* signal = nullptr;
+  uint32_t frames = 0;
+  // Frames played, from inPoint up to but not including outPoint
+  uint32_t inPoint = 0;
+  uint32_t outPoint = 0;
+  bool loop = false;
+  uint32_t readahead = 8;
+  // Interleaved 16-bit or float WAV samples, starting with frame 0
+  int32_t sampleRate = 0;
+  int32_t channels = 0;
+  bool audioFloat = false;
+  size_t audioOffset = 0;
+  uint64_t audioSamples = 0;
+  // Playout thread, which stops at outPoint unless looping
+  NDIlib_send_instance_t send = nullptr;
+  std::thread thread;
+  std::atomic<bool> playing { false };
+  std::atomic<int64_t> cue { -1 };
+  std::atomic<uint32_t> position { 0 };
+  std::atomic<uint64_t> sent { 0 };
+  std::atomic<uint64_t> skipped { 0 };
+  std::string error;
+  napi_threadsafe_function endFn = nullptr;
+  napi_deferred ended = nullptr;
+  napi_deferred stopped = nullptr;
+  ~playoutInstance() {
+    unmapFile(&video);
+    unmapFile(&audio);
+    delete signal;
+  }
+};
+
+// Main thread. Asks the sender's playout, if any, to stop.
+void stopPlayout(sendInstance* s);
+
+#endif /* GRANDIOSE_PLAYOUT_H */
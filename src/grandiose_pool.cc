@@ -0,0 +1,363 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#include "grandiose_pool.h"
+#include "grandiose_util.h"
+
+// Completions are marshalled back to the thread of the environment that
+// queued the work through one threadsafe function per environment, referenced
+// only while work is outstanding so that an idle pool does not keep the event
+// loop alive. Lane threads hold a reference on the queue while they hold work
+// for it, as a worker's environment can be torn down while its work runs.
+struct completionQueue {
+  std::mutex m;
+  // Cleared, under m, when the environment is torn down
+  napi_threadsafe_function fn = nullptr;
+  // Work queued and not yet completed, on the environment's thread only
+  uint32_t outstanding = 0;
+  std::atomic<int32_t> refs { 1 };
+};
+
+struct ndiWork {
+  napi_env env;
+  completionQueue* queue;
+  carrier* c;
+  napi_async_execute_callback execute;
+  napi_async_complete_callback complete;
+  HR_TIME_POINT queued;
+};
+
+struct ndiLane {
+  const char* name;
+  uint32_t size;
+  std::mutex m;
+  std::condition_variable cv;
+  std::deque<ndiWork*> queue;
+  // Threads added for each open receiver, as its calls wait in NDI
+  uint32_t reserved = 0;
+  uint32_t threads = 0;
+  uint32_t idle = 0;
+  // Counters, all protected by m. Times are in microseconds.
+  uint64_t submitted = 0;
+  uint32_t maxQueued = 0;
+  long long totalWait = 0;
+  long long maxWait = 0;
+  long long totalRun = 0;
+  ndiLane(const char* n, uint32_t s) : name(n), size(s) {}
+  uint32_t limit() const { return size + reserved; }
+};
+
+// Never destroyed, as detached lane threads may still be waiting at exit
+static ndiLane* lanes[Grandiose_lane_max] = {
+  new ndiLane("video", 8),
+  new ndiLane("audio", 8),
+  new ndiLane("metadata", 4),
+  new ndiLane("data", 8),
+  new ndiLane("send", 4)
+};
+
+void releaseCompletion(completionQueue* q) {
+  if (q == nullptr) return;
+  if (--q->refs == 0) delete q;
+}
+
+void completionFinalize(napi_env env, void* data, void* hint) {
+  completionQueue* q = (completionQueue*) data;
+  {
+    std::lock_guard<std::mutex> lock(q->m);
+    q->fn = nullptr;
+  }
+  releaseCompletion(q);
+}
+
+void laneThread(ndiLane* lane) {
+  std::unique_lock<std::mutex> lock(lane->m);
+  while (true) {
+    lane->idle++;
+    lane->cv.wait(lock, [lane] {
+      return !lane->queue.empty() || (lane->threads > lane->limit());
+    });
+    lane->idle--;
+    if (lane->threads > lane->limit()) break;
+
+    ndiWork* w = lane->queue.front();
+    lane->queue.pop_front();
+    long long wait = microTime(w->queued);
+    lane->totalWait += wait;
+    if (wait > lane->maxWait) lane->maxWait = wait;
+    lock.unlock();
+
+    HR_TIME_POINT start = NOW;
+    w->execute(w->env, w->c);
+    long long run = microTime(start);
+    napi_status status = napi_closing;
+    {
+      std::lock_guard<std::mutex> queueLock(w->queue->m);
+      if (w->queue->fn != nullptr)
+        status = napi_call_threadsafe_function(w->queue->fn, w, napi_tsfn_blocking);
+    }
+    // The carrier is abandoned with its environment
+    if (status != napi_ok) {
+      releaseCompletion(w->queue);
+      delete w;
+    }
+
+    lock.lock();
+    lane->totalRun += run;
+  }
+  lane->threads--;
+}
+
+void completeCallJS(napi_env env, napi_value callback, void* context, void* data) {
+  ndiWork* w = (ndiWork*) data;
+  napi_status status;
+
+  completionQueue* q = w->queue;
+
+  if (env == nullptr) {
+    releaseCompletion(q);
+    delete w;
+    return;
+  }
+
+  w->complete(env, napi_ok, w->c);
+  delete w;
+
+  if ((--q->outstanding == 0) && (q->fn != nullptr)) {
+    status = napi_unref_threadsafe_function(env, q->fn);
+    FLOATING_STATUS;
+  }
+  releaseCompletion(q);
+}
+
+napi_status queueNDIWork(napi_env env, carrier* c, Grandiose_lane_e lane,
+    napi_async_execute_callback execute, napi_async_complete_callback complete) {
+  napi_status status;
+
+  grandioseEnv* g = getGrandioseEnv(env);
+  if (g == nullptr) return napi_generic_failure;
+  if (g->completion == nullptr) {
+    completionQueue* q = new completionQueue;
+    napi_value resource_name;
+    status = napi_create_string_utf8(env, "NDIWork", NAPI_AUTO_LENGTH, &resource_name);
+    if (status == napi_ok)
+      status = napi_create_threadsafe_function(env, nullptr, nullptr, resource_name,
+        0, 1, q, completionFinalize, nullptr, completeCallJS, &q->fn);
+    if (status != napi_ok) {
+      delete q;
+      return status;
+    }
+    // One reference for the environment and one for the threadsafe function
+    q->refs++;
+    g->completion = q;
+    status = napi_unref_threadsafe_function(env, q->fn);
+    PASS_STATUS;
+  }
+  completionQueue* q = g->completion;
+  if (q->fn == nullptr) return napi_closing;
+  if (q->outstanding++ == 0) {
+    status = napi_ref_threadsafe_function(env, q->fn);
+    PASS_STATUS;
+  }
+
+  ndiWork* w = new ndiWork;
+  w->env = env;
+  w->queue = q;
+  q->refs++;
+  w->c = c;
+  w->execute = execute;
+  w->complete = complete;
+  w->queued = NOW;
+
+  ndiLane* l = lanes[lane];
+  std::lock_guard<std::mutex> lock(l->m);
+  l->queue.push_back(w);
+  l->submitted++;
+  if (l->queue.size() > l->maxQueued) l->maxQueued = (uint32_t) l->queue.size();
+  if ((l->idle == 0) && (l->threads < l->limit())) {
+    l->threads++;
+    std::thread(laneThread, l).detach();
+  } else {
+    l->cv.notify_one();
+  }
+  return napi_ok;
+}
+
+// Called on any thread as a receiver is created or destroyed. Each receive
+// lane may run one more thread per open receiver, so that a receiver
+// waiting for frames does not hold up the calls of others.
+void reserveReceiveThreads(int32_t count) {
+  for ( int x = Grandiose_lane_video ; x <= Grandiose_lane_data ; x++ ) {
+    ndiLane* l = lanes[x];
+    std::lock_guard<std::mutex> lock(l->m);
+    l->reserved += count;
+    // Surplus threads exit once idle
+    if (count < 0) l->cv.notify_all();
+  }
+}
+
+// grandiose.configureWorkers({ size, video, audio, metadata, data, send })
+// sets the maximum number of threads for all lanes (size) or for one lane.
+// Threads are started on demand and surplus threads exit once idle.
+napi_value configureWorkers(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_valuetype type;
+
+  size_t argc = 1;
+  napi_value args[1];
+  status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+  CHECK_STATUS;
+  if (argc != 1)
+    NAPI_THROW_ERROR("Workers must be configured with an object.");
+  status = napi_typeof(env, args[0], &type);
+  CHECK_STATUS;
+  if (type != napi_object)
+    NAPI_THROW_ERROR("Workers must be configured with an object.");
+
+  uint32_t sizes[Grandiose_lane_max];
+  for ( int x = 0 ; x < Grandiose_lane_max ; x++ ) {
+    std::lock_guard<std::mutex> lock(lanes[x]->m);
+    sizes[x] = lanes[x]->size;
+  }
+
+  napi_value param;
+  uint32_t value;
+  status = napi_get_named_property(env, args[0], "size", &param);
+  CHECK_STATUS;
+  status = napi_typeof(env, param, &type);
+  CHECK_STATUS;
+  if (type == napi_number) {
+    status = napi_get_value_uint32(env, param, &value);
+    CHECK_STATUS;
+    for ( int x = 0 ; x < Grandiose_lane_max ; x++ ) sizes[x] = value;
+  }
+  else if (type != napi_undefined)
+    NAPI_THROW_ERROR("Worker pool size must be a number if present.");
+
+  for ( int x = 0 ; x < Grandiose_lane_max ; x++ ) {
+    status = napi_get_named_property(env, args[0], lanes[x]->name, &param);
+    CHECK_STATUS;
+    status = napi_typeof(env, param, &type);
+    CHECK_STATUS;
+    if (type == napi_number) {
+      status = napi_get_value_uint32(env, param, &sizes[x]);
+      CHECK_STATUS;
+    }
+    else if (type != napi_undefined)
+      NAPI_THROW_ERROR("Worker lane sizes must be numbers if present.");
+  }
+
+  for ( int x = 0 ; x < Grandiose_lane_max ; x++ ) {
+    if (sizes[x] == 0)
+      NAPI_THROW_ERROR("Worker lanes must have at least one thread.");
+  }
+
+  for ( int x = 0 ; x < Grandiose_lane_max ; x++ ) {
+    ndiLane* l = lanes[x];
+    std::lock_guard<std::mutex> lock(l->m);
+    l->size = sizes[x];
+    // Start threads for work already waiting and wake surplus ones to exit
+    while ((l->threads < l->limit()) && (l->queue.size() > l->idle)) {
+      l->threads++;
+      std::thread(laneThread, l).detach();
+    }
+    l->cv.notify_all();
+  }
+
+  return workerStats(env, info);
+}
+
+// grandiose.workerStats() reports per-lane thread use, queue depth and the
+// time work spends queued and running, in milliseconds.
+napi_value workerStats(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value result;
+  status = napi_create_object(env, &result);
+  CHECK_STATUS;
+
+  for ( int x = 0 ; x < Grandiose_lane_max ; x++ ) {
+    ndiLane* l = lanes[x];
+    std::unique_lock<std::mutex> lock(l->m);
+    uint32_t size = l->size;
+    uint32_t reserved = l->reserved;
+    uint32_t threads = l->threads;
+    uint32_t busy = l->threads - l->idle;
+    uint32_t queued = (uint32_t) l->queue.size();
+    uint32_t maxQueued = l->maxQueued;
+    double submitted = (double) l->submitted;
+    double totalWait = l->totalWait / 1000.0;
+    double maxWait = l->maxWait / 1000.0;
+    double totalRun = l->totalRun / 1000.0;
+    lock.unlock();
+
+    napi_value lane, param;
+    status = napi_create_object(env, &lane);
+    CHECK_STATUS;
+
+    status = napi_create_uint32(env, size, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, lane, "size", param);
+    CHECK_STATUS;
+    status = napi_create_uint32(env, reserved, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, lane, "reserved", param);
+    CHECK_STATUS;
+    status = napi_create_uint32(env, threads, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, lane, "threads", param);
+    CHECK_STATUS;
+    status = napi_create_uint32(env, busy, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, lane, "busy", param);
+    CHECK_STATUS;
+    status = napi_create_uint32(env, queued, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, lane, "queued", param);
+    CHECK_STATUS;
+    status = napi_create_uint32(env, maxQueued, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, lane, "maxQueued", param);
+    CHECK_STATUS;
+    status = napi_create_double(env, submitted, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, lane, "submitted", param);
+    CHECK_STATUS;
+    status = napi_create_double(env, totalWait, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, lane, "totalWait", param);
+    CHECK_STATUS;
+    status = napi_create_double(env, maxWait, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, lane, "maxWait", param);
+    CHECK_STATUS;
+    status = napi_create_double(env, totalRun, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, lane, "totalRun", param);
+    CHECK_STATUS;
+
+    status = napi_set_named_property(env, result, l->name, lane);
+    CHECK_STATUS;
+  }
+
+  return result;
+}
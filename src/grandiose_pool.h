@@ -0,0 +1,50 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef GRANDIOSE_POOL_H
+#define GRANDIOSE_POOL_H
+
+#include "node_api.h"
+#include "grandiose_util.h"
+
+// Blocking NDI calls run on the addon's own worker threads rather than the
+// libuv pool, so that waiting receivers cannot starve fs, dns and crypto.
+// Each type of work has its own lane with its own set of threads.
+typedef enum Grandiose_lane_e {
+  Grandiose_lane_video = 0,
+  Grandiose_lane_audio = 1,
+  Grandiose_lane_metadata = 2,
+  Grandiose_lane_data = 3,
+  Grandiose_lane_send = 4,
+  Grandiose_lane_max = 5
+} Grandiose_lane_e;
+
+// Equivalent of napi_create_async_work plus napi_queue_async_work. The execute
+// callback runs on a lane thread and complete runs on the thread of the
+// environment, main or worker, that queued the work. The carrier's _request
+// is left unset so tidyCarrier has no async work to delete.
+napi_status queueNDIWork(napi_env env, carrier* c, Grandiose_lane_e lane,
+  napi_async_execute_callback execute, napi_async_complete_callback complete);
+
+// Adds or removes threads for count receivers on the receive lanes
+void reserveReceiveThreads(int32_t count);
+
+// Drops the environment's reference on its completion queue at teardown
+void releaseCompletion(completionQueue* q);
+
+napi_value configureWorkers(napi_env env, napi_callback_info info);
+napi_value workerStats(napi_env env, napi_callback_info info);
+
+#endif /* GRANDIOSE_POOL_H */
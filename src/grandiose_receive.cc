@@ -13,7 +13,11 @@
   limitations under the License.
 */
 
+#include <algorithm>
 #include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <Processing.NDI.Lib.h>
 #include <inttypes.h>
 
@@ -28,9 +32,222 @@
 #include "grandiose_receive.h"
 #include "grandiose_util.h"
 #include "grandiose_find.h"
+#include "grandiose_pool.h"
+#include "grandiose_framesync.h"
+
+void retainReceive(receiveInstance* r) {
+  r->refs++;
+}
+
+void releaseReceive(receiveInstance* r) {
+  if (--r->refs > 0) return;
+  stopSampling(r);
+  stopDemux(r);
+  NDIlib_recv_destroy(r->recv);
+  delete r;
+}
 
 void finalizeReceive(napi_env env, void* data, void* hint) {
-  NDIlib_recv_destroy((NDIlib_recv_instance_t) data);
+  releaseReceive((receiveInstance*) data);
+}
+
+receiveInstance::receiveInstance() {
+  reserveReceiveThreads(1);
+}
+
+receiveInstance::~receiveInstance() {
+  reserveReceiveThreads(-1);
+  for ( auto b : outputFree ) {
+    freeFrameMemory(b->data, b->size, b->huge);
+    delete b;
+  }
+  for ( int x = 0 ; x < Grandiose_demux_max ; x++ )
+    delete demux[x].frames;
+}
+
+// Called on any thread. Reuses a free output buffer of the right size, or
+// allocates one. Returns nullptr if memory cannot be allocated.
+outputBuffer* takeOutputBuffer(receiveInstance* r, size_t size) {
+  {
+    std::lock_guard<std::mutex> lock(r->outputLock);
+    while (!r->outputFree.empty()) {
+      outputBuffer* b = r->outputFree.back();
+      r->outputFree.pop_back();
+      if (b->size == size) return b;
+      // The output format or resolution has changed
+      freeFrameMemory(b->data, b->size, b->huge);
+      delete b;
+    }
+  }
+  outputBuffer* b = new outputBuffer;
+  b->instance = r;
+  b->size = size;
+  b->data = (uint8_t*) allocateFrameMemory(size, false, &b->huge);
+  if (b->data == nullptr) {
+    delete b;
+    return nullptr;
+  }
+  return b;
+}
+
+// Called on any thread. The pool size, or a few, buffers are kept for reuse.
+void returnOutputBuffer(outputBuffer* b) {
+  if (b == nullptr) return;
+  receiveInstance* r = b->instance;
+  uint32_t keep = (r->poolSize > 0) ? r->poolSize.load() : 4;
+  {
+    std::lock_guard<std::mutex> lock(r->outputLock);
+    if (r->outputFree.size() < keep) {
+      r->outputFree.push_back(b);
+      return;
+    }
+  }
+  freeFrameMemory(b->data, b->size, b->huge);
+  delete b;
+}
+
+// A captured frame passed to JavaScript without copying its data, or in an
+// output buffer. It is owned jointly by the external buffer wrapping the
+// memory and by the frame object carrying release(), and returned to NDI or
+// to the receiver's free buffers at the first of release() or both of those
+// being garbage collected.
+struct receiveFrameHold {
+  receiveInstance* instance;
+  NDIlib_frame_type_e frameType;
+  NDIlib_video_frame_v2_t videoFrame;
+  NDIlib_audio_frame_v2_t audioFrame;
+  outputBuffer* output = nullptr;
+  napi_ref dataRef = nullptr;
+  bool released = false;
+  int32_t refs = 2;
+};
+
+void returnFrameHold(receiveFrameHold* h) {
+  if (h->released) return;
+  h->released = true;
+  if (h->output != nullptr) {
+    returnOutputBuffer(h->output);
+    h->output = nullptr;
+    return;
+  }
+  switch (h->frameType) {
+    case NDIlib_frame_type_video:
+      NDIlib_recv_free_video_v2(h->instance->recv, &h->videoFrame);
+      break;
+    case NDIlib_frame_type_audio:
+      NDIlib_recv_free_audio_v2(h->instance->recv, &h->audioFrame);
+      break;
+    default:
+      break;
+  }
+}
+
+void unrefFrameHold(napi_env env, receiveFrameHold* h) {
+  if (--h->refs > 0) return;
+  returnFrameHold(h);
+  if (h->dataRef != nullptr) {
+    napi_delete_reference(env, h->dataRef);
+  }
+  releaseReceive(h->instance);
+  delete h;
+}
+
+void finalizeFrameData(napi_env env, void* data, void* hint) {
+  unrefFrameHold(env, (receiveFrameHold*) hint);
+}
+
+void finalizeFrameObject(napi_env env, void* data, void* hint) {
+  unrefFrameHold(env, (receiveFrameHold*) data);
+}
+
+// Explicitly return a zero-copy frame to NDI, or an output buffer for reuse.
+// The data buffer is detached so that JavaScript cannot read memory that is
+// free to be reused.
+napi_value frameRelease(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &thisValue, nullptr);
+  CHECK_STATUS;
+
+  void* holdData;
+  status = napi_unwrap(env, thisValue, &holdData);
+  CHECK_STATUS;
+  receiveFrameHold* h = (receiveFrameHold*) holdData;
+
+  if (!h->released) {
+    napi_value dataValue = nullptr;
+    if (h->dataRef != nullptr) {
+      status = napi_get_reference_value(env, h->dataRef, &dataValue);
+      CHECK_STATUS;
+    }
+    if (dataValue != nullptr) {
+      napi_typedarray_type arrayType;
+      size_t length, offset;
+      void* arrayData;
+      napi_value arrayBuffer;
+      status = napi_get_typedarray_info(env, dataValue, &arrayType, &length,
+        &arrayData, &arrayBuffer, &offset);
+      CHECK_STATUS;
+      status = napi_detach_arraybuffer(env, arrayBuffer);
+      CHECK_STATUS;
+    }
+    returnFrameHold(h);
+  }
+
+  napi_value undefined;
+  status = napi_get_undefined(env, &undefined);
+  CHECK_STATUS;
+  return undefined;
+}
+
+// Main thread. Sets the data of a frame object to an external buffer over
+// memory owned by the hold, with a release() method to return it early.
+napi_status wrapFrameHold(napi_env env, napi_value frame, receiveFrameHold* h,
+    void* data, size_t size, napi_value* dataValue) {
+  napi_status status;
+  napi_value param;
+  status = napi_create_external_buffer(env, size, data, finalizeFrameData, h, dataValue);
+  if (status != napi_ok) {
+    h->refs = 1;
+    unrefFrameHold(env, h);
+  }
+  PASS_STATUS;
+  status = napi_set_named_property(env, frame, "data", *dataValue);
+  PASS_STATUS;
+  status = napi_create_reference(env, *dataValue, 0, &h->dataRef);
+  PASS_STATUS;
+  status = napi_wrap(env, frame, h, finalizeFrameObject, nullptr, nullptr);
+  PASS_STATUS;
+
+  status = napi_create_function(env, "release", NAPI_AUTO_LENGTH, frameRelease,
+    nullptr, &param);
+  PASS_STATUS;
+  return napi_set_named_property(env, frame, "release", param);
+}
+
+// Main thread. Reads the into option of video(), audio() or data(), a Buffer
+// that the next frame is copied or converted into instead of new memory.
+void readIntoOption(napi_env env, napi_value config, dataCarrier* c) {
+  napi_valuetype type;
+  napi_value param;
+  c->status = napi_get_named_property(env, config, "into", &param);
+  CARRIER_STATUS;
+  c->status = napi_typeof(env, param, &type);
+  CARRIER_STATUS;
+  if (type == napi_undefined) return;
+  bool isBuffer = false;
+  c->status = napi_is_buffer(env, param, &isBuffer);
+  CARRIER_STATUS;
+  if (!isBuffer) CARRIER_ERROR("Receive into property must be a Buffer if present.",
+    GRANDIOSE_INVALID_ARGS);
+  void* intoData;
+  c->status = napi_get_buffer_info(env, param, &intoData, &c->intoSize);
+  CARRIER_STATUS;
+  c->intoData = (uint8_t*) intoData;
+  // Held until the frame is resolved, so the memory outlives the capture
+  c->status = napi_create_reference(env, param, 1, &c->passthru);
+  CARRIER_STATUS;
 }
 
 void receiveExecute(napi_env env, void* data) {
@@ -65,8 +282,24 @@ void receiveComplete(napi_env env, napi_status asyncStatus, void* data) {
   c->status = napi_create_object(env, &result);
   REJECT_STATUS;
 
+  receiveInstance* instance = c->instance;
+  c->instance = nullptr;
+  if (instance == nullptr) {
+    instance = new receiveInstance;
+    instance->recv = c->recv;
+    instance->zeroCopy = c->zeroCopy;
+    instance->outputFormat = c->outputFormat;
+    instance->colorMatrix = c->colorMatrix;
+    instance->fullRange = c->fullRange;
+    for ( int x = 0 ; x < Grandiose_demux_max ; x++ )
+      instance->demux[x].frames = new frameRing<dataCarrier>(c->queueDepth);
+    instance->delivery = c->delivery;
+    instance->deliveryEvery = c->deliveryEvery;
+    instance->deliveryMaxFps = c->deliveryMaxFps;
+  }
+
   napi_value embedded;
-  c->status = napi_create_external(env, c->recv, finalizeReceive, nullptr, &embedded);
+  c->status = napi_create_external(env, instance, finalizeReceive, nullptr, &embedded);
   REJECT_STATUS;
   c->status = napi_set_named_property(env, result, "embedded", embedded);
   REJECT_STATUS;
@@ -99,19 +332,82 @@ void receiveComplete(napi_env env, napi_status asyncStatus, void* data) {
   c->status = napi_set_named_property(env, result, "data", dataFn);
   REJECT_STATUS;
 
+  napi_value transferFn;
+  c->status = napi_create_function(env, "transfer", NAPI_AUTO_LENGTH, receiveTransfer,
+    nullptr, &transferFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "transfer", transferFn);
+  REJECT_STATUS;
+
+  napi_value frameSyncFn;
+  c->status = napi_create_function(env, "frameSync", NAPI_AUTO_LENGTH, receiveFrameSync,
+    nullptr, &frameSyncFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "frameSync", frameSyncFn);
+  REJECT_STATUS;
+
+  napi_value statsFn;
+  c->status = napi_create_function(env, "stats", NAPI_AUTO_LENGTH, receiveStatsNow,
+    nullptr, &statsFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "stats", statsFn);
+  REJECT_STATUS;
+
+  napi_value sampleStatsFn;
+  c->status = napi_create_function(env, "sampleStats", NAPI_AUTO_LENGTH, receiveSampleStats,
+    nullptr, &sampleStatsFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "sampleStats", sampleStatsFn);
+  REJECT_STATUS;
+
+  napi_value statsHistoryFn;
+  c->status = napi_create_function(env, "statsHistory", NAPI_AUTO_LENGTH, receiveStatsHistory,
+    nullptr, &statsHistoryFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "statsHistory", statsHistoryFn);
+  REJECT_STATUS;
+
+  napi_value usePoolFn;
+  c->status = napi_create_function(env, "usePool", NAPI_AUTO_LENGTH, receiveUsePool,
+    nullptr, &usePoolFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "usePool", usePoolFn);
+  REJECT_STATUS;
+
+  napi_value queuesFn;
+  c->status = napi_create_function(env, "queues", NAPI_AUTO_LENGTH, receiveQueues,
+    nullptr, &queuesFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "queues", queuesFn);
+  REJECT_STATUS;
+
+  napi_value startFn;
+  c->status = napi_create_function(env, "start", NAPI_AUTO_LENGTH, captureStart,
+    nullptr, &startFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "start", startFn);
+  REJECT_STATUS;
+
+  napi_value stopFn;
+  c->status = napi_create_function(env, "stop", NAPI_AUTO_LENGTH, captureStop,
+    nullptr, &stopFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "stop", stopFn);
+  REJECT_STATUS;
+
   napi_value source, name, uri;
   c->status = napi_create_string_utf8(env, c->source->p_ndi_name, NAPI_AUTO_LENGTH, &name);
   REJECT_STATUS;
-  if (c->source->p_url_address != NULL) {
-    c->status = napi_create_string_utf8(env, c->source->p_url_address, NAPI_AUTO_LENGTH, &uri);
-    REJECT_STATUS;
-  }
   c->status = napi_create_object(env, &source);
   REJECT_STATUS;
   c->status = napi_set_named_property(env, source, "name", name);
   REJECT_STATUS;
-  c->status = napi_set_named_property(env, source, "urlAddress", uri);
-  REJECT_STATUS;
+  if (c->source->p_url_address != NULL) {
+    c->status = napi_create_string_utf8(env, c->source->p_url_address, NAPI_AUTO_LENGTH, &uri);
+    REJECT_STATUS;
+    c->status = napi_set_named_property(env, source, "urlAddress", uri);
+    REJECT_STATUS;
+  }
   c->status = napi_set_named_property(env, result, "source", source);
   REJECT_STATUS;
 
@@ -133,6 +429,28 @@ void receiveComplete(napi_env env, napi_status asyncStatus, void* data) {
   c->status = napi_set_named_property(env, result, "allowVideoFields", allowVideoFields);
   REJECT_STATUS;
 
+  napi_value zeroCopy;
+  c->status = napi_get_boolean(env, c->zeroCopy, &zeroCopy);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "zeroCopy", zeroCopy);
+  REJECT_STATUS;
+
+  if (c->outputFormat != 0) {
+    napi_value param;
+    c->status = napi_create_int32(env, (int32_t) c->outputFormat, &param);
+    REJECT_STATUS;
+    c->status = napi_set_named_property(env, result, "outputFormat", param);
+    REJECT_STATUS;
+    c->status = napi_create_int32(env, (int32_t) c->colorMatrix, &param);
+    REJECT_STATUS;
+    c->status = napi_set_named_property(env, result, "colorMatrix", param);
+    REJECT_STATUS;
+    c->status = napi_get_boolean(env, c->fullRange, &param);
+    REJECT_STATUS;
+    c->status = napi_set_named_property(env, result, "fullRange", param);
+    REJECT_STATUS;
+  }
+
   if (c->name != nullptr) {
     c->status = napi_create_string_utf8(env, c->name, NAPI_AUTO_LENGTH, &name);
     REJECT_STATUS;
@@ -147,6 +465,29 @@ void receiveComplete(napi_env env, napi_status asyncStatus, void* data) {
   tidyCarrier(env, c);
 }
 
+// Reads a delivery policy of 'all', 'latest', 'every:N' with N at least 1,
+// or 'maxFps:X' with X above zero
+bool parseDelivery(const char* delivery, receiveCarrier* c) {
+  char end;
+  int32_t every;
+  if (strcmp(delivery, "all") == 0)
+    c->delivery = Grandiose_delivery_all;
+  else if (strcmp(delivery, "latest") == 0)
+    c->delivery = Grandiose_delivery_latest;
+  else if (sscanf(delivery, "every:%d%c", &every, &end) == 1) {
+    if (every < 1) return false;
+    c->deliveryEvery = (uint32_t) every;
+    c->delivery = Grandiose_delivery_every;
+  }
+  else if (sscanf(delivery, "maxFps:%lf%c", &c->deliveryMaxFps, &end) == 1) {
+    if (!(c->deliveryMaxFps > 0.0)) return false;
+    c->delivery = Grandiose_delivery_max_fps;
+  }
+  else
+    return false;
+  return true;
+}
+
 napi_value receive(napi_env env, napi_callback_info info) {
   napi_valuetype type;
   receiveCarrier* c = new receiveCarrier;
@@ -174,7 +515,7 @@ napi_value receive(napi_env env, napi_callback_info info) {
     GRANDIOSE_INVALID_ARGS);
 
   napi_value config = args[0];
-  napi_value source, colorFormat, bandwidth, allowVideoFields, name;
+  napi_value source, colorFormat, bandwidth, allowVideoFields, zeroCopy, name;
   // source is an object, not an array, with name and urlAddress
   // convert to a native source
   c->status = napi_get_named_property(env, config, "source", &source);
@@ -256,6 +597,99 @@ napi_value receive(napi_env env, napi_callback_info info) {
     REJECT_RETURN;
   }
 
+  c->status = napi_get_named_property(env, config, "zeroCopy", &zeroCopy);
+  REJECT_RETURN;
+  c->status = napi_typeof(env, zeroCopy, &type);
+  REJECT_RETURN;
+  if (type != napi_undefined) {
+    if (type != napi_boolean) REJECT_ERROR_RETURN(
+      "Zero copy property must be a Boolean.",
+      GRANDIOSE_INVALID_ARGS);
+    c->status = napi_get_value_bool(env, zeroCopy, &c->zeroCopy);
+    REJECT_RETURN;
+  }
+
+  napi_value param;
+  c->status = napi_get_named_property(env, config, "outputFormat", &param);
+  REJECT_RETURN;
+  c->status = napi_typeof(env, param, &type);
+  REJECT_RETURN;
+  if (type != napi_undefined) {
+    if (type != napi_number) REJECT_ERROR_RETURN(
+      "Output format property must be a number.",
+      GRANDIOSE_INVALID_ARGS);
+    int32_t enumValue;
+    c->status = napi_get_value_int32(env, param, &enumValue);
+    REJECT_RETURN;
+
+    c->outputFormat = (NDIlib_FourCC_video_type_e) enumValue;
+    if (!validOutputFormat(c->outputFormat)) REJECT_ERROR_RETURN(
+      "Output format must be one of RGBA, RGBX, BGRA, BGRX, I420 or NV12.",
+      GRANDIOSE_INVALID_ARGS);
+  }
+
+  c->status = napi_get_named_property(env, config, "colorMatrix", &param);
+  REJECT_RETURN;
+  c->status = napi_typeof(env, param, &type);
+  REJECT_RETURN;
+  if (type != napi_undefined) {
+    if (type != napi_number) REJECT_ERROR_RETURN(
+      "Color matrix property must be a number.",
+      GRANDIOSE_INVALID_ARGS);
+    int32_t enumValue;
+    c->status = napi_get_value_int32(env, param, &enumValue);
+    REJECT_RETURN;
+
+    c->colorMatrix = (Grandiose_color_matrix_e) enumValue;
+    if (!validColorMatrix(c->colorMatrix)) REJECT_ERROR_RETURN(
+      "Invalid color matrix value.",
+      GRANDIOSE_INVALID_ARGS);
+  }
+
+  c->status = napi_get_named_property(env, config, "fullRange", &param);
+  REJECT_RETURN;
+  c->status = napi_typeof(env, param, &type);
+  REJECT_RETURN;
+  if (type != napi_undefined) {
+    if (type != napi_boolean) REJECT_ERROR_RETURN(
+      "Full range property must be a Boolean.",
+      GRANDIOSE_INVALID_ARGS);
+    c->status = napi_get_value_bool(env, param, &c->fullRange);
+    REJECT_RETURN;
+  }
+
+  c->status = napi_get_named_property(env, config, "queueDepth", &param);
+  REJECT_RETURN;
+  c->status = napi_typeof(env, param, &type);
+  REJECT_RETURN;
+  if (type != napi_undefined) {
+    if (type != napi_number) REJECT_ERROR_RETURN(
+      "Queue depth property must be a number.",
+      GRANDIOSE_INVALID_ARGS);
+    c->status = napi_get_value_uint32(env, param, &c->queueDepth);
+    REJECT_RETURN;
+    if (c->queueDepth == 0) REJECT_ERROR_RETURN(
+      "Queue depth must be at least 1.",
+      GRANDIOSE_INVALID_ARGS);
+  }
+
+  c->status = napi_get_named_property(env, config, "delivery", &param);
+  REJECT_RETURN;
+  c->status = napi_typeof(env, param, &type);
+  REJECT_RETURN;
+  if (type != napi_undefined) {
+    if (type != napi_string) REJECT_ERROR_RETURN(
+      "Delivery must be one of 'all', 'latest', 'every:N' or 'maxFps:X'.",
+      GRANDIOSE_INVALID_ARGS);
+    char delivery[32];
+    size_t deliveryl;
+    c->status = napi_get_value_string_utf8(env, param, delivery, sizeof(delivery), &deliveryl);
+    REJECT_RETURN;
+    if (!parseDelivery(delivery, c)) REJECT_ERROR_RETURN(
+      "Delivery must be one of 'all', 'latest', 'every:N' or 'maxFps:X'.",
+      GRANDIOSE_INVALID_ARGS);
+  }
+
   c->status = napi_get_named_property(env, config, "name", &name);
   REJECT_RETURN;
   c->status = napi_typeof(env, name, &type);
@@ -283,136 +717,290 @@ napi_value receive(napi_env env, napi_callback_info info) {
   return promise;
 }
 
-void videoReceiveExecute(napi_env env, void* data) {
-  dataCarrier* c = (dataCarrier*) data;
+// Return a frame's memory to the receiver or frame synchronizer it came from
+void freeVideoFrame(dataCarrier* c) {
+  if (c->sync != nullptr)
+    NDIlib_framesync_free_video(c->sync, &c->videoFrame);
+  else
+    NDIlib_recv_free_video_v2(c->recv, &c->videoFrame);
+}
 
-  switch (NDIlib_recv_capture_v2(c->recv, &c->videoFrame, nullptr, nullptr, c->wait))
-  {
-    case NDIlib_frame_type_none:
-      c->status = GRANDIOSE_NOT_FOUND;
-      c->errorMsg = "No video data received in the requested time interval.";
-      break;
+void freeAudioFrame(dataCarrier* c) {
+  if (c->sync != nullptr)
+    NDIlib_framesync_free_audio(c->sync, &c->audioFrame);
+  else
+    NDIlib_recv_free_audio_v2(c->recv, &c->audioFrame);
+}
 
-    // Video data
-    case NDIlib_frame_type_video:
-      break;
+// Samples of an audio frame in the requested format, and their size in bytes
+char* audioFrameData(dataCarrier* c, size_t* size) {
+  int32_t factor = (c->audioFormat == Grandiose_audio_format_int_16_interleaved) ? 2 : 1;
+  *size = (c->audioFrame.channel_stride_in_bytes / factor) * c->audioFrame.no_channels;
+  switch (c->audioFormat) {
+    case Grandiose_audio_format_int_16_interleaved:
+      return (char*) c->audioFrame16s.p_data;
+    case Grandiose_audio_format_float_32_interleaved:
+      return (char*) c->audioFrame32fIlvd.p_data;
+    case Grandiose_audio_format_float_32_separate:
+    default:
+      return (char*) c->audioFrame.p_data;
+  }
+}
 
+// Convert a captured audio frame to the requested format, off the main thread,
+// copying it into the into Buffer if one was passed
+void convertAudioFrame(dataCarrier* c) {
+  switch (c->audioFormat) {
+    case Grandiose_audio_format_int_16_interleaved:
+      c->audioFrame16s.reference_level = c->referenceLevel;
+      c->audioFrame16s.p_data = new short[c->audioFrame.no_samples * c->audioFrame.no_channels];
+      NDIlib_util_audio_to_interleaved_16s_v2(&c->audioFrame, &c->audioFrame16s);
+      break;
+    case Grandiose_audio_format_float_32_interleaved:
+      c->audioFrame32fIlvd.p_data = new float[c->audioFrame.no_samples * c->audioFrame.no_channels];
+      NDIlib_util_audio_to_interleaved_32f_v2(&c->audioFrame, &c->audioFrame32fIlvd);
+      break;
+    case Grandiose_audio_format_float_32_separate:
     default:
-      c->status = GRANDIOSE_NOT_VIDEO;
-      c->errorMsg = "Non-video data received on video capture.";
       break;
   }
+  if (c->intoData == nullptr) return;
+
+  size_t size;
+  char* samples = audioFrameData(c, &size);
+  if (size > c->intoSize) {
+    freeAudioFrame(c);
+    c->status = GRANDIOSE_INVALID_ARGS;
+    c->errorMsg = "Buffer to receive into is too small for the audio frame.";
+    return;
+  }
+  memcpy(c->intoData, samples, size);
+  c->intoUsed = size;
 }
 
-void videoReceiveComplete(napi_env env, napi_status asyncStatus, void* data) {
+// Convert a captured video frame to the receiver's output format, off the
+// main thread. Frames in other formats, such as RGB from a receiver with a
+// colorFormat of BGRX_BGRA, are passed on unchanged. The result goes into the
+// into Buffer if one was passed, otherwise into an output buffer. Unconverted
+// frames are also copied into an output buffer when the receiver has a pool.
+void convertVideoFrame(dataCarrier* c) {
+  receiveInstance* r = c->instance;
+  bool convert = (r->outputFormat != 0) && canConvertFromYUV(c->videoFrame.FourCC);
+
+  size_t size;
+  if (convert) {
+    size = outputFrameBytes(r->outputFormat, c->videoFrame.xres, c->videoFrame.yres,
+      &c->outputStride);
+    c->outputFourCC = r->outputFormat;
+  } else {
+    if (c->videoFrame.line_stride_in_bytes == 0) return;
+    // Bottom to top frames are always copied a line at a time, top to bottom,
+    // so that the zero-copy and default paths only see positive strides
+    if ((c->intoData == nullptr) && ((r->poolSize == 0) || c->zeroCopy) &&
+        (c->videoFrame.line_stride_in_bytes > 0)) return;
+    c->outputStride = abs(c->videoFrame.line_stride_in_bytes);
+    c->outputFourCC = c->videoFrame.FourCC;
+    size = (size_t) c->outputStride * c->videoFrame.yres;
+  }
+
+  uint8_t* target;
+  if (c->intoData != nullptr) {
+    if (size > c->intoSize) {
+      freeVideoFrame(c);
+      c->status = GRANDIOSE_INVALID_ARGS;
+      c->errorMsg = "Buffer to receive into is too small for the video frame.";
+      return;
+    }
+    target = c->intoData;
+    c->intoUsed = size;
+  } else {
+    c->output = takeOutputBuffer(r, size);
+    if (c->output == nullptr) {
+      freeVideoFrame(c);
+      c->status = GRANDIOSE_ALLOCATION_FAILURE;
+      c->errorMsg = "Failed to allocate memory for received video frame.";
+      return;
+    }
+    target = c->output->data;
+  }
+
+  if (convert)
+    convertFromYUV(&c->videoFrame, target, r->outputFormat, c->outputStride,
+      r->colorMatrix, r->fullRange);
+  else if (c->videoFrame.line_stride_in_bytes < 0)
+    for ( int32_t y = 0 ; y < c->videoFrame.yres ; y++ )
+      memcpy(target + (size_t) y * c->outputStride,
+        c->videoFrame.p_data + (ptrdiff_t) y * c->videoFrame.line_stride_in_bytes,
+        c->outputStride);
+  else
+    memcpy(target, c->videoFrame.p_data, size);
+}
+
+void videoReceiveExecute(napi_env env, void* data) {
   dataCarrier* c = (dataCarrier*) data;
 
-  if (asyncStatus != napi_ok) {
-    c->status = asyncStatus;
-    c->errorMsg = "Async video frame receive failed to complete.";
+  dataCarrier* f = takeDemuxed(c->instance, Grandiose_demux_video, c->wait);
+  if (f == nullptr) {
+    c->status = GRANDIOSE_NOT_FOUND;
+    c->errorMsg = "No video data received in the requested time interval.";
+    return;
   }
-  REJECT_STATUS;
+  c->videoFrame = f->videoFrame;
+  delete f;
+  convertVideoFrame(c);
+}
 
+napi_status makeVideoFrame(napi_env env, dataCarrier* c, napi_value* frame) {
+  napi_status status;
   napi_value result;
-  c->status = napi_create_object(env, &result);
-  REJECT_STATUS;
+  status = napi_create_object(env, &result);
+  PASS_STATUS;
 
   int32_t ptps, ptpn;
   ptps = (int32_t) (c->videoFrame.timestamp / 10000000);
   ptpn = (c->videoFrame.timestamp % 10000000) * 100;
 
   napi_value param;
-  c->status = napi_create_string_utf8(env, "video", NAPI_AUTO_LENGTH, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "type", param);
-  REJECT_STATUS;
-
-  c->status = napi_create_int32(env, c->videoFrame.xres, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "xres", param);
-  REJECT_STATUS;
+  status = napi_create_string_utf8(env, "video", NAPI_AUTO_LENGTH, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "type", param);
+  PASS_STATUS;
+
+  status = napi_create_int32(env, c->videoFrame.xres, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "xres", param);
+  PASS_STATUS;
+
+  status = napi_create_int32(env, c->videoFrame.yres, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "yres", param);
+  PASS_STATUS;
+
+  status = napi_create_int32(env, c->videoFrame.frame_rate_N, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "frameRateN", param);
+  PASS_STATUS;
+
+  status = napi_create_int32(env, c->videoFrame.frame_rate_D, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "frameRateD", param);
+  PASS_STATUS;
+
+  status = napi_create_double(env, (double) c->videoFrame.picture_aspect_ratio, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "pictureAspectRatio", param);
+  PASS_STATUS;
 
-  c->status = napi_create_int32(env, c->videoFrame.yres, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "yres", param);
-  REJECT_STATUS;
+  napi_value params, paramn;
+  status = napi_create_int32(env, ptps, &params);
+  PASS_STATUS;
+  status = napi_create_int32(env, ptpn, &paramn);
+  PASS_STATUS;
+  status = napi_create_array(env, &param);
+  PASS_STATUS;
+  status = napi_set_element(env, param, 0, params);
+  PASS_STATUS;
+  status = napi_set_element(env, param, 1, paramn);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "timestamp", param);
+  PASS_STATUS;
+
+  bool copied = (c->output != nullptr) || (c->intoUsed > 0);
+  status = napi_create_int32(env,
+    copied ? c->outputFourCC : c->videoFrame.FourCC, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "fourCC", param);
+  PASS_STATUS;
+
+  status = napi_create_int32(env, c->videoFrame.frame_format_type, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "frameFormatType", param);
+  PASS_STATUS;
+
+  status = napi_create_int32(env, (int32_t) c->videoFrame.timecode / 10000000, &params);
+  PASS_STATUS;
+  status = napi_create_int32(env, (c->videoFrame.timecode % 10000000) * 100, &paramn);
+  PASS_STATUS;
+  status = napi_create_array(env, &param);
+  PASS_STATUS;
+  status = napi_set_element(env, param, 0, params);
+  PASS_STATUS;
+  status = napi_set_element(env, param, 1, paramn);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "timecode", param);
+  PASS_STATUS;
+
+  status = napi_create_int32(env,
+    copied ? c->outputStride : c->videoFrame.line_stride_in_bytes, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "lineStrideBytes", param);
+  PASS_STATUS;
 
-  c->status = napi_create_int32(env, c->videoFrame.frame_rate_N, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "frameRateN", param);
-  REJECT_STATUS;
+  if (c->videoFrame.p_metadata != nullptr) {
+    status = napi_create_string_utf8(env, c->videoFrame.p_metadata, NAPI_AUTO_LENGTH, &param);
+    PASS_STATUS;
+    status = napi_set_named_property(env, result, "metadata", param);
+    PASS_STATUS;
+  }
 
-  c->status = napi_create_int32(env, c->videoFrame.frame_rate_D, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "frameRateD", param);
-  REJECT_STATUS;
+  if (c->intoUsed > 0) {
+    // Already in the caller's Buffer, so NDI's memory is returned
+    freeVideoFrame(c);
+    status = napi_get_reference_value(env, c->passthru, &param);
+    PASS_STATUS;
+    status = napi_set_named_property(env, result, "data", param);
+    PASS_STATUS;
+  } else if (c->output != nullptr) {
+    // Converted or pooled data is already in memory of its own
+    freeVideoFrame(c);
+    receiveFrameHold* h = new receiveFrameHold;
+    h->instance = c->instance;
+    retainReceive(h->instance);
+    h->frameType = NDIlib_frame_type_video;
+    h->output = c->output;
+    c->output = nullptr;
+    status = wrapFrameHold(env, result, h, h->output->data, h->output->size, &param);
+    PASS_STATUS;
+  } else if (c->zeroCopy) {
+    receiveFrameHold* h = new receiveFrameHold;
+    h->instance = c->instance;
+    retainReceive(h->instance);
+    h->frameType = NDIlib_frame_type_video;
+    h->videoFrame = c->videoFrame;
+    status = wrapFrameHold(env, result, h, (void*) c->videoFrame.p_data,
+      c->videoFrame.line_stride_in_bytes * c->videoFrame.yres, &param);
+    PASS_STATUS;
+  } else {
+    status = napi_create_buffer_copy(env,
+      c->videoFrame.line_stride_in_bytes * c->videoFrame.yres,
+      (void*) c->videoFrame.p_data, nullptr, &param);
+    PASS_STATUS;
+    status = napi_set_named_property(env, result, "data", param);
+    PASS_STATUS;
+
+    freeVideoFrame(c);
+  }
 
-  c->status = napi_create_double(env, (double) c->videoFrame.picture_aspect_ratio, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "pictureAspectRatio", param);
-  REJECT_STATUS;
+  *frame = result;
+  return napi_ok;
+}
 
-  napi_value params, paramn;
-  c->status = napi_create_int32(env, ptps, &params);
-  REJECT_STATUS;
-  c->status = napi_create_int32(env, ptpn, &paramn);
-  REJECT_STATUS;
-  c->status = napi_create_array(env, &param);
-  REJECT_STATUS;
-  c->status = napi_set_element(env, param, 0, params);
-  REJECT_STATUS;
-  c->status = napi_set_element(env, param, 1, paramn);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "timestamp", param);
-  REJECT_STATUS;
+void videoReceiveComplete(napi_env env, napi_status asyncStatus, void* data) {
+  dataCarrier* c = (dataCarrier*) data;
 
-  c->status = napi_create_int32(env, c->videoFrame.FourCC, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "fourCC", param);
+  if (asyncStatus != napi_ok) {
+    c->status = asyncStatus;
+    c->errorMsg = "Async video frame receive failed to complete.";
+  }
   REJECT_STATUS;
 
-  c->status = napi_create_int32(env, c->videoFrame.frame_format_type, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "frameFormatType", param);
+  napi_value result;
+  c->status = makeVideoFrame(env, c, &result);
   REJECT_STATUS;
 
-  c->status = napi_create_int32(env, (int32_t) c->videoFrame.timecode / 10000000, &params);
-  REJECT_STATUS;
-  c->status = napi_create_int32(env, (c->videoFrame.timecode % 10000000) * 100, &paramn);
-  REJECT_STATUS;
-  c->status = napi_create_array(env, &param);
-  REJECT_STATUS;
-  c->status = napi_set_element(env, param, 0, params);
-  REJECT_STATUS;
-  c->status = napi_set_element(env, param, 1, paramn);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "timecode", param);
-  REJECT_STATUS;
-
-  c->status = napi_create_int32(env, c->videoFrame.line_stride_in_bytes, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "lineStrideBytes", param);
-  REJECT_STATUS;
-
-  if (c->videoFrame.p_metadata != nullptr) {
-    c->status = napi_create_string_utf8(env, c->videoFrame.p_metadata, NAPI_AUTO_LENGTH, &param);
-    REJECT_STATUS;
-    c->status = napi_set_named_property(env, result, "metadata", param);
-    REJECT_STATUS;
-  }
-
-  c->status = napi_create_buffer_copy(env,
-    c->videoFrame.line_stride_in_bytes * c->videoFrame.yres,
-    (void*) c->videoFrame.p_data, nullptr, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "data", param);
-  REJECT_STATUS;
-
-  NDIlib_recv_free_video_v2(c->recv, &c->videoFrame);
-
-  napi_status status;
-  status = napi_resolve_deferred(env, c->_deferred, result);
-  FLOATING_STATUS;
+  napi_status status;
+  status = napi_resolve_deferred(env, c->_deferred, result);
+  FLOATING_STATUS;
 
   tidyCarrier(env, c);
 }
@@ -425,8 +1013,8 @@ napi_value videoReceive(napi_env env, napi_callback_info info) {
   c->status = napi_create_promise(env, &c->_deferred, &promise);
   REJECT_RETURN;
 
-  size_t argc = 1;
-  napi_value args[1];
+  size_t argc = 2;
+  napi_value args[2];
   napi_value thisValue;
   c->status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
   REJECT_RETURN;
@@ -436,25 +1024,35 @@ napi_value videoReceive(napi_env env, napi_callback_info info) {
   REJECT_RETURN;
   void* recvData;
   c->status = napi_get_value_external(env, recvValue, &recvData);
-  c->recv = (NDIlib_recv_instance_t) recvData;
+  REJECT_RETURN;
+  c->instance = (receiveInstance*) recvData;
+  retainReceive(c->instance);
+  c->recv = c->instance->recv;
+  c->zeroCopy = c->instance->zeroCopy;
+  startDemux(c->instance, c, Grandiose_demux_video);
   REJECT_RETURN;
 
   if (argc >= 1) {
+    napi_value waitValue = args[0];
     c->status = napi_typeof(env, args[0], &type);
     REJECT_RETURN;
-    if (type == napi_number) {
-      c->status = napi_get_value_uint32(env, args[0], &c->wait);
+    if (type == napi_object) {
+      readIntoOption(env, args[0], c);
       REJECT_RETURN;
+      waitValue = (argc >= 2) ? args[1] : nullptr;
+    }
+    if (waitValue != nullptr) {
+      c->status = napi_typeof(env, waitValue, &type);
+      REJECT_RETURN;
+      if (type == napi_number) {
+        c->status = napi_get_value_uint32(env, waitValue, &c->wait);
+        REJECT_RETURN;
+      }
     }
   }
 
-  napi_value resource_name;
-  c->status = napi_create_string_utf8(env, "VideoReceive", NAPI_AUTO_LENGTH, &resource_name);
-  REJECT_RETURN;
-  c->status = napi_create_async_work(env, NULL, resource_name, videoReceiveExecute,
-    videoReceiveComplete, c, &c->_request);
-  REJECT_RETURN;
-  c->status = napi_queue_async_work(env, c->_request);
+  c->status = queueNDIWork(env, c, Grandiose_lane_video,
+    videoReceiveExecute, videoReceiveComplete);
   REJECT_RETURN;
 
   return promise;
@@ -463,150 +1061,165 @@ napi_value videoReceive(napi_env env, napi_callback_info info) {
 void audioReceiveExecute(napi_env env, void* data) {
   dataCarrier* c = (dataCarrier*) data;
 
-  switch (NDIlib_recv_capture_v2(c->recv, nullptr, &c->audioFrame, nullptr, c->wait))
-  {
-    case NDIlib_frame_type_none:
-      c->status = GRANDIOSE_NOT_FOUND;
-      c->errorMsg = "No audio data received in the requested time interval.";
-      break;
-
-    // Audio data
-    case NDIlib_frame_type_audio:
-      switch (c->audioFormat) {
-        case Grandiose_audio_format_int_16_interleaved:
-          c->audioFrame16s.reference_level = c->referenceLevel;
-          c->audioFrame16s.p_data = new short[c->audioFrame.no_samples * c->audioFrame.no_channels];
-          NDIlib_util_audio_to_interleaved_16s_v2(&c->audioFrame, &c->audioFrame16s);
-          break;
-        case Grandiose_audio_format_float_32_interleaved:
-          c->audioFrame32fIlvd.p_data = new float[c->audioFrame.no_samples * c->audioFrame.no_channels];
-          NDIlib_util_audio_to_interleaved_32f_v2(&c->audioFrame, &c->audioFrame32fIlvd);
-          break;
-        case Grandiose_audio_format_float_32_separate:
-        default:
-          break;
-      }
-      break;
-
-    default:
-      c->status = GRANDIOSE_NOT_AUDIO;
-      c->errorMsg = "Non-audio data received on audio capture.";
-      break;
+  dataCarrier* f = takeDemuxed(c->instance, Grandiose_demux_audio, c->wait);
+  if (f == nullptr) {
+    c->status = GRANDIOSE_NOT_FOUND;
+    c->errorMsg = "No audio data received in the requested time interval.";
+    return;
   }
+  c->audioFrame = f->audioFrame;
+  delete f;
+  convertAudioFrame(c);
 }
 
-void audioReceiveComplete(napi_env env, napi_status asyncStatus, void* data) {
-  dataCarrier* c = (dataCarrier*) data;
-
-  if (asyncStatus != napi_ok) {
-    c->status = asyncStatus;
-    c->errorMsg = "Async audio frame receive failed to complete.";
-  }
-  REJECT_STATUS;
-
+napi_status makeAudioFrame(napi_env env, dataCarrier* c, napi_value* frame) {
+  napi_status status;
   napi_value result;
-  c->status = napi_create_object(env, &result);
-  REJECT_STATUS;
+  status = napi_create_object(env, &result);
+  PASS_STATUS;
 
   int32_t ptps, ptpn;
   ptps = (int32_t) (c->audioFrame.timestamp / 10000000);
   ptpn = (c->audioFrame.timestamp % 10000000) * 100;
 
   napi_value param;
-  c->status = napi_create_string_utf8(env, "audio", NAPI_AUTO_LENGTH, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "type", param);
-  REJECT_STATUS;
+  status = napi_create_string_utf8(env, "audio", NAPI_AUTO_LENGTH, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "type", param);
+  PASS_STATUS;
 
-  c->status = napi_create_int32(env, c->audioFormat, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "audioFormat", param);
-  REJECT_STATUS;
+  status = napi_create_int32(env, c->audioFormat, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "audioFormat", param);
+  PASS_STATUS;
 
   if (c->audioFormat == Grandiose_audio_format_int_16_interleaved) {
-    c->status = napi_create_int32(env, c->referenceLevel, &param);
-    REJECT_STATUS;
-    c->status = napi_set_named_property(env, result, "referenceLevel", param);
-    REJECT_STATUS;
+    status = napi_create_int32(env, c->referenceLevel, &param);
+    PASS_STATUS;
+    status = napi_set_named_property(env, result, "referenceLevel", param);
+    PASS_STATUS;
   }
 
-  c->status = napi_create_int32(env, c->audioFrame.sample_rate, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "sampleRate", param);
-  REJECT_STATUS;
+  status = napi_create_int32(env, c->audioFrame.sample_rate, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "sampleRate", param);
+  PASS_STATUS;
 
-  c->status = napi_create_int32(env, c->audioFrame.no_channels, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "channels", param);
-  REJECT_STATUS;
+  status = napi_create_int32(env, c->audioFrame.no_channels, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "channels", param);
+  PASS_STATUS;
 
-  c->status = napi_create_int32(env, c->audioFrame.no_samples, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "samples", param);
-  REJECT_STATUS;
+  status = napi_create_int32(env, c->audioFrame.no_samples, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "samples", param);
+  PASS_STATUS;
 
   int32_t factor = (c->audioFormat == Grandiose_audio_format_int_16_interleaved) ? 2 : 1;
-  c->status = napi_create_int32(env, c->audioFrame.channel_stride_in_bytes / factor, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "channelStrideInBytes", param);
-  REJECT_STATUS;
+  status = napi_create_int32(env, c->audioFrame.channel_stride_in_bytes / factor, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "channelStrideInBytes", param);
+  PASS_STATUS;
 
   napi_value params, paramn;
-  c->status = napi_create_int32(env, ptps, &params);
-  REJECT_STATUS;
-  c->status = napi_create_int32(env, ptpn, &paramn);
-  REJECT_STATUS;
-  c->status = napi_create_array(env, &param);
-  REJECT_STATUS;
-  c->status = napi_set_element(env, param, 0, params);
-  REJECT_STATUS;
-  c->status = napi_set_element(env, param, 1, paramn);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "timestamp", param);
-  REJECT_STATUS;
-
-  c->status = napi_create_int32(env, (int32_t) (c->audioFrame.timecode / 10000000), &params);
-  REJECT_STATUS;
-  c->status = napi_create_int32(env, (c->audioFrame.timecode % 10000000) * 100, &paramn);
-  REJECT_STATUS;
-  c->status = napi_create_array(env, &param);
-  REJECT_STATUS;
-  c->status = napi_set_element(env, param, 0, params);
-  REJECT_STATUS;
-  c->status = napi_set_element(env, param, 1, paramn);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "timecode", param);
-  REJECT_STATUS;
+  status = napi_create_int32(env, ptps, &params);
+  PASS_STATUS;
+  status = napi_create_int32(env, ptpn, &paramn);
+  PASS_STATUS;
+  status = napi_create_array(env, &param);
+  PASS_STATUS;
+  status = napi_set_element(env, param, 0, params);
+  PASS_STATUS;
+  status = napi_set_element(env, param, 1, paramn);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "timestamp", param);
+  PASS_STATUS;
+
+  status = napi_create_int32(env, (int32_t) (c->audioFrame.timecode / 10000000), &params);
+  PASS_STATUS;
+  status = napi_create_int32(env, (c->audioFrame.timecode % 10000000) * 100, &paramn);
+  PASS_STATUS;
+  status = napi_create_array(env, &param);
+  PASS_STATUS;
+  status = napi_set_element(env, param, 0, params);
+  PASS_STATUS;
+  status = napi_set_element(env, param, 1, paramn);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "timecode", param);
+  PASS_STATUS;
 
   if (c->audioFrame.p_metadata != nullptr) {
-    c->status = napi_create_string_utf8(env, c->audioFrame.p_metadata, NAPI_AUTO_LENGTH, &param);
-    REJECT_STATUS;
-    c->status = napi_set_named_property(env, result, "metadata", param);
-    REJECT_STATUS;
+    status = napi_create_string_utf8(env, c->audioFrame.p_metadata, NAPI_AUTO_LENGTH, &param);
+    PASS_STATUS;
+    status = napi_set_named_property(env, result, "metadata", param);
+    PASS_STATUS;
   }
 
-  char * rawFloats;
-  switch (c->audioFormat) {
-    case Grandiose_audio_format_int_16_interleaved:
-      rawFloats = (char*) c->audioFrame16s.p_data;
-      break;
-    case Grandiose_audio_format_float_32_interleaved:
-      rawFloats = (char*) c->audioFrame32fIlvd.p_data;
-      break;
-    default:
-    case Grandiose_audio_format_float_32_separate:
-      rawFloats = (char*) c->audioFrame.p_data;
-      break;
+  if (c->intoUsed > 0) {
+    // Already in the caller's Buffer
+    status = napi_get_reference_value(env, c->passthru, &param);
+    PASS_STATUS;
+    status = napi_set_named_property(env, result, "data", param);
+    PASS_STATUS;
+
+    freeAudioFrame(c);
+  } else if (c->zeroCopy && (c->audioFormat == Grandiose_audio_format_float_32_separate)) {
+    receiveFrameHold* h = new receiveFrameHold;
+    h->instance = c->instance;
+    retainReceive(h->instance);
+    h->frameType = NDIlib_frame_type_audio;
+    h->audioFrame = c->audioFrame;
+    status = wrapFrameHold(env, result, h, (void*) c->audioFrame.p_data,
+      c->audioFrame.channel_stride_in_bytes * c->audioFrame.no_channels, &param);
+    PASS_STATUS;
+
+    // Per-channel views share the external buffer, so release() detaches them too
+    napi_typedarray_type arrayType;
+    size_t length, offset;
+    void* arrayData;
+    napi_value arrayBuffer, channels, channel;
+    status = napi_get_typedarray_info(env, param, &arrayType, &length,
+      &arrayData, &arrayBuffer, &offset);
+    PASS_STATUS;
+    status = napi_create_array_with_length(env, c->audioFrame.no_channels, &channels);
+    PASS_STATUS;
+    for ( int32_t x = 0 ; x < c->audioFrame.no_channels ; x++ ) {
+      status = napi_create_typedarray(env, napi_float32_array, c->audioFrame.no_samples,
+        arrayBuffer, offset + x * c->audioFrame.channel_stride_in_bytes, &channel);
+      PASS_STATUS;
+      status = napi_set_element(env, channels, x, channel);
+      PASS_STATUS;
+    }
+    status = napi_set_named_property(env, result, "channelData", channels);
+    PASS_STATUS;
+  } else {
+    size_t size;
+    char* rawFloats = audioFrameData(c, &size);
+    status = napi_create_buffer_copy(env, size, rawFloats, nullptr, &param);
+    PASS_STATUS;
+
+    status = napi_set_named_property(env, result, "data", param);
+    PASS_STATUS;
+
+    freeAudioFrame(c);
   }
-  c->status = napi_create_buffer_copy(env,
-    (c->audioFrame.channel_stride_in_bytes / factor) * c->audioFrame.no_channels,
-    rawFloats, nullptr, &param);
-  REJECT_STATUS;
 
-  c->status = napi_set_named_property(env, result, "data", param);
+  *frame = result;
+  return napi_ok;
+}
+
+void audioReceiveComplete(napi_env env, napi_status asyncStatus, void* data) {
+  dataCarrier* c = (dataCarrier*) data;
+
+  if (asyncStatus != napi_ok) {
+    c->status = asyncStatus;
+    c->errorMsg = "Async audio frame receive failed to complete.";
+  }
   REJECT_STATUS;
 
-  NDIlib_recv_free_audio_v2(c->recv, &c->audioFrame);
+  napi_value result;
+  c->status = makeAudioFrame(env, c, &result);
+  REJECT_STATUS;
 
   napi_status status;
   status = napi_resolve_deferred(env, c->_deferred, result);
@@ -616,7 +1229,7 @@ void audioReceiveComplete(napi_env env, napi_status asyncStatus, void* data) {
 }
 
 napi_value dataAndAudioReceive(napi_env env, napi_callback_info info,
-    const char* resourceName, napi_async_execute_callback execute,
+    Grandiose_lane_e lane, napi_async_execute_callback execute,
     napi_async_complete_callback complete) {
   napi_valuetype type;
   dataCarrier* c = new dataCarrier;
@@ -636,8 +1249,18 @@ napi_value dataAndAudioReceive(napi_env env, napi_callback_info info,
   REJECT_RETURN;
   void* recvData;
   c->status = napi_get_value_external(env, recvValue, &recvData);
-  c->recv = (NDIlib_recv_instance_t) recvData;
   REJECT_RETURN;
+  c->instance = (receiveInstance*) recvData;
+  retainReceive(c->instance);
+  c->recv = c->instance->recv;
+  c->zeroCopy = c->instance->zeroCopy;
+  // data() captures every type itself
+  if (lane == Grandiose_lane_audio) {
+    startDemux(c->instance, c, Grandiose_demux_audio);
+    REJECT_RETURN;
+  } else if (c->instance->synced) REJECT_ERROR_RETURN(
+    "Video and audio are delivered by the frame synchronizer of this receiver.",
+    GRANDIOSE_INVALID_ARGS);
 
   if (argc >= 1) {
     napi_value configValue, waitValue;
@@ -681,6 +1304,9 @@ napi_value dataAndAudioReceive(napi_env env, napi_callback_info info,
       else if (type != napi_undefined) REJECT_ERROR_RETURN(
         "Audio reference level must be a number if present.",
         GRANDIOSE_INVALID_ARGS);
+
+      readIntoOption(env, configValue, c);
+      REJECT_RETURN;
     }
     c->status = napi_typeof(env, waitValue, &type);
     REJECT_RETURN;
@@ -690,43 +1316,70 @@ napi_value dataAndAudioReceive(napi_env env, napi_callback_info info,
     }
   }
 
-  napi_value resource_name;
-  c->status = napi_create_string_utf8(env, resourceName, NAPI_AUTO_LENGTH, &resource_name);
-  REJECT_RETURN;
-  c->status = napi_create_async_work(env, NULL, resource_name, execute,
-    complete, c, &c->_request);
-  REJECT_RETURN;
-  c->status = napi_queue_async_work(env, c->_request);
+  c->status = queueNDIWork(env, c, lane, execute, complete);
   REJECT_RETURN;
 
   return promise;
 }
 
 napi_value audioReceive(napi_env env, napi_callback_info info) {
-  return dataAndAudioReceive(env, info, "AudioReceive",
+  return dataAndAudioReceive(env, info, Grandiose_lane_audio,
     audioReceiveExecute, audioReceiveComplete);
 }
 
 void metadataReceiveExecute(napi_env env, void* data) {
   dataCarrier* c = (dataCarrier*) data;
 
-  switch (NDIlib_recv_capture_v2(c->recv, nullptr, nullptr, &c->metadataFrame, c->wait))
-  {
-    case NDIlib_frame_type_none:
-      c->status = GRANDIOSE_NOT_FOUND;
-      c->errorMsg = "No metadata received in the requested time interval.";
-      break;
+  dataCarrier* f = takeDemuxed(c->instance, Grandiose_demux_metadata, c->wait);
+  if (f == nullptr) {
+    c->status = GRANDIOSE_NOT_FOUND;
+    c->errorMsg = "No metadata received in the requested time interval.";
+    return;
+  }
+  c->metadataFrame = f->metadataFrame;
+  delete f;
+}
 
-    // Metadata
-    case NDIlib_frame_type_metadata:
-      break;
+napi_status makeMetadataFrame(napi_env env, dataCarrier* c, napi_value* frame) {
+  napi_status status;
+  napi_value result;
+  status = napi_create_object(env, &result);
+  PASS_STATUS;
 
-    default:
-      c->status = GRANDIOSE_NOT_AUDIO;
-      c->errorMsg = "Non-metadata payload received on metadata capture.";
-      break;
-  }
+  napi_value param;
+  status = napi_create_string_utf8(env, "metadata", NAPI_AUTO_LENGTH, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "type", param);
+  PASS_STATUS;
+
+  status = napi_create_int32(env, c->metadataFrame.length, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "length", param);
+  PASS_STATUS;
+
+  napi_value params, paramn;
+  status = napi_create_int32(env, (int32_t) (c->metadataFrame.timecode / 10000000), &params);
+  PASS_STATUS;
+  status = napi_create_int32(env, (c->metadataFrame.timecode % 10000000) * 100, &paramn);
+  PASS_STATUS;
+  status = napi_create_array(env, &param);
+  PASS_STATUS;
+  status = napi_set_element(env, param, 0, params);
+  PASS_STATUS;
+  status = napi_set_element(env, param, 1, paramn);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "timecode", param);
+  PASS_STATUS;
+
+  status = napi_create_string_utf8(env, c->metadataFrame.p_data, NAPI_AUTO_LENGTH, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "data", param);
+  PASS_STATUS;
+
+  NDIlib_recv_free_metadata(c->recv, &c->metadataFrame);
 
+  *frame = result;
+  return napi_ok;
 }
 
 void metadataReceiveComplete(napi_env env, napi_status asyncStatus, void* data) {
@@ -739,41 +1392,9 @@ void metadataReceiveComplete(napi_env env, napi_status asyncStatus, void* data)
   REJECT_STATUS;
 
   napi_value result;
-  c->status = napi_create_object(env, &result);
-  REJECT_STATUS;
-
-  napi_value param;
-  c->status = napi_create_string_utf8(env, "metadata", NAPI_AUTO_LENGTH, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "type", param);
-  REJECT_STATUS;
-
-  c->status = napi_create_int32(env, c->metadataFrame.length, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "length", param);
+  c->status = makeMetadataFrame(env, c, &result);
   REJECT_STATUS;
 
-  napi_value params, paramn;
-  c->status = napi_create_int32(env, (int32_t) (c->metadataFrame.timecode / 10000000), &params);
-  REJECT_STATUS;
-  c->status = napi_create_int32(env, (c->metadataFrame.timecode % 10000000) * 100, &paramn);
-  REJECT_STATUS;
-  c->status = napi_create_array(env, &param);
-  REJECT_STATUS;
-  c->status = napi_set_element(env, param, 0, params);
-  REJECT_STATUS;
-  c->status = napi_set_element(env, param, 1, paramn);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "timecode", param);
-  REJECT_STATUS;
-
-  c->status = napi_create_string_utf8(env, c->metadataFrame.p_data, NAPI_AUTO_LENGTH, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "data", param);
-  REJECT_STATUS;
-
-  NDIlib_recv_free_metadata(c->recv, &c->metadataFrame);
-
   napi_status status;
   status = napi_resolve_deferred(env, c->_deferred, result);
   FLOATING_STATUS;
@@ -800,7 +1421,12 @@ napi_value metadataReceive(napi_env env, napi_callback_info info) {
   REJECT_RETURN;
   void* recvData;
   c->status = napi_get_value_external(env, recvValue, &recvData);
-  c->recv = (NDIlib_recv_instance_t) recvData;
+  REJECT_RETURN;
+  c->instance = (receiveInstance*) recvData;
+  retainReceive(c->instance);
+  c->recv = c->instance->recv;
+  c->zeroCopy = c->instance->zeroCopy;
+  startDemux(c->instance, c, Grandiose_demux_metadata);
   REJECT_RETURN;
 
   if (argc >= 1) {
@@ -812,13 +1438,8 @@ napi_value metadataReceive(napi_env env, napi_callback_info info) {
     }
   }
 
-  napi_value resource_name;
-  c->status = napi_create_string_utf8(env, "MetadataReceive", NAPI_AUTO_LENGTH, &resource_name);
-  REJECT_RETURN;
-  c->status = napi_create_async_work(env, NULL, resource_name, metadataReceiveExecute,
-    metadataReceiveComplete, c, &c->_request);
-  REJECT_RETURN;
-  c->status = napi_queue_async_work(env, c->_request);
+  c->status = queueNDIWork(env, c, Grandiose_lane_metadata,
+    metadataReceiveExecute, metadataReceiveComplete);
   REJECT_RETURN;
 
   return promise;
@@ -827,25 +1448,32 @@ napi_value metadataReceive(napi_env env, napi_callback_info info) {
 void dataReceiveExecute(napi_env env, void* data) {
   dataCarrier* c = (dataCarrier*) data;
 
-  c->frameType = NDIlib_recv_capture_v2(c->recv, &c->videoFrame, &c->audioFrame, &c->metadataFrame, c->wait);
+  // While the queues for video(), audio() and metadata() are filled, frames
+  // are taken from them rather than from NDI, so that none are lost to them
+  if (c->instance->demuxing) {
+    dataCarrier* f = takeAnyDemuxed(c->instance, c->wait);
+    if (f == nullptr) {
+      c->status = GRANDIOSE_NOT_FOUND;
+      c->errorMsg = "No data received in the requested time interval.";
+      return;
+    }
+    c->frameType = f->frameType;
+    c->videoFrame = f->videoFrame;
+    c->audioFrame = f->audioFrame;
+    c->metadataFrame = f->metadataFrame;
+    delete f;
+  }
+  else
+    c->frameType = NDIlib_recv_capture_v2(c->recv, &c->videoFrame, &c->audioFrame, &c->metadataFrame, c->wait);
   switch (c->frameType) {
 
     // Audio data
     case NDIlib_frame_type_audio:
-      switch (c->audioFormat) {
-        case Grandiose_audio_format_int_16_interleaved:
-          c->audioFrame16s.reference_level = c->referenceLevel;
-          c->audioFrame16s.p_data = new short[c->audioFrame.no_samples * c->audioFrame.no_channels];
-          NDIlib_util_audio_to_interleaved_16s_v2(&c->audioFrame, &c->audioFrame16s);
-          break;
-        case Grandiose_audio_format_float_32_interleaved:
-          c->audioFrame32fIlvd.p_data = new float[c->audioFrame.no_samples * c->audioFrame.no_channels];
-          NDIlib_util_audio_to_interleaved_32f_v2(&c->audioFrame, &c->audioFrame32fIlvd);
-          break;
-        case Grandiose_audio_format_float_32_separate:
-        default:
-          break;
-      }
+      convertAudioFrame(c);
+      break;
+
+    case NDIlib_frame_type_video:
+      convertVideoFrame(c);
       break;
 
       // Handle all other types on completion
@@ -855,6 +1483,27 @@ void dataReceiveExecute(napi_env env, void* data) {
 
 }
 
+napi_status makeDataFrame(napi_env env, dataCarrier* c, napi_value* frame) {
+  napi_status status;
+  napi_value param;
+
+  switch (c->frameType) {
+    case NDIlib_frame_type_video:
+      return makeVideoFrame(env, c, frame);
+    case NDIlib_frame_type_audio:
+      return makeAudioFrame(env, c, frame);
+    case NDIlib_frame_type_metadata:
+      return makeMetadataFrame(env, c, frame);
+    case NDIlib_frame_type_status_change:
+    default:
+      status = napi_create_object(env, frame);
+      PASS_STATUS;
+      status = napi_create_string_utf8(env, "statusChange", NAPI_AUTO_LENGTH, &param);
+      PASS_STATUS;
+      return napi_set_named_property(env, *frame, "type", param);
+  }
+}
+
 void dataReceiveComplete(napi_env env, napi_status asyncStatus, void* data) {
   dataCarrier* c = (dataCarrier*) data;
 
@@ -865,27 +1514,17 @@ void dataReceiveComplete(napi_env env, napi_status asyncStatus, void* data) {
   REJECT_STATUS;
 
   switch (c->frameType) {
-    case NDIlib_frame_type_video:
-      videoReceiveComplete(env, asyncStatus, data);
-      break;
-    case NDIlib_frame_type_audio:
-      audioReceiveComplete(env, asyncStatus, data);
-      break;
-    case NDIlib_frame_type_metadata:
-      metadataReceiveComplete(env, asyncStatus, data);
-      break;
     case NDIlib_frame_type_error:
       c->errorMsg = "Received error response from NDI data request. Connection lost.";
       c->status = GRANDIOSE_CONNECTION_LOST;
       REJECT_STATUS;
       break;
+    case NDIlib_frame_type_video:
+    case NDIlib_frame_type_audio:
+    case NDIlib_frame_type_metadata:
     case NDIlib_frame_type_status_change:
-      napi_value result, param;
-      c->status = napi_create_object(env, &result);
-      REJECT_STATUS;
-      c->status = napi_create_string_utf8(env, "statusChange", NAPI_AUTO_LENGTH, &param);
-      REJECT_STATUS;
-      c->status = napi_set_named_property(env, result, "type", param);
+      napi_value result;
+      c->status = makeDataFrame(env, c, &result);
       REJECT_STATUS;
 
       napi_status status;
@@ -901,6 +1540,900 @@ void dataReceiveComplete(napi_env env, napi_status asyncStatus, void* data) {
 }
 
 napi_value dataReceive(napi_env env, napi_callback_info info) {
-  return dataAndAudioReceive(env, info, "DataReceive",
+  return dataAndAudioReceive(env, info, Grandiose_lane_data,
     dataReceiveExecute, dataReceiveComplete);
 }
+
+// Return a captured frame that will not reach JavaScript to NDI
+void freeCapturedFrame(dataCarrier* c) {
+  switch (c->frameType) {
+    case NDIlib_frame_type_video:
+      freeVideoFrame(c);
+      break;
+    case NDIlib_frame_type_audio:
+      freeAudioFrame(c);
+      break;
+    case NDIlib_frame_type_metadata:
+      NDIlib_recv_free_metadata(c->recv, &c->metadataFrame);
+      break;
+    default:
+      break;
+  }
+}
+
+// Capturing thread. Whether a captured video frame is passed on under the
+// receiver's delivery policy. Frames that are not are freed by the caller
+// before any conversion or copy.
+bool deliverVideo(receiveInstance* r, dataCarrier* f) {
+  switch (r->delivery) {
+    case Grandiose_delivery_latest: {
+      // Stale if a newer frame is already waiting in NDI
+      NDIlib_recv_queue_t queued;
+      NDIlib_recv_get_queue(r->recv, &queued);
+      return queued.video_frames == 0;
+    }
+    case Grandiose_delivery_every:
+      return (r->deliveryCount++ % r->deliveryEvery) == 0;
+    case Grandiose_delivery_max_fps: {
+      auto now = std::chrono::steady_clock::now();
+      // Half a source frame of tolerance, so that jitter does not push the
+      // frame that is due to the next one
+      double frameTime = (f->videoFrame.frame_rate_N > 0) ?
+        (double) f->videoFrame.frame_rate_D / f->videoFrame.frame_rate_N : 0.0;
+      auto tolerance = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(frameTime / 2.0));
+      if (now + tolerance < r->deliveryDue) return false;
+      auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / r->deliveryMaxFps));
+      r->deliveryDue += period;
+      // Restart the cadence after a gap in the source
+      if (r->deliveryDue < now) r->deliveryDue = now + period;
+      return true;
+    }
+    case Grandiose_delivery_all:
+    default:
+      return true;
+  }
+}
+
+// Body of the receiver's demultiplexing thread
+void demuxLoop(receiveInstance* r) {
+  while (r->demuxing) {
+    // Frames waiting in a queue hold no reference on the receiver
+    dataCarrier* f = new dataCarrier;
+    f->recv = r->recv;
+    // Only metadata while a frame synchronizer takes video and audio
+    bool synced = r->synced;
+    f->frameType = NDIlib_recv_capture_v2(f->recv,
+      synced ? nullptr : &f->videoFrame, synced ? nullptr : &f->audioFrame,
+      &f->metadataFrame, r->demuxWait);
+    Grandiose_demux_e type;
+    switch (f->frameType) {
+      case NDIlib_frame_type_video:
+        type = Grandiose_demux_video;
+        break;
+      case NDIlib_frame_type_audio:
+        type = Grandiose_demux_audio;
+        break;
+      case NDIlib_frame_type_metadata:
+        type = Grandiose_demux_metadata;
+        break;
+      case NDIlib_frame_type_error:
+        // Connection lost, so back off rather than spin until it returns
+        delete f;
+        std::this_thread::sleep_for(std::chrono::milliseconds(r->demuxWait));
+        continue;
+      default:
+        delete f;
+        continue;
+    }
+
+    demuxQueue* q = &r->demux[type];
+    q->received++;
+    if (type == Grandiose_demux_video) {
+      bool latest = (r->delivery == Grandiose_delivery_latest);
+      if (!deliverVideo(r, f)) {
+        freeCapturedFrame(f);
+        delete f;
+        if (latest) q->dropped++;
+        continue;
+      }
+      // Only the newest frame is kept
+      dataCarrier* stale;
+      while (latest && ((stale = q->frames->pop()) != nullptr)) {
+        freeCapturedFrame(stale);
+        delete stale;
+        q->dropped++;
+      }
+    }
+    while (!q->frames->push(f)) {
+      dataCarrier* oldest = q->frames->pop();
+      if (oldest != nullptr) {
+        freeCapturedFrame(oldest);
+        delete oldest;
+        q->dropped++;
+      }
+    }
+    // Waiters check their queue holding the lock, so cannot miss this
+    { std::lock_guard<std::mutex> lock(r->demuxLock); }
+    r->demuxReady.notify_all();
+  }
+}
+
+// Main thread. Started by the first call for a single type of frame, unless
+// receiver.start() is delivering every frame to its callback or a frame
+// synchronizer is delivering video and audio.
+void startDemux(receiveInstance* r, carrier* c, Grandiose_demux_e type) {
+  if (r->captureFn != nullptr) CARRIER_ERROR(
+    "Frames are delivered to the receiver.start() callback until capture is stopped.",
+    GRANDIOSE_INVALID_ARGS);
+  if (r->synced && (type != Grandiose_demux_metadata)) CARRIER_ERROR(
+    "Video and audio are delivered by the frame synchronizer of this receiver.",
+    GRANDIOSE_INVALID_ARGS);
+  if (r->demuxing) return;
+  r->demuxing = true;
+  r->demuxThread = std::thread(demuxLoop, r);
+}
+
+// Stops the thread, within one capture wait, and drops frames still queued.
+// Calls waiting for a frame return without one.
+void stopDemux(receiveInstance* r) {
+  if (!r->demuxThread.joinable()) return;
+  r->demuxing = false;
+  r->demuxThread.join();
+  { std::lock_guard<std::mutex> lock(r->demuxLock); }
+  r->demuxReady.notify_all();
+  for ( int x = 0 ; x < Grandiose_demux_max ; x++ ) {
+    dataCarrier* f;
+    while ((f = r->demux[x].frames->pop()) != nullptr) {
+      freeCapturedFrame(f);
+      delete f;
+    }
+  }
+}
+
+// Lane thread. Takes the oldest frame of the type, waiting up to wait ms for
+// one to arrive. Returns nullptr if none arrives or the demultiplexer stops.
+dataCarrier* takeDemuxed(receiveInstance* r, Grandiose_demux_e type, uint32_t wait) {
+  frameRing<dataCarrier>* frames = r->demux[type].frames;
+  dataCarrier* f = frames->pop();
+  if (f != nullptr) return f;
+  auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(wait);
+  std::unique_lock<std::mutex> lock(r->demuxLock);
+  while (true) {
+    f = frames->pop();
+    if ((f != nullptr) || !r->demuxing) return f;
+    if (r->demuxReady.wait_until(lock, until) == std::cv_status::timeout)
+      return frames->pop();
+  }
+}
+
+// The oldest frame of the first type found waiting, or nullptr if none is
+dataCarrier* popAnyDemuxed(receiveInstance* r) {
+  for ( int x = 0 ; x < Grandiose_demux_max ; x++ ) {
+    dataCarrier* f = r->demux[x].frames->pop();
+    if (f != nullptr) return f;
+  }
+  return nullptr;
+}
+
+// Lane thread. Takes a frame of any type for data(), waiting up to wait ms
+// for one to arrive. Returns nullptr if none arrives or the demultiplexer
+// stops.
+dataCarrier* takeAnyDemuxed(receiveInstance* r, uint32_t wait) {
+  dataCarrier* f = popAnyDemuxed(r);
+  if (f != nullptr) return f;
+  auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(wait);
+  std::unique_lock<std::mutex> lock(r->demuxLock);
+  while (true) {
+    f = popAnyDemuxed(r);
+    if ((f != nullptr) || !r->demuxing) return f;
+    if (r->demuxReady.wait_until(lock, until) == std::cv_status::timeout)
+      return popAnyDemuxed(r);
+  }
+}
+
+// Called on any thread. Takes a sample of a receiver's statistics.
+void sampleReceiveStats(receiveInstance* r, receiveStats* s) {
+  s->time = (double) std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+  s->connections = NDIlib_recv_get_no_connections(r->recv);
+  NDIlib_recv_performance_t total, dropped;
+  NDIlib_recv_get_performance(r->recv, &total, &dropped);
+  NDIlib_recv_queue_t queued;
+  NDIlib_recv_get_queue(r->recv, &queued);
+  s->total[Grandiose_demux_video] = total.video_frames;
+  s->total[Grandiose_demux_audio] = total.audio_frames;
+  s->total[Grandiose_demux_metadata] = total.metadata_frames;
+  s->dropped[Grandiose_demux_video] = dropped.video_frames;
+  s->dropped[Grandiose_demux_audio] = dropped.audio_frames;
+  s->dropped[Grandiose_demux_metadata] = dropped.metadata_frames;
+  s->queued[Grandiose_demux_video] = queued.video_frames;
+  s->queued[Grandiose_demux_audio] = queued.audio_frames;
+  s->queued[Grandiose_demux_metadata] = queued.metadata_frames;
+  for ( int x = 0 ; x < Grandiose_demux_max ; x++ ) {
+    s->pending[x] = r->demux[x].frames->size();
+    s->discarded[x] = r->demux[x].dropped + r->captureDropped[x];
+  }
+}
+
+napi_status makeReceiveStats(napi_env env, const receiveStats* s, napi_value* result) {
+  napi_status status;
+  static const char* names[Grandiose_demux_max] = { "video", "audio", "metadata" };
+
+  status = napi_create_object(env, result);
+  PASS_STATUS;
+  napi_value param;
+  status = napi_create_double(env, s->time, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "time", param);
+  PASS_STATUS;
+  status = napi_create_int32(env, s->connections, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "connections", param);
+  PASS_STATUS;
+
+  const char* groups[] = { "total", "dropped", "queued", "pending", "discarded" };
+  for ( int g = 0 ; g < 5 ; g++ ) {
+    napi_value group;
+    status = napi_create_object(env, &group);
+    PASS_STATUS;
+    for ( int x = 0 ; x < Grandiose_demux_max ; x++ ) {
+      double value;
+      switch (g) {
+        case 0: value = (double) s->total[x]; break;
+        case 1: value = (double) s->dropped[x]; break;
+        case 2: value = (double) s->queued[x]; break;
+        case 3: value = (double) s->pending[x]; break;
+        default: value = (double) s->discarded[x]; break;
+      }
+      status = napi_create_double(env, value, &param);
+      PASS_STATUS;
+      status = napi_set_named_property(env, group, names[x], param);
+      PASS_STATUS;
+    }
+    status = napi_set_named_property(env, *result, groups[g], group);
+    PASS_STATUS;
+  }
+  return napi_ok;
+}
+
+// Receivers sampled by receiver.sampleStats(), all on one thread so that
+// sampling hundreds of receivers costs a single thread. The lock is held
+// while a receiver is sampled, so that one being destroyed waits for it.
+// Never destroyed, as the detached thread may still be waiting at exit.
+struct statsSampler {
+  std::mutex m;
+  std::condition_variable cv;
+  std::vector<receiveInstance*> receivers;
+  bool running = false;
+};
+static statsSampler* sampler = new statsSampler;
+
+void samplerThread() {
+  std::unique_lock<std::mutex> lock(sampler->m);
+  while (true) {
+    if (sampler->receivers.empty()) {
+      sampler->cv.wait(lock);
+      continue;
+    }
+    auto now = std::chrono::steady_clock::now();
+    auto next = now + std::chrono::seconds(60);
+    for ( auto r : sampler->receivers ) {
+      if (r->sampleDue <= now) {
+        sampleReceiveStats(r, &r->samples[r->sampleNext]);
+        r->sampleNext = (r->sampleNext + 1) % r->samples.size();
+        if (r->sampleCount < r->samples.size()) r->sampleCount++;
+        r->sampleDue += std::chrono::milliseconds(r->sampleInterval);
+        // Skip samples missed while NDI was slow to answer
+        if (r->sampleDue <= now) r->sampleDue = now + std::chrono::milliseconds(r->sampleInterval);
+      }
+      next = std::min(next, r->sampleDue);
+    }
+    sampler->cv.wait_until(lock, next);
+  }
+}
+
+// Called on any thread, before the receiver is destroyed
+void stopSampling(receiveInstance* r) {
+  std::lock_guard<std::mutex> lock(sampler->m);
+  if (r->sampleInterval == 0) return;
+  r->sampleInterval = 0;
+  sampler->receivers.erase(
+    std::remove(sampler->receivers.begin(), sampler->receivers.end(), r),
+    sampler->receivers.end());
+}
+
+receiveInstance* thisReceiver(napi_env env, napi_callback_info info,
+    size_t* argc, napi_value* args) {
+  napi_status status;
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, argc, args, &thisValue, nullptr);
+  CHECK_STATUS;
+
+  napi_value recvValue;
+  status = napi_get_named_property(env, thisValue, "embedded", &recvValue);
+  CHECK_STATUS;
+  void* recvData;
+  status = napi_get_value_external(env, recvValue, &recvData);
+  CHECK_STATUS;
+  return (receiveInstance*) recvData;
+}
+
+// receiver.stats() samples the receiver's statistics now.
+napi_value receiveStatsNow(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  receiveInstance* r = thisReceiver(env, info, nullptr, nullptr);
+  if (r == nullptr) return nullptr;
+
+  receiveStats s;
+  sampleReceiveStats(r, &s);
+  napi_value result;
+  status = makeReceiveStats(env, &s, &result);
+  CHECK_STATUS;
+  return result;
+}
+
+// receiver.sampleStats({ interval, size }) records the receiver's statistics
+// every interval ms, keeping the last size samples, 60 by default. Sampling
+// stops with an interval of zero. Recorded samples are dropped when the
+// interval or size changes.
+napi_value receiveSampleStats(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_valuetype type;
+
+  size_t argc = 1;
+  napi_value args[1];
+  receiveInstance* r = thisReceiver(env, info, &argc, args);
+  if (r == nullptr) return nullptr;
+  if (argc != 1)
+    NAPI_THROW_ERROR("Statistics sampling must be configured with an object.");
+  status = napi_typeof(env, args[0], &type);
+  CHECK_STATUS;
+  if (type != napi_object)
+    NAPI_THROW_ERROR("Statistics sampling must be configured with an object.");
+
+  uint32_t values[2] = { 0, 60 };
+  const char* names[2] = { "interval", "size" };
+  for ( int x = 0 ; x < 2 ; x++ ) {
+    napi_value param;
+    status = napi_get_named_property(env, args[0], names[x], &param);
+    CHECK_STATUS;
+    status = napi_typeof(env, param, &type);
+    CHECK_STATUS;
+    if (type == napi_number) {
+      status = napi_get_value_uint32(env, param, &values[x]);
+      CHECK_STATUS;
+    }
+    else if ((type != napi_undefined) || (x == 0))
+      NAPI_THROW_ERROR("Sampling interval must be a number, as must size if present.");
+  }
+  if (values[1] == 0)
+    NAPI_THROW_ERROR("Sampling size must be at least 1.");
+
+  stopSampling(r);
+  if (values[0] > 0) {
+    std::lock_guard<std::mutex> lock(sampler->m);
+    r->sampleInterval = values[0];
+    r->samples.assign(values[1], receiveStats());
+    r->sampleNext = 0;
+    r->sampleCount = 0;
+    r->sampleDue = std::chrono::steady_clock::now();
+    sampler->receivers.push_back(r);
+    if (!sampler->running) {
+      sampler->running = true;
+      std::thread(samplerThread).detach();
+    }
+    sampler->cv.notify_one();
+  }
+
+  napi_value undefined;
+  status = napi_get_undefined(env, &undefined);
+  CHECK_STATUS;
+  return undefined;
+}
+
+// receiver.statsHistory() returns the recorded samples, oldest first.
+napi_value receiveStatsHistory(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  receiveInstance* r = thisReceiver(env, info, nullptr, nullptr);
+  if (r == nullptr) return nullptr;
+
+  std::vector<receiveStats> history;
+  {
+    std::lock_guard<std::mutex> lock(sampler->m);
+    size_t size = r->samples.size();
+    for ( size_t x = 0 ; x < r->sampleCount ; x++ )
+      history.push_back(r->samples[(r->sampleNext + size - r->sampleCount + x) % size]);
+  }
+
+  napi_value result, sample;
+  status = napi_create_array_with_length(env, history.size(), &result);
+  CHECK_STATUS;
+  for ( size_t x = 0 ; x < history.size() ; x++ ) {
+    status = makeReceiveStats(env, &history[x], &sample);
+    CHECK_STATUS;
+    status = napi_set_element(env, result, (uint32_t) x, sample);
+    CHECK_STATUS;
+  }
+  return result;
+}
+
+// receiver.queues() reports, per type of frame, the depth of the queue, the
+// frames queued now and the counts received and dropped on overflow.
+napi_value receiveQueues(napi_env env, napi_callback_info info) {
+  napi_status status;
+  static const char* names[Grandiose_demux_max] = { "video", "audio", "metadata" };
+
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &thisValue, nullptr);
+  CHECK_STATUS;
+
+  napi_value recvValue;
+  status = napi_get_named_property(env, thisValue, "embedded", &recvValue);
+  CHECK_STATUS;
+  void* recvData;
+  status = napi_get_value_external(env, recvValue, &recvData);
+  CHECK_STATUS;
+  receiveInstance* r = (receiveInstance*) recvData;
+
+  napi_value result;
+  status = napi_create_object(env, &result);
+  CHECK_STATUS;
+  for ( int x = 0 ; x < Grandiose_demux_max ; x++ ) {
+    demuxQueue* q = &r->demux[x];
+    napi_value queue, param;
+    status = napi_create_object(env, &queue);
+    CHECK_STATUS;
+
+    status = napi_create_uint32(env, q->frames->depth, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, queue, "depth", param);
+    CHECK_STATUS;
+    status = napi_create_uint32(env, q->frames->size(), &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, queue, "queued", param);
+    CHECK_STATUS;
+    status = napi_create_double(env, (double) q->received.load(), &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, queue, "received", param);
+    CHECK_STATUS;
+    status = napi_create_double(env, (double) q->dropped.load(), &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, queue, "dropped", param);
+    CHECK_STATUS;
+
+    status = napi_set_named_property(env, result, names[x], queue);
+    CHECK_STATUS;
+  }
+
+  return result;
+}
+
+// receiver.usePool(n) keeps up to n buffers for captured video, which is then
+// copied into a recycled buffer instead of a new one. Zero turns pooling off.
+napi_value receiveUsePool(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_valuetype type;
+
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  CHECK_STATUS;
+  if (argc != 1)
+    NAPI_THROW_ERROR("Pool size must be a number.");
+  status = napi_typeof(env, args[0], &type);
+  CHECK_STATUS;
+  if (type != napi_number)
+    NAPI_THROW_ERROR("Pool size must be a number.");
+  uint32_t size;
+  status = napi_get_value_uint32(env, args[0], &size);
+  CHECK_STATUS;
+
+  napi_value recvValue;
+  status = napi_get_named_property(env, thisValue, "embedded", &recvValue);
+  CHECK_STATUS;
+  void* recvData;
+  status = napi_get_value_external(env, recvValue, &recvData);
+  CHECK_STATUS;
+  receiveInstance* r = (receiveInstance*) recvData;
+
+  r->poolSize = size;
+  uint32_t keep = (size > 0) ? size : 4;
+  {
+    std::lock_guard<std::mutex> lock(r->outputLock);
+    while (r->outputFree.size() > keep) {
+      outputBuffer* b = r->outputFree.back();
+      r->outputFree.pop_back();
+      freeFrameMemory(b->data, b->size, b->huge);
+      delete b;
+    }
+  }
+
+  napi_value undefined;
+  status = napi_get_undefined(env, &undefined);
+  CHECK_STATUS;
+  return undefined;
+}
+
+void countCaptureDrop(receiveInstance* r, NDIlib_frame_type_e type) {
+  switch (type) {
+    case NDIlib_frame_type_video:
+      r->captureDropped[Grandiose_demux_video]++;
+      break;
+    case NDIlib_frame_type_audio:
+      r->captureDropped[Grandiose_demux_audio]++;
+      break;
+    case NDIlib_frame_type_metadata:
+      r->captureDropped[Grandiose_demux_metadata]++;
+      break;
+    default:
+      break;
+  }
+}
+
+// Body of the per-receiver capture thread. Each frame is captured into its own
+// carrier, converted as required and handed to the main thread. Frames are
+// dropped rather than queued without bound when JavaScript falls behind.
+void captureLoop(receiveInstance* r) {
+  napi_status status = napi_ok;
+
+  while (r->capturing) {
+    dataCarrier* c = new dataCarrier;
+    c->instance = r;
+    retainReceive(r);
+    c->recv = r->recv;
+    c->zeroCopy = r->zeroCopy;
+    c->audioFormat = r->captureAudioFormat;
+    c->referenceLevel = r->captureReferenceLevel;
+
+    c->frameType = NDIlib_recv_capture_v2(c->recv, &c->videoFrame, &c->audioFrame,
+      &c->metadataFrame, r->captureWait);
+    switch (c->frameType) {
+      case NDIlib_frame_type_none:
+        delete c;
+        continue;
+      case NDIlib_frame_type_error:
+        // Connection lost, so back off rather than spin until it returns
+        delete c;
+        std::this_thread::sleep_for(std::chrono::milliseconds(r->captureWait));
+        continue;
+      case NDIlib_frame_type_audio:
+        convertAudioFrame(c);
+        break;
+      case NDIlib_frame_type_video:
+        if (!deliverVideo(r, c)) {
+          if (r->delivery == Grandiose_delivery_latest) countCaptureDrop(r, c->frameType);
+          freeCapturedFrame(c);
+          delete c;
+          continue;
+        }
+        convertVideoFrame(c);
+        if (c->status != GRANDIOSE_SUCCESS) {
+          delete c;
+          continue;
+        }
+        break;
+      default:
+        break;
+    }
+
+    status = napi_call_threadsafe_function(r->captureFn, c, napi_tsfn_nonblocking);
+    if (status != napi_ok) {
+      if (status == napi_queue_full) countCaptureDrop(r, c->frameType);
+      freeCapturedFrame(c);
+      delete c;
+      if (status != napi_queue_full) break;
+    }
+  }
+
+  if (status != napi_closing) {
+    napi_release_threadsafe_function(r->captureFn, napi_tsfn_release);
+  }
+}
+
+void captureCallJS(napi_env env, napi_value callback, void* context, void* data) {
+  dataCarrier* c = (dataCarrier*) data;
+  napi_status status;
+
+  if (env == nullptr) {
+    freeCapturedFrame(c);
+    delete c;
+    return;
+  }
+
+  napi_value frame, undefined, result;
+  status = makeDataFrame(env, c, &frame);
+  FLOATING_STATUS;
+  if (status == napi_ok) {
+    status = napi_get_undefined(env, &undefined);
+    FLOATING_STATUS;
+    status = napi_call_function(env, undefined, callback, 1, &frame, &result);
+    FLOATING_STATUS;
+  }
+
+  delete c;
+}
+
+void captureFinalize(napi_env env, void* data, void* hint) {
+  receiveInstance* r = (receiveInstance*) hint;
+  napi_status status;
+
+  r->capturing = false;
+  if (r->captureThread.joinable()) {
+    r->captureThread.join();
+  }
+  r->captureFn = nullptr;
+
+  if (r->captureStopped != nullptr) {
+    napi_value undefined;
+    status = napi_get_undefined(env, &undefined);
+    FLOATING_STATUS;
+    status = napi_resolve_deferred(env, r->captureStopped, undefined);
+    FLOATING_STATUS;
+    r->captureStopped = nullptr;
+  }
+
+  releaseReceive(r);
+}
+
+// receiver.start(callback, [options]) starts a native thread that captures
+// continuously from the receiver and calls back with each frame.
+napi_value captureStart(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_valuetype type;
+
+  size_t argc = 2;
+  napi_value args[2];
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  CHECK_STATUS;
+
+  napi_value recvValue;
+  status = napi_get_named_property(env, thisValue, "embedded", &recvValue);
+  CHECK_STATUS;
+  void* recvData;
+  status = napi_get_value_external(env, recvValue, &recvData);
+  CHECK_STATUS;
+  receiveInstance* r = (receiveInstance*) recvData;
+
+  if (r->captureFn != nullptr)
+    NAPI_THROW_ERROR("Receiver capture is already running.");
+  if (r->synced)
+    NAPI_THROW_ERROR("Video and audio are delivered by the frame synchronizer of this receiver.");
+  if (argc < 1)
+    NAPI_THROW_ERROR("Capture must be started with a callback function.");
+  status = napi_typeof(env, args[0], &type);
+  CHECK_STATUS;
+  if (type != napi_function)
+    NAPI_THROW_ERROR("Capture must be started with a callback function.");
+
+  uint32_t wait = 100;
+  uint32_t queue = 8;
+  Grandiose_audio_format_e audioFormat = Grandiose_audio_format_float_32_separate;
+  int32_t referenceLevel = 20;
+  if (argc >= 2) {
+    status = napi_typeof(env, args[1], &type);
+    CHECK_STATUS;
+    if (type == napi_object) {
+      napi_value param;
+      status = napi_get_named_property(env, args[1], "wait", &param);
+      CHECK_STATUS;
+      status = napi_typeof(env, param, &type);
+      CHECK_STATUS;
+      if (type == napi_number) {
+        status = napi_get_value_uint32(env, param, &wait);
+        CHECK_STATUS;
+      }
+      else if (type != napi_undefined)
+        NAPI_THROW_ERROR("Capture wait value must be a number if present.");
+
+      status = napi_get_named_property(env, args[1], "queue", &param);
+      CHECK_STATUS;
+      status = napi_typeof(env, param, &type);
+      CHECK_STATUS;
+      if (type == napi_number) {
+        status = napi_get_value_uint32(env, param, &queue);
+        CHECK_STATUS;
+        if (queue == 0)
+          NAPI_THROW_ERROR("Capture queue length must be at least 1.");
+      }
+      else if (type != napi_undefined)
+        NAPI_THROW_ERROR("Capture queue length must be a number if present.");
+
+      status = napi_get_named_property(env, args[1], "audioFormat", &param);
+      CHECK_STATUS;
+      status = napi_typeof(env, param, &type);
+      CHECK_STATUS;
+      if (type == napi_number) {
+        uint32_t audioFormatN;
+        status = napi_get_value_uint32(env, param, &audioFormatN);
+        CHECK_STATUS;
+        if (!validAudioFormat((Grandiose_audio_format_e) audioFormatN))
+          NAPI_THROW_ERROR("Invalid audio format specified.");
+        audioFormat = (Grandiose_audio_format_e) audioFormatN;
+      }
+      else if (type != napi_undefined)
+        NAPI_THROW_ERROR("Audio format value must be a number if present.");
+
+      status = napi_get_named_property(env, args[1], "referenceLevel", &param);
+      CHECK_STATUS;
+      status = napi_typeof(env, param, &type);
+      CHECK_STATUS;
+      if (type == napi_number) {
+        status = napi_get_value_int32(env, param, &referenceLevel);
+        CHECK_STATUS;
+      }
+      else if (type != napi_undefined)
+        NAPI_THROW_ERROR("Audio reference level must be a number if present.");
+    }
+    else if (type != napi_undefined)
+      NAPI_THROW_ERROR("Capture options must be an object if present.");
+  }
+
+  napi_value resource_name;
+  status = napi_create_string_utf8(env, "ReceiveCapture", NAPI_AUTO_LENGTH, &resource_name);
+  CHECK_STATUS;
+  status = napi_create_threadsafe_function(env, args[0], nullptr, resource_name,
+    queue, 1, nullptr, captureFinalize, r, captureCallJS, &r->captureFn);
+  CHECK_STATUS;
+
+  // Every frame now goes to the callback
+  stopDemux(r);
+  retainReceive(r);
+  r->captureWait = wait;
+  r->captureAudioFormat = audioFormat;
+  r->captureReferenceLevel = referenceLevel;
+  r->capturing = true;
+  r->captureThread = std::thread(captureLoop, r);
+
+  napi_value undefined;
+  status = napi_get_undefined(env, &undefined);
+  CHECK_STATUS;
+  return undefined;
+}
+
+// receiver.stop() ends continuous capture, resolving once the capture thread
+// has finished and every frame it captured has been delivered.
+napi_value captureStop(napi_env env, napi_callback_info info) {
+  carrier* c = new carrier;
+  napi_value promise;
+  c->status = napi_create_promise(env, &c->_deferred, &promise);
+  REJECT_RETURN;
+
+  size_t argc = 0;
+  napi_value thisValue;
+  c->status = napi_get_cb_info(env, info, &argc, nullptr, &thisValue, nullptr);
+  REJECT_RETURN;
+
+  napi_value recvValue;
+  c->status = napi_get_named_property(env, thisValue, "embedded", &recvValue);
+  REJECT_RETURN;
+  void* recvData;
+  c->status = napi_get_value_external(env, recvValue, &recvData);
+  REJECT_RETURN;
+  receiveInstance* r = (receiveInstance*) recvData;
+
+  if (r->captureFn == nullptr) {
+    napi_value undefined;
+    napi_get_undefined(env, &undefined);
+    napi_resolve_deferred(env, c->_deferred, undefined);
+  } else if (r->captureStopped != nullptr) {
+    REJECT_ERROR_RETURN(
+      "Receiver capture is already stopping.",
+      GRANDIOSE_INVALID_ARGS);
+  } else {
+    r->captureStopped = c->_deferred;
+    r->capturing = false;
+  }
+
+  delete c;
+  return promise;
+}
+
+// A receiver offered with transfer() that was never adopted drops the
+// token's reference
+void cancelReceiveTransfer(carrier* c) {
+  delete c;
+}
+
+// receiver.transfer() hands the NDI receiver on to grandiose.adopt() in this
+// or any other thread, returning the token to adopt it with. This receiver
+// object can no longer be used, though frames it has already returned stay
+// valid until they are released or collected.
+napi_value receiveTransfer(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_valuetype type;
+
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &thisValue, nullptr);
+  CHECK_STATUS;
+
+  napi_value recvValue;
+  status = napi_get_named_property(env, thisValue, "embedded", &recvValue);
+  CHECK_STATUS;
+  status = napi_typeof(env, recvValue, &type);
+  CHECK_STATUS;
+  if (type != napi_external)
+    NAPI_THROW_ERROR("Receiver has already been transferred.");
+  void* recvData;
+  status = napi_get_value_external(env, recvValue, &recvData);
+  CHECK_STATUS;
+  receiveInstance* r = (receiveInstance*) recvData;
+
+  if (r->captureFn != nullptr)
+    NAPI_THROW_ERROR("Capture must be stopped before a receiver is transferred.");
+  if (r->synced)
+    NAPI_THROW_ERROR("Frame synchronizer must be destroyed before a receiver is transferred.");
+
+  // The adopting object reports the same properties as this one
+  napi_value param;
+  int32_t colorFormat, bandwidth;
+  bool allowVideoFields;
+  status = napi_get_named_property(env, thisValue, "colorFormat", &param);
+  CHECK_STATUS;
+  status = napi_get_value_int32(env, param, &colorFormat);
+  CHECK_STATUS;
+  status = napi_get_named_property(env, thisValue, "bandwidth", &param);
+  CHECK_STATUS;
+  status = napi_get_value_int32(env, param, &bandwidth);
+  CHECK_STATUS;
+  status = napi_get_named_property(env, thisValue, "allowVideoFields", &param);
+  CHECK_STATUS;
+  status = napi_get_value_bool(env, param, &allowVideoFields);
+  CHECK_STATUS;
+
+  napi_value source, name;
+  status = napi_get_named_property(env, thisValue, "source", &source);
+  CHECK_STATUS;
+  status = napi_typeof(env, source, &type);
+  CHECK_STATUS;
+  if (type != napi_object)
+    NAPI_THROW_ERROR("Receiver source property must be an object.");
+  status = napi_get_named_property(env, thisValue, "name", &name);
+  CHECK_STATUS;
+  status = napi_typeof(env, name, &type);
+  CHECK_STATUS;
+
+  receiveCarrier* t = new receiveCarrier;
+  t->source = new NDIlib_source_t();
+  status = makeNativeSource(env, source, t->source);
+  if ((status == napi_ok) && (type == napi_string)) {
+    size_t namel;
+    status = napi_get_value_string_utf8(env, name, nullptr, 0, &namel);
+    if (status == napi_ok) {
+      t->name = (char *) malloc(namel + 1);
+      status = napi_get_value_string_utf8(env, name, t->name, namel + 1, &namel);
+    }
+  }
+  if (status == napi_ok) {
+    napi_value value;
+    status = napi_create_int32(env, 0, &value);
+    if (status == napi_ok)
+      status = napi_set_named_property(env, thisValue, "embedded", value);
+  }
+  if (status != napi_ok) delete t;
+  CHECK_STATUS;
+
+  t->colorFormat = (NDIlib_recv_color_format_e) colorFormat;
+  t->bandwidth = (NDIlib_recv_bandwidth_e) bandwidth;
+  t->allowVideoFields = allowVideoFields;
+  t->zeroCopy = r->zeroCopy;
+  t->outputFormat = r->outputFormat;
+  t->colorMatrix = r->colorMatrix;
+  t->fullRange = r->fullRange;
+  t->queueDepth = r->demux[Grandiose_demux_video].frames->depth;
+  t->recv = r->recv;
+  // Held by the token, as this object's reference goes when it is collected
+  retainReceive(r);
+  t->instance = r;
+  std::string token = offerTransfer(env, t, "receiver", cancelReceiveTransfer);
+
+  napi_value result;
+  status = napi_create_string_utf8(env, token.c_str(), NAPI_AUTO_LENGTH, &result);
+  CHECK_STATUS;
+  return result;
+}
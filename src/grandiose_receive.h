@@ -16,24 +16,169 @@
 #ifndef GRANDIOSE_RECEIVE_H
 #define GRANDIOSE_RECEIVE_H
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "node_api.h"
 #include "grandiose_util.h"
+#include "grandiose_ring.h"
+#include "grandiose_convert.h"
 
 napi_value receive(napi_env env, napi_callback_info info);
 napi_value videoReceive(napi_env env, napi_callback_info info);
 napi_value audioReceive(napi_env env, napi_callback_info info);
 napi_value metadataReceive(napi_env env, napi_callback_info info);
 napi_value dataReceive(napi_env env, napi_callback_info info);
+napi_value captureStart(napi_env env, napi_callback_info info);
+napi_value captureStop(napi_env env, napi_callback_info info);
+napi_value receiveTransfer(napi_env env, napi_callback_info info);
+napi_value receiveQueues(napi_env env, napi_callback_info info);
+napi_value receiveUsePool(napi_env env, napi_callback_info info);
+napi_value receiveStatsNow(napi_env env, napi_callback_info info);
+napi_value receiveSampleStats(napi_env env, napi_callback_info info);
+napi_value receiveStatsHistory(napi_env env, napi_callback_info info);
+void receiveComplete(napi_env env, napi_status asyncStatus, void* data);
+
+struct receiveInstance;
+struct dataCarrier;
+
+typedef enum Grandiose_demux_e {
+  Grandiose_demux_video = 0,
+  Grandiose_demux_audio = 1,
+  Grandiose_demux_metadata = 2,
+  Grandiose_demux_max = 3
+} Grandiose_demux_e;
+
+// How captured video is passed on, set with the delivery option: every
+// frame, only the newest, one in every N or at most a number per second
+typedef enum Grandiose_delivery_e {
+  Grandiose_delivery_all = 0,
+  Grandiose_delivery_latest = 1,
+  Grandiose_delivery_every = 2,
+  Grandiose_delivery_max_fps = 3
+} Grandiose_delivery_e;
+
+// Frames of one type captured by a receiver's demultiplexing thread, waiting
+// for video(), audio() or metadata(). When full, the oldest frame is dropped.
+struct demuxQueue {
+  frameRing<dataCarrier>* frames = nullptr;
+  std::atomic<uint64_t> received { 0 };
+  std::atomic<uint64_t> dropped { 0 };
+};
+
+// One sample of a receiver's statistics, per type of frame where indexed by
+// Grandiose_demux_e. Total, dropped and queued are NDI's own counts. Pending
+// frames wait in the receiver's queues for JavaScript, and discarded ones
+// were dropped by the receiver because JavaScript fell behind.
+struct receiveStats {
+  double time;
+  int32_t connections;
+  int64_t total[Grandiose_demux_max];
+  int64_t dropped[Grandiose_demux_max];
+  int32_t queued[Grandiose_demux_max];
+  uint32_t pending[Grandiose_demux_max];
+  uint64_t discarded[Grandiose_demux_max];
+};
+
+// Memory for a video frame converted to the receiver's output format, or
+// copied from NDI when the receiver has a buffer pool
+struct outputBuffer {
+  receiveInstance* instance;
+  uint8_t* data;
+  size_t size;
+  bool huge;
+};
+
+// Native receiver shared by the JS receiver object and by any frames that
+// still reference memory owned by the NDI receiver.
+struct receiveInstance {
+  NDIlib_recv_instance_t recv = nullptr;
+  bool zeroCopy = false;
+  std::atomic<int32_t> refs { 1 };
+  // Continuous capture started with receiver.start()
+  std::thread captureThread;
+  std::atomic<bool> capturing { false };
+  napi_threadsafe_function captureFn = nullptr;
+  napi_deferred captureStopped = nullptr;
+  uint32_t captureWait = 100;
+  Grandiose_audio_format_e captureAudioFormat = Grandiose_audio_format_float_32_separate;
+  int32_t captureReferenceLevel = 20;
+  // Frames not passed to the callback because its queue was full, per type
+  std::atomic<uint64_t> captureDropped[Grandiose_demux_max] { {0}, {0}, {0} };
+  // Demultiplexer started by the first video(), audio() or metadata() call.
+  // Its thread captures every type of frame into the queue for its type, so
+  // that concurrent calls for different types do not discard each other's
+  // frames. Frames in the queues hold no reference on the receiver, which
+  // stops the thread once it is released for the last time.
+  std::thread demuxThread;
+  std::atomic<bool> demuxing { false };
+  std::mutex demuxLock;
+  std::condition_variable demuxReady;
+  uint32_t demuxWait = 100;
+  demuxQueue demux[Grandiose_demux_max];
+  // Set while a frame synchronizer from frameSync() takes video and audio
+  std::atomic<bool> synced { false };
+  // Video delivery policy, applied by the demultiplexing and capture threads
+  // before a frame is converted or copied. Its state is used only by the one
+  // of those threads that is running.
+  Grandiose_delivery_e delivery = Grandiose_delivery_all;
+  uint32_t deliveryEvery = 1;
+  double deliveryMaxFps = 0.0;
+  uint64_t deliveryCount = 0;
+  std::chrono::steady_clock::time_point deliveryDue;
+  // Conversion of captured video set with the outputFormat option
+  NDIlib_FourCC_video_type_e outputFormat = (NDIlib_FourCC_video_type_e) 0;
+  Grandiose_color_matrix_e colorMatrix = Grandiose_color_matrix_auto;
+  bool fullRange = false;
+  // Output buffers not in use, returned by release() or when their Buffer is
+  // collected. With a pool set by usePool(n), up to n are kept and captured
+  // video is copied into them rather than into new Buffers.
+  std::mutex outputLock;
+  std::vector<outputBuffer*> outputFree;
+  std::atomic<uint32_t> poolSize { 0 };
+  // Statistics recorded every sampleInterval ms by the shared sampler thread
+  // into a ring, guarded by the sampler's lock
+  uint32_t sampleInterval = 0;
+  std::vector<receiveStats> samples;
+  size_t sampleNext = 0;
+  size_t sampleCount = 0;
+  std::chrono::steady_clock::time_point sampleDue;
+  receiveInstance();
+  ~receiveInstance();
+};
+
+void retainReceive(receiveInstance* r);
+void releaseReceive(receiveInstance* r);
+void returnOutputBuffer(outputBuffer* b);
+void startDemux(receiveInstance* r, carrier* c, Grandiose_demux_e type);
+void stopDemux(receiveInstance* r);
+void stopSampling(receiveInstance* r);
+dataCarrier* takeDemuxed(receiveInstance* r, Grandiose_demux_e type, uint32_t wait);
+dataCarrier* takeAnyDemuxed(receiveInstance* r, uint32_t wait);
 
 struct receiveCarrier : carrier {
   NDIlib_source_t* source = nullptr;
   NDIlib_recv_color_format_e colorFormat = NDIlib_recv_color_format_fastest;
   NDIlib_recv_bandwidth_e bandwidth = NDIlib_recv_bandwidth_highest;
   bool allowVideoFields = true;
+  bool zeroCopy = false;
+  NDIlib_FourCC_video_type_e outputFormat = (NDIlib_FourCC_video_type_e) 0;
+  Grandiose_color_matrix_e colorMatrix = Grandiose_color_matrix_auto;
+  bool fullRange = false;
   char* name = nullptr;
+  uint32_t queueDepth = 8;
+  Grandiose_delivery_e delivery = Grandiose_delivery_all;
+  uint32_t deliveryEvery = 1;
+  double deliveryMaxFps = 0.0;
   NDIlib_recv_instance_t recv;
+  // Receiver handed on by transfer(), adopted in place of a new one
+  receiveInstance* instance = nullptr;
   ~receiveCarrier() {
     free(name);
+    if (instance != nullptr) releaseReceive(instance);
     if (source != nullptr) {
       delete source;
     }
@@ -42,7 +187,9 @@ struct receiveCarrier : carrier {
 
 struct dataCarrier : carrier {
   uint32_t wait = 10000;
+  receiveInstance* instance = nullptr;
   NDIlib_recv_instance_t recv;
+  bool zeroCopy = false;
   NDIlib_frame_type_e frameType;
   NDIlib_video_frame_v2_t videoFrame;
   NDIlib_audio_frame_v2_t audioFrame;
@@ -51,10 +198,33 @@ struct dataCarrier : carrier {
   int32_t referenceLevel = 20;
   Grandiose_audio_format_e audioFormat = Grandiose_audio_format_float_32_separate;
   NDIlib_metadata_frame_t metadataFrame;
+  // Video converted to the receiver's output format, until passed to JS
+  outputBuffer* output = nullptr;
+  int32_t outputStride = 0;
+  int32_t outputFourCC = 0;
+  // Set when the frame came from a frame synchronizer rather than the receiver
+  NDIlib_framesync_instance_t sync = nullptr;
+  // Memory of a Buffer passed with the into option, referenced by passthru
+  uint8_t* intoData = nullptr;
+  size_t intoSize = 0;
+  size_t intoUsed = 0;
   ~dataCarrier() {
     delete[] audioFrame16s.p_data;
     delete[] audioFrame32fIlvd.p_data;
+    if (instance != nullptr) {
+      returnOutputBuffer(output);
+      releaseReceive(instance);
+    }
   }
 };
 
+// Shared with the frame synchronizer, which builds frames in the same way
+void freeVideoFrame(dataCarrier* c);
+void freeAudioFrame(dataCarrier* c);
+void readIntoOption(napi_env env, napi_value config, dataCarrier* c);
+void convertVideoFrame(dataCarrier* c);
+void convertAudioFrame(dataCarrier* c);
+napi_status makeVideoFrame(napi_env env, dataCarrier* c, napi_value* frame);
+napi_status makeAudioFrame(napi_env env, dataCarrier* c, napi_value* frame);
+
 #endif /* GRANDIOSE_RECEIVE_H */
@@ -0,0 +1,85 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef GRANDIOSE_RING_H
+#define GRANDIOSE_RING_H
+
+#include <atomic>
+#include <cstdint>
+
+// Bounded lock-free queue of pointers with a single producer and a single
+// consumer. The producer may also remove the oldest entry to make room, so
+// both sides claim entries by advancing head with compare-and-swap. Indices
+// only ever increase, so a claimed slot cannot be mistaken for a later one.
+template <typename T>
+class frameRing {
+public:
+  explicit frameRing(uint32_t depth) : depth(depth), slots(new std::atomic<T*>[depth]) {
+    for ( uint32_t x = 0 ; x < depth ; x++ ) slots[x].store(nullptr);
+  }
+  ~frameRing() { delete[] slots; }
+  frameRing(const frameRing&) = delete;
+  frameRing& operator=(const frameRing&) = delete;
+
+  // Producer only. Returns false if the queue is full.
+  bool push(T* item) {
+    uint64_t t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) >= depth) return false;
+    slots[t % depth].store(item, std::memory_order_relaxed);
+    tail.store(t + 1, std::memory_order_seq_cst);
+    return true;
+  }
+
+  // Consumer, or producer to steal the oldest entry. Returns nullptr if empty.
+  T* pop() {
+    uint64_t h = head.load(std::memory_order_acquire);
+    while (h != tail.load(std::memory_order_acquire)) {
+      T* item = slots[h % depth].load(std::memory_order_relaxed);
+      if (head.compare_exchange_weak(h, h + 1, std::memory_order_acq_rel))
+        return item;
+    }
+    return nullptr;
+  }
+
+  // Producer only. Removes the oldest entry if it satisfies the predicate.
+  // Safe because the slot at head cannot be reused until head advances.
+  template <typename P>
+  T* popIf(P predicate) {
+    uint64_t h = head.load(std::memory_order_acquire);
+    while (h != tail.load(std::memory_order_acquire)) {
+      T* item = slots[h % depth].load(std::memory_order_relaxed);
+      if (!predicate(item)) return nullptr;
+      if (head.compare_exchange_weak(h, h + 1, std::memory_order_acq_rel))
+        return item;
+    }
+    return nullptr;
+  }
+
+  uint32_t size() const {
+    uint64_t h = head.load(std::memory_order_acquire);
+    return (uint32_t) (tail.load(std::memory_order_acquire) - h);
+  }
+
+  bool empty() const { return size() == 0; }
+
+  const uint32_t depth;
+
+private:
+  std::atomic<T*>* slots;
+  std::atomic<uint64_t> head { 0 };
+  std::atomic<uint64_t> tail { 0 };
+};
+
+#endif /* GRANDIOSE_RING_H */
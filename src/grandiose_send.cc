@@ -14,6 +14,8 @@
 */
 
 #include <string>
+#include <algorithm>
+#include <cstring>
 #include <Processing.NDI.Lib.h>
 
 #ifdef _WIN32
@@ -26,9 +28,26 @@
 
 #include "grandiose_send.h"
 #include "grandiose_util.h"
+#include "grandiose_pool.h"
+#include "grandiose_playout.h"
 
 napi_value videoSend(napi_env env, napi_callback_info info);
 napi_value audioSend(napi_env env, napi_callback_info info);
+napi_value metadataSend(napi_env env, napi_callback_info info);
+napi_value videoFlush(napi_env env, napi_callback_info info);
+napi_value configureVideo(napi_env env, napi_callback_info info);
+napi_value configureAudio(napi_env env, napi_callback_info info);
+napi_value audioDataSend(napi_env env, napi_callback_info info);
+napi_value videoDataSend(napi_env env, napi_callback_info info);
+napi_value sendStats(napi_env env, napi_callback_info info);
+napi_value allocateFrames(napi_env env, napi_callback_info info);
+napi_value acquireFrame(napi_env env, napi_callback_info info);
+napi_value framePool(napi_env env, napi_callback_info info);
+napi_value monitorStart(napi_env env, napi_callback_info info);
+napi_value monitorStop(napi_env env, napi_callback_info info);
+napi_value metadataCapture(napi_env env, napi_callback_info info);
+napi_value metadataCaptureStart(napi_env env, napi_callback_info info);
+napi_value metadataCaptureStop(napi_env env, napi_callback_info info);
 napi_value connections(napi_env env, napi_callback_info info);
 napi_value tally(napi_env env, napi_callback_info info);
 napi_value sourcename(napi_env env, napi_callback_info info);
@@ -50,31 +69,346 @@ void sendExecute(napi_env env, void* data) {
   }
 }
 
-/*  implicit destruction of NDI sender via garbage collection  */
-void finalizeSend(napi_env env, void* data, void* hint) {
-    /*  fetch NDI sender wrapper object  */
-    napi_value obj = (napi_value)hint;
+void retainSend(sendInstance* s) {
+  s->refs++;
+}
 
-    /*  fetch NDI sender external object  */
-    napi_value sendValue;
-    if (napi_get_named_property(env, obj, "embedded", &sendValue) != napi_ok)
-        return;
+// A sender offered with transfer() that was never adopted
+void cancelSendTransfer(carrier* c) {
+  NDIlib_send_destroy(((sendCarrier*) c)->send);
+  delete c;
+}
 
-    /*  ensure it was still not manually destroyed  */
-    napi_valuetype result;
-    if (napi_typeof(env, sendValue, &result) != napi_ok)
-        return;
-    if (result != napi_external)
-        return;
+void closeSend(sendInstance* s) {
+  std::string token;
+  if (s->send != nullptr) {
+    if (s->transfer != nullptr) {
+      ((sendCarrier*) s->transfer)->send = s->send;
+      token = offerTransfer(s->env, s->transfer, "sender", cancelSendTransfer);
+      s->transfer = nullptr;
+    }
+    else
+      NDIlib_send_destroy(s->send);
+    s->send = nullptr;
+  }
+  if (s->asyncBufferRef != nullptr) {
+    napi_delete_reference(s->env, s->asyncBufferRef);
+    s->asyncBufferRef = nullptr;
+  }
+  s->asyncFrame = nullptr;
+  free(s->asyncMetadata);
+  s->asyncMetadata = nullptr;
+  // Pool memory is freed as each Buffer is collected
+  for ( auto f : s->pool ) {
+    napi_delete_reference(s->env, f->bufferRef);
+    f->bufferRef = nullptr;
+  }
+  s->pool.clear();
+  if (s->destroyedDeferred != nullptr) {
+    napi_value result;
+    if (token.empty())
+      napi_get_undefined(s->env, &result);
+    else
+      napi_create_string_utf8(s->env, token.c_str(), NAPI_AUTO_LENGTH, &result);
+    napi_resolve_deferred(s->env, s->destroyedDeferred, result);
+    s->destroyedDeferred = nullptr;
+  }
+}
+
+// Called on the main thread. Once destroy() has been called, the NDI sender
+// is closed as soon as only the JS object's reference remains.
+void releaseSend(sendInstance* s) {
+  int32_t refs = --s->refs;
+  if (refs == 0) {
+    closeSend(s);
+    delete s;
+  }
+  else if ((refs == 1) && s->external && s->destroyed)
+    closeSend(s);
+}
+
+// Called on the main thread when a send no longer needs a pool frame
+void recycleFrame(poolFrame* f) {
+  if (f == nullptr) return;
+  if (--f->inFlight == 0) f->acquired = false;
+}
+
+napi_status getSendInstance(napi_env env, napi_value thisValue, sendInstance** s) {
+  napi_status status;
+  napi_value sendValue;
+  status = napi_get_named_property(env, thisValue, "embedded", &sendValue);
+  PASS_STATUS;
+  void* sendData;
+  status = napi_get_value_external(env, sendValue, &sendData);
+  PASS_STATUS;
+  *s = (sendInstance*) sendData;
+  return napi_ok;
+}
+
+void wakeSendThread(sendInstance* s) {
+  if (s->sleeping) {
+    std::lock_guard<std::mutex> lock(s->wakeLock);
+    s->wake.notify_one();
+  }
+}
+
+// Sender's thread. Time of the given number of frames of the held frame.
+std::chrono::steady_clock::duration holdFrames(sendInstance* s, double frames) {
+  return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    std::chrono::duration<double>(frames * s->heldFrame.frame_rate_D / s->heldFrame.frame_rate_N));
+}
+
+// Sender's thread. Keeps the video frame just sent, to be repeated if the
+// next one is late. A frame is late half a frame after it was due.
+void holdVideo(sendInstance* s, const sendDataCarrier* c, bool converted) {
+  const NDIlib_video_frame_v2_t* frame = &c->videoFrame;
+  s->holding = false;
+  if ((frame->frame_rate_N <= 0) || (frame->frame_rate_D <= 0)) return;
+  s->heldFrame = *frame;
+  s->heldFrame.timecode = NDIlib_send_timecode_synthesize;
+  s->heldFrame.timestamp = 0;
+  s->heldFrame.p_metadata = nullptr;
+  if (!converted) {
+    size_t size = videoFrameBytes(frame->FourCC, frame->xres, frame->yres,
+      frame->line_stride_in_bytes);
+    if (size == 0) return;
+    // The last line of a region can end with the buffer, short of its stride
+    if (c->region.set)
+      size -= (size_t) (frame->line_stride_in_bytes - defaultLineStride(frame->FourCC, frame->xres));
+    if (size > s->holdSize) {
+      if (s->holdData != nullptr) freeFrameMemory(s->holdData, s->holdSize, s->holdHuge);
+      s->holdData = (uint8_t*) allocateFrameMemory(size, false, &s->holdHuge);
+      s->holdSize = (s->holdData != nullptr) ? size : 0;
+      if (s->holdData == nullptr) return;
+    }
+    memcpy(s->holdData, frame->p_data, size);
+    s->heldFrame.p_data = s->holdData;
+  }
+  s->holding = true;
+  s->holdCadence = 0;
+  s->holdAudioSent = false;
+  s->holdDue = std::chrono::steady_clock::now() + holdFrames(s, 1.5);
+}
+
+// Sender's thread. Sends the held frame again, with the audio that spans it:
+// muxed audio if configured, or otherwise silence in the format of the last
+// audio sent, unless audio has been sent since the last frame.
+void repeatHeldFrame(sendInstance* s) {
+  // Each run of repeats is counted as one stall
+  if (s->holdCadence == 0) s->stalls++;
+  s->repeated++;
+  NDIlib_audio_frame_v3_t audioFrame;
+  if (s->mux.take(s->heldFrame.frame_rate_N, s->heldFrame.frame_rate_D,
+      NDIlib_send_timecode_synthesize, &audioFrame)) {
+    NDIlib_send_send_audio_v3(s->send, &audioFrame);
+  } else if (!s->holdAudioSent && (s->holdChannels > 0)) {
+    uint64_t frame = s->holdCadence % (uint64_t) s->heldFrame.frame_rate_N;
+    uint32_t samples = (uint32_t) (
+      cadenceStart(frame + 1, s->holdSampleRate, s->heldFrame.frame_rate_N, s->heldFrame.frame_rate_D) -
+      cadenceStart(frame, s->holdSampleRate, s->heldFrame.frame_rate_N, s->heldFrame.frame_rate_D));
+    s->holdSilence.assign((size_t) samples * s->holdChannels, 0.0f);
+    audioFrame.sample_rate = s->holdSampleRate;
+    audioFrame.no_channels = s->holdChannels;
+    audioFrame.no_samples = (int) samples;
+    audioFrame.timecode = NDIlib_send_timecode_synthesize;
+    audioFrame.FourCC = NDIlib_FourCC_audio_type_FLTP;
+    audioFrame.p_data = (uint8_t*) s->holdSilence.data();
+    audioFrame.channel_stride_in_bytes = (int) (samples * sizeof(float));
+    audioFrame.p_metadata = nullptr;
+    audioFrame.timestamp = 0;
+    NDIlib_send_send_audio_v3(s->send, &audioFrame);
+  }
+  s->holdCadence++;
+  s->holdAudioSent = false;
+
+  // Sent synchronously, as the next frame may be copied over the held one
+  NDIlib_send_send_video_v2(s->send, &s->heldFrame);
+  s->holdDue += holdFrames(s, 1.0);
+}
+
+void sendLoop(sendInstance* s) {
+  napi_status status = napi_ok;
+  while (true) {
+    sendDataCarrier* c = s->queue->pop();
+    if (c == nullptr) {
+      if (s->stopping) break;
+      // File playout sends frames of its own
+      if (s->holdSuspended) s->holding = false;
+      if (s->holding && (std::chrono::steady_clock::now() >= s->holdDue)) {
+        repeatHeldFrame(s);
+        continue;
+      }
+      // Producer publishes before checking sleeping, so one side sees the other
+      s->sleeping = true;
+      std::unique_lock<std::mutex> lock(s->wakeLock);
+      auto ready = [s] { return !s->queue->empty() || s->stopping; };
+      if (s->holding) s->wake.wait_until(lock, s->holdDue, ready);
+      else s->wake.wait(lock, ready);
+      s->sleeping = false;
+      continue;
+    }
+
+    c->execute(s->env, c);
+    if (c->droppable) s->sent++;
+
+    status = napi_call_threadsafe_function(s->completeFn, c, napi_tsfn_blocking);
+    if (status != napi_ok) break;
+  }
+  if ((status != napi_closing) && !s->closing) {
+    status = napi_release_threadsafe_function(s->completeFn, napi_tsfn_release);
+    FLOATING_STATUS;
+  }
+}
+
+// Main thread. Balances the count taken in queueSendWork, so that an idle
+// sender does not keep the event loop alive.
+void settleSendWork(napi_env env, sendInstance* s) {
+  napi_status status;
+  if ((--s->outstanding == 0) && (s->completeFn != nullptr)) {
+    status = napi_unref_threadsafe_function(env, s->completeFn);
+    FLOATING_STATUS;
+  }
+}
+
+void settleGroupPart(napi_env env, sendGroupCarrier* c, sendDataCarrier* part, bool dropped);
+void videoSendExecute(napi_env env, void* data);
+
+napi_status dropSendWork(napi_env env, sendDataCarrier* c) {
+  napi_status status;
+  sendInstance* s = c->instance;
+  if (c->droppable) s->dropped++;
+  // The frame's audio goes with the next video frame
+  if (c->execute == videoSendExecute) s->mux.skip();
+
+  if (c->group != nullptr) {
+    settleGroupPart(env, c->group, c, true);
+  } else {
+    napi_value result, param;
+    status = napi_create_object(env, &result);
+    PASS_STATUS;
+    status = napi_get_boolean(env, true, &param);
+    PASS_STATUS;
+    status = napi_set_named_property(env, result, "dropped", param);
+    PASS_STATUS;
+    status = napi_resolve_deferred(env, c->_deferred, result);
+    PASS_STATUS;
+  }
+
+  retainSend(s);
+  tidyCarrier(env, c);
+  settleSendWork(env, s);
+  releaseSend(s);
+  return napi_ok;
+}
+
+void admitWaiting(sendInstance* s) {
+  bool admitted = false;
+  while (!s->waiting.empty() && s->queue->push(s->waiting.front())) {
+    s->waiting.pop_front();
+    admitted = true;
+  }
+  if (admitted) wakeSendThread(s);
+}
+
+// Main thread. Queues work for the sender's thread, applying the sender's
+// overflow policy to droppable frames when the queue is full.
+napi_status queueSendWork(napi_env env, sendDataCarrier* c,
+    napi_async_execute_callback execute, napi_async_complete_callback complete) {
+  napi_status status;
+  sendInstance* s = c->instance;
+  c->execute = execute;
+  c->complete = complete;
+
+  if (c->droppable) s->submitted++;
+  if (s->outstanding++ == 0) {
+    status = napi_ref_threadsafe_function(env, s->completeFn);
+    PASS_STATUS;
+  }
 
-    /*  fetch NDI sender native object  */
-    void *sendData;
-    if (napi_get_value_external(env, sendValue, &sendData) != napi_ok)
-        return;
-    NDIlib_send_instance_t send = (NDIlib_send_instance_t)sendData;
+  if (s->waiting.empty() && s->queue->push(c)) {
+    wakeSendThread(s);
+    return napi_ok;
+  }
+
+  if (c->droppable && (s->overflow == Grandiose_overflow_drop_newest))
+    return dropSendWork(env, c);
+
+  if (c->droppable && (s->overflow == Grandiose_overflow_drop_oldest)) {
+    auto isDroppable = [](sendDataCarrier* o) { return o->droppable; };
+    sendDataCarrier* oldest = s->queue->popIf(isDroppable);
+    if (oldest == nullptr) {
+      auto it = std::find_if(s->waiting.begin(), s->waiting.end(), isDroppable);
+      if (it != s->waiting.end()) {
+        oldest = *it;
+        s->waiting.erase(it);
+      }
+    }
+    if (oldest != nullptr) {
+      status = dropSendWork(env, oldest);
+      PASS_STATUS;
+    }
+  }
+
+  // Blocking only ever delays the promise, never the JavaScript thread
+  s->waiting.push_back(c);
+  admitWaiting(s);
+  return napi_ok;
+}
+
+void sendCallJS(napi_env env, napi_value callback, void* context, void* data) {
+  sendDataCarrier* c = (sendDataCarrier*) data;
+  sendInstance* s = (sendInstance*) context;
+
+  // Carriers left at environment teardown are abandoned with the environment
+  if (env == nullptr) return;
+
+  c->complete(env, napi_ok, c);
+  if (!s->stopping) admitWaiting(s);
+  settleSendWork(env, s);
+}
+
+void sendThreadFinalize(napi_env env, void* data, void* hint) {
+  sendInstance* s = (sendInstance*) data;
+  s->closing = true;
+  s->stopping = true;
+  {
+    std::lock_guard<std::mutex> lock(s->wakeLock);
+    s->wake.notify_one();
+  }
+  if (s->sendThread.joinable()) s->sendThread.join();
+  s->completeFn = nullptr;
+  releaseSend(s);
+}
+
+// Main thread. Frames already queued are still sent, waiting ones dropped.
+void stopSendThread(napi_env env, sendInstance* s) {
+  napi_status status;
+  if (s->stopping) return;
+  s->stopping = true;
+  // Keeps the event loop alive until the thread has finished
+  if (s->completeFn != nullptr) {
+    status = napi_ref_threadsafe_function(env, s->completeFn);
+    FLOATING_STATUS;
+  }
+  while (!s->waiting.empty()) {
+    sendDataCarrier* c = s->waiting.front();
+    s->waiting.pop_front();
+    status = dropSendWork(env, c);
+    FLOATING_STATUS;
+  }
+  std::lock_guard<std::mutex> lock(s->wakeLock);
+  s->wake.notify_one();
+}
 
-    /*  call the NDI API  */
-    NDIlib_send_destroy(send);
+/*  implicit destruction of NDI sender via garbage collection  */
+void finalizeSend(napi_env env, void* data, void* hint) {
+    sendInstance* s = (sendInstance*) data;
+    s->external = false;
+    s->monitoring = false;
+    s->capturingMetadata = false;
+    stopPlayout(s);
+    stopSendThread(env, s);
+    releaseSend(s);
 }
 
 /*  explicit destruction of NDI sender via "destroy" method  */
@@ -106,27 +440,116 @@ napi_value destroySend(napi_env env, napi_callback_info info) {
         void *sendData;
         c->status = napi_get_value_external(env, sendValue, &sendData);
         REJECT_RETURN;
-        NDIlib_send_instance_t send = (NDIlib_send_instance_t)sendData;
-
-        /*  call the NDI API  */
-        NDIlib_send_destroy(send);
+        sendInstance* s = (sendInstance*) sendData;
 
         /*  overwrite the "embedded" field with a non-external value
-            (to ensure that the "finalizeSend" will no longer do anything
-            once the garbage collection fires)  */
+            (to ensure that no further sends can be made with it)  */
         napi_value value;
         napi_create_int32(env, 0, &value);
         c->status = napi_set_named_property(env, thisValue, "embedded", value);
         REJECT_RETURN;
+
+        /*  destroy the NDI sender, resolving once frames already queued
+            have been sent  */
+        s->destroyed = true;
+        s->destroyedDeferred = c->_deferred;
+        c->_deferred = nullptr;
+        tidyCarrier(env, c);
+        s->monitoring = false;
+        s->capturingMetadata = false;
+        stopPlayout(s);
+        stopSendThread(env, s);
+        if (s->refs == 1)
+            closeSend(s);
+        return promise;
     }
 
     napi_value undefined;
     napi_get_undefined(env, &undefined);
     napi_resolve_deferred(env, c->_deferred, undefined);
+    tidyCarrier(env, c);
 
     return promise;
 }
 
+// sender.transfer() closes this sender object as destroy() does, but hands
+// the NDI sender on rather than destroying it. Resolves, once frames already
+// queued have been sent, with a token for grandiose.adopt() in any thread.
+napi_value transferSend(napi_env env, napi_callback_info info) {
+  napi_valuetype type;
+  carrier* c = new carrier;
+  napi_value promise;
+  c->status = napi_create_promise(env, &c->_deferred, &promise);
+  REJECT_RETURN;
+
+  napi_value thisValue;
+  c->status = napi_get_cb_info(env, info, nullptr, nullptr, &thisValue, nullptr);
+  REJECT_RETURN;
+
+  napi_value sendValue;
+  c->status = napi_get_named_property(env, thisValue, "embedded", &sendValue);
+  REJECT_RETURN;
+  c->status = napi_typeof(env, sendValue, &type);
+  REJECT_RETURN;
+  if (type != napi_external) REJECT_ERROR_RETURN(
+    "Sender has already been destroyed or transferred.",
+    GRANDIOSE_INVALID_ARGS);
+  sendInstance* s;
+  c->status = getSendInstance(env, thisValue, &s);
+  REJECT_RETURN;
+
+  // The adopting object reports the same properties as this one
+  napi_value param;
+  bool clockVideo, clockAudio;
+  c->status = napi_get_named_property(env, thisValue, "clockVideo", &param);
+  REJECT_RETURN;
+  c->status = napi_get_value_bool(env, param, &clockVideo);
+  REJECT_RETURN;
+  c->status = napi_get_named_property(env, thisValue, "clockAudio", &param);
+  REJECT_RETURN;
+  c->status = napi_get_value_bool(env, param, &clockAudio);
+  REJECT_RETURN;
+  size_t namel;
+  c->status = napi_get_named_property(env, thisValue, "name", &param);
+  REJECT_RETURN;
+  c->status = napi_get_value_string_utf8(env, param, nullptr, 0, &namel);
+  REJECT_RETURN;
+  char* name = (char *) malloc(namel + 1);
+  c->status = napi_get_value_string_utf8(env, param, name, namel + 1, &namel);
+  if (c->status != napi_ok) free(name);
+  REJECT_RETURN;
+
+  sendCarrier* t = new sendCarrier;
+  t->name = name;
+  t->clockVideo = clockVideo;
+  t->clockAudio = clockAudio;
+  t->asyncVideo = s->asyncVideo;
+  t->holdLastFrame = s->holdLastFrame;
+  t->queueDepth = s->queue->depth;
+  t->overflow = s->overflow;
+
+  napi_value value;
+  c->status = napi_create_int32(env, 0, &value);
+  if (c->status != napi_ok) delete t;
+  REJECT_RETURN;
+  c->status = napi_set_named_property(env, thisValue, "embedded", value);
+  if (c->status != napi_ok) delete t;
+  REJECT_RETURN;
+
+  s->destroyed = true;
+  s->transfer = t;
+  s->destroyedDeferred = c->_deferred;
+  c->_deferred = nullptr;
+  tidyCarrier(env, c);
+  s->monitoring = false;
+  s->capturingMetadata = false;
+  stopPlayout(s);
+  stopSendThread(env, s);
+  if (s->refs == 1)
+    closeSend(s);
+  return promise;
+}
+
 void sendComplete(napi_env env, napi_status asyncStatus, void* data) {
   sendCarrier* c = (sendCarrier*) data;
 
@@ -140,8 +563,19 @@ void sendComplete(napi_env env, napi_status asyncStatus, void* data) {
   c->status = napi_create_object(env, &result);
   REJECT_STATUS;
 
+  sendInstance* s = new sendInstance;
+  s->send = c->send;
+  s->env = env;
+  s->asyncVideo = c->asyncVideo;
+  s->holdLastFrame = c->holdLastFrame;
+  s->queue = new frameRing<sendDataCarrier>(c->queueDepth);
+  s->overflow = c->overflow;
   napi_value embedded;
-  c->status = napi_create_external(env, c->send, finalizeSend, result, &embedded);
+  c->status = napi_create_external(env, s, finalizeSend, nullptr, &embedded);
+  if (c->status != napi_ok) {
+    NDIlib_send_destroy(s->send);
+    delete s;
+  }
   REJECT_STATUS;
   c->status = napi_set_named_property(env, result, "embedded", embedded);
   REJECT_STATUS;
@@ -153,6 +587,13 @@ void sendComplete(napi_env env, napi_status asyncStatus, void* data) {
   c->status = napi_set_named_property(env, result, "destroy", destroyFn);
   REJECT_STATUS;
 
+  napi_value transferFn;
+  c->status = napi_create_function(env, "transfer", NAPI_AUTO_LENGTH, transferSend,
+    nullptr, &transferFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "transfer", transferFn);
+  REJECT_STATUS;
+
   napi_value videoFn;
   c->status = napi_create_function(env, "video", NAPI_AUTO_LENGTH, videoSend,
     nullptr, &videoFn);
@@ -160,6 +601,69 @@ void sendComplete(napi_env env, napi_status asyncStatus, void* data) {
   c->status = napi_set_named_property(env, result, "video", videoFn);
   REJECT_STATUS;
 
+  napi_value configureVideoFn;
+  c->status = napi_create_function(env, "configureVideo", NAPI_AUTO_LENGTH, configureVideo,
+    nullptr, &configureVideoFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "configureVideo", configureVideoFn);
+  REJECT_STATUS;
+
+  napi_value videoDataFn;
+  c->status = napi_create_function(env, "videoData", NAPI_AUTO_LENGTH, videoDataSend,
+    nullptr, &videoDataFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "videoData", videoDataFn);
+  REJECT_STATUS;
+
+  napi_value configureAudioFn;
+  c->status = napi_create_function(env, "configureAudio", NAPI_AUTO_LENGTH, configureAudio,
+    nullptr, &configureAudioFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "configureAudio", configureAudioFn);
+  REJECT_STATUS;
+
+  napi_value audioDataFn;
+  c->status = napi_create_function(env, "audioData", NAPI_AUTO_LENGTH, audioDataSend,
+    nullptr, &audioDataFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "audioData", audioDataFn);
+  REJECT_STATUS;
+
+  napi_value playFileFn;
+  c->status = napi_create_function(env, "playFile", NAPI_AUTO_LENGTH, playFile,
+    nullptr, &playFileFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "playFile", playFileFn);
+  REJECT_STATUS;
+
+  napi_value testSignalFn;
+  c->status = napi_create_function(env, "testSignal", NAPI_AUTO_LENGTH, playSignal,
+    nullptr, &testSignalFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "testSignal", testSignalFn);
+  REJECT_STATUS;
+
+  napi_value cueFn;
+  c->status = napi_create_function(env, "cue", NAPI_AUTO_LENGTH, playoutCue,
+    nullptr, &cueFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "cue", cueFn);
+  REJECT_STATUS;
+
+  napi_value stopPlayoutFn;
+  c->status = napi_create_function(env, "stopPlayout", NAPI_AUTO_LENGTH, playoutStop,
+    nullptr, &stopPlayoutFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "stopPlayout", stopPlayoutFn);
+  REJECT_STATUS;
+
+  napi_value playoutFn;
+  c->status = napi_create_function(env, "playout", NAPI_AUTO_LENGTH, playoutStats,
+    nullptr, &playoutFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "playout", playoutFn);
+  REJECT_STATUS;
+
   napi_value audioFn;
   c->status = napi_create_function(env, "audio", NAPI_AUTO_LENGTH, audioSend,
     nullptr, &audioFn);
@@ -167,6 +671,41 @@ void sendComplete(napi_env env, napi_status asyncStatus, void* data) {
   c->status = napi_set_named_property(env, result, "audio", audioFn);
   REJECT_STATUS;
 
+  napi_value flushFn;
+  c->status = napi_create_function(env, "flush", NAPI_AUTO_LENGTH, videoFlush,
+    nullptr, &flushFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "flush", flushFn);
+  REJECT_STATUS;
+
+  napi_value statsFn;
+  c->status = napi_create_function(env, "stats", NAPI_AUTO_LENGTH, sendStats,
+    nullptr, &statsFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "stats", statsFn);
+  REJECT_STATUS;
+
+  napi_value allocateFramesFn;
+  c->status = napi_create_function(env, "allocateFrames", NAPI_AUTO_LENGTH, allocateFrames,
+    nullptr, &allocateFramesFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "allocateFrames", allocateFramesFn);
+  REJECT_STATUS;
+
+  napi_value acquireFrameFn;
+  c->status = napi_create_function(env, "acquireFrame", NAPI_AUTO_LENGTH, acquireFrame,
+    nullptr, &acquireFrameFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "acquireFrame", acquireFrameFn);
+  REJECT_STATUS;
+
+  napi_value framePoolFn;
+  c->status = napi_create_function(env, "framePool", NAPI_AUTO_LENGTH, framePool,
+    nullptr, &framePoolFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "framePool", framePoolFn);
+  REJECT_STATUS;
+
   napi_value connectionsFn;
   c->status = napi_create_function(env, "connections", NAPI_AUTO_LENGTH, connections,
     nullptr, &connectionsFn);
@@ -181,6 +720,20 @@ void sendComplete(napi_env env, napi_status asyncStatus, void* data) {
   c->status = napi_set_named_property(env, result, "tally", tallyFn);
   REJECT_STATUS;
 
+  napi_value startMonitorFn;
+  c->status = napi_create_function(env, "startMonitor", NAPI_AUTO_LENGTH, monitorStart,
+    nullptr, &startMonitorFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "startMonitor", startMonitorFn);
+  REJECT_STATUS;
+
+  napi_value stopMonitorFn;
+  c->status = napi_create_function(env, "stopMonitor", NAPI_AUTO_LENGTH, monitorStop,
+    nullptr, &stopMonitorFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "stopMonitor", stopMonitorFn);
+  REJECT_STATUS;
+
   napi_value sourcenameFn;
   c->status = napi_create_function(env, "sourcename", NAPI_AUTO_LENGTH, sourcename,
     nullptr, &sourcenameFn);
@@ -188,22 +741,36 @@ void sendComplete(napi_env env, napi_status asyncStatus, void* data) {
   c->status = napi_set_named_property(env, result, "sourcename", sourcenameFn);
   REJECT_STATUS;
 
-  // napi_value metadataFn;
-  // c->status = napi_create_function(env, "metadata", NAPI_AUTO_LENGTH, metadataReceive,
-  //   nullptr, &metadataFn);
-  // REJECT_STATUS;
-  // c->status = napi_set_named_property(env, result, "metadata", metadataFn);
-  // REJECT_STATUS;
+  napi_value metadataFn;
+  c->status = napi_create_function(env, "metadata", NAPI_AUTO_LENGTH, metadataSend,
+    nullptr, &metadataFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "metadata", metadataFn);
+  REJECT_STATUS;
+
+  napi_value captureMetadataFn;
+  c->status = napi_create_function(env, "captureMetadata", NAPI_AUTO_LENGTH, metadataCapture,
+    nullptr, &captureMetadataFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "captureMetadata", captureMetadataFn);
+  REJECT_STATUS;
+
+  napi_value startMetadataCaptureFn;
+  c->status = napi_create_function(env, "startMetadataCapture", NAPI_AUTO_LENGTH,
+    metadataCaptureStart, nullptr, &startMetadataCaptureFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "startMetadataCapture", startMetadataCaptureFn);
+  REJECT_STATUS;
 
-  // napi_value dataFn;
-  // c->status = napi_create_function(env, "data", NAPI_AUTO_LENGTH, dataReceive,
-  //   nullptr, &dataFn);
-  // REJECT_STATUS;
-  // c->status = napi_set_named_property(env, result, "data", dataFn);
-  // REJECT_STATUS;
+  napi_value stopMetadataCaptureFn;
+  c->status = napi_create_function(env, "stopMetadataCapture", NAPI_AUTO_LENGTH,
+    metadataCaptureStop, nullptr, &stopMetadataCaptureFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "stopMetadataCapture", stopMetadataCaptureFn);
+  REJECT_STATUS;
 
   // napi_value name, groups, clockVideo, clockAudio;
-  napi_value name, clockVideo, clockAudio;
+  napi_value name, clockVideo, clockAudio, asyncVideo, holdLastFrame;
   c->status = napi_create_string_utf8(env, c->name, NAPI_AUTO_LENGTH, &name);
   REJECT_STATUS;
   c->status = napi_set_named_property(env, result, "name", name);
@@ -219,6 +786,28 @@ void sendComplete(napi_env env, napi_status asyncStatus, void* data) {
   c->status = napi_set_named_property(env, result, "clockAudio", clockAudio);
   REJECT_STATUS;
 
+  c->status = napi_get_boolean(env, c->asyncVideo, &asyncVideo);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "asyncVideo", asyncVideo);
+  REJECT_STATUS;
+
+  c->status = napi_get_boolean(env, c->holdLastFrame, &holdLastFrame);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "holdLastFrame", holdLastFrame);
+  REJECT_STATUS;
+
+  // Start the sender's thread, holding the sender until it finalizes
+  napi_value resource_name;
+  c->status = napi_create_string_utf8(env, "SendThread", NAPI_AUTO_LENGTH, &resource_name);
+  REJECT_STATUS;
+  c->status = napi_create_threadsafe_function(env, nullptr, nullptr, resource_name,
+    0, 1, s, sendThreadFinalize, s, sendCallJS, &s->completeFn);
+  REJECT_STATUS;
+  c->status = napi_unref_threadsafe_function(env, s->completeFn);
+  REJECT_STATUS;
+  retainSend(s);
+  s->sendThread = std::thread(sendLoop, s);
+
   napi_status status;
   status = napi_resolve_deferred(env, c->_deferred, result);
   FLOATING_STATUS;
@@ -254,7 +843,7 @@ napi_value send(napi_env env, napi_callback_info info) {
 
   napi_value config = args[0];
   // napi_value name, groups, clockVideo, clockAudio;
-  napi_value name, clockVideo, clockAudio;
+  napi_value name, clockVideo, clockAudio, asyncVideo, holdLastFrame, queueDepth, overflow;
 
   c->status = napi_get_named_property(env, config, "name", &name);
   REJECT_RETURN;
@@ -302,24 +891,154 @@ napi_value send(napi_env env, napi_callback_info info) {
     c->status = napi_get_value_bool(env, clockAudio, &c->clockAudio);
     REJECT_RETURN;
   }
-  
-  napi_value resource_name;
-  c->status = napi_create_string_utf8(env, "Send", NAPI_AUTO_LENGTH, &resource_name);
+
+  c->status = napi_get_named_property(env, config, "asyncVideo", &asyncVideo);
+  REJECT_RETURN;
+  c->status = napi_typeof(env, asyncVideo, &type);
+  REJECT_RETURN;
+  if (type != napi_undefined) {
+    if (type != napi_boolean) REJECT_ERROR_RETURN(
+      "AsyncVideo property must be of type boolean.",
+      GRANDIOSE_INVALID_ARGS);
+    c->status = napi_get_value_bool(env, asyncVideo, &c->asyncVideo);
+    REJECT_RETURN;
+  }
+
+  c->status = napi_get_named_property(env, config, "holdLastFrame", &holdLastFrame);
+  REJECT_RETURN;
+  c->status = napi_typeof(env, holdLastFrame, &type);
+  REJECT_RETURN;
+  if (type != napi_undefined) {
+    if (type != napi_boolean) REJECT_ERROR_RETURN(
+      "HoldLastFrame property must be of type boolean.",
+      GRANDIOSE_INVALID_ARGS);
+    c->status = napi_get_value_bool(env, holdLastFrame, &c->holdLastFrame);
+    REJECT_RETURN;
+  }
+
+  c->status = napi_get_named_property(env, config, "queueDepth", &queueDepth);
+  REJECT_RETURN;
+  c->status = napi_typeof(env, queueDepth, &type);
+  REJECT_RETURN;
+  if (type != napi_undefined) {
+    if (type != napi_number) REJECT_ERROR_RETURN(
+      "QueueDepth property must be of type number.",
+      GRANDIOSE_INVALID_ARGS);
+    c->status = napi_get_value_uint32(env, queueDepth, &c->queueDepth);
+    REJECT_RETURN;
+    if (c->queueDepth == 0) REJECT_ERROR_RETURN(
+      "QueueDepth must be at least 1.",
+      GRANDIOSE_INVALID_ARGS);
+  }
+
+  c->status = napi_get_named_property(env, config, "overflow", &overflow);
   REJECT_RETURN;
-  c->status = napi_create_async_work(env, NULL, resource_name, sendExecute,
-    sendComplete, c, &c->_request);
+  c->status = napi_typeof(env, overflow, &type);
   REJECT_RETURN;
-  c->status = napi_queue_async_work(env, c->_request);
+  if (type != napi_undefined) {
+    if (type != napi_string) REJECT_ERROR_RETURN(
+      "Overflow property must be one of 'block', 'drop-oldest' or 'drop-newest'.",
+      GRANDIOSE_INVALID_ARGS);
+    char policy[16];
+    size_t policyl;
+    c->status = napi_get_value_string_utf8(env, overflow, policy, sizeof(policy), &policyl);
+    REJECT_RETURN;
+    if (strcmp(policy, "block") == 0)
+      c->overflow = Grandiose_overflow_block;
+    else if (strcmp(policy, "drop-oldest") == 0)
+      c->overflow = Grandiose_overflow_drop_oldest;
+    else if (strcmp(policy, "drop-newest") == 0)
+      c->overflow = Grandiose_overflow_drop_newest;
+    else REJECT_ERROR_RETURN(
+      "Overflow property must be one of 'block', 'drop-oldest' or 'drop-newest'.",
+      GRANDIOSE_INVALID_ARGS);
+  }
+  
+  c->status = queueNDIWork(env, c, Grandiose_lane_send,
+    sendExecute, sendComplete);
   REJECT_RETURN;
 
   return promise;
 }
 
 
+// Called on the sender's thread. Returns a buffer of at least the given size
+// for a converted frame, or nullptr if memory cannot be allocated.
+uint8_t* scratchBuffer(sendInstance* s, NDIlib_send_instance_t send, size_t size) {
+  if (size > s->scratchSize) {
+    // NDI may still be reading the last converted frame
+    if (s->asyncVideo) NDIlib_send_send_video_async_v2(send, NULL);
+    for ( int x = 0 ; x < 2 ; x++ ) {
+      if (s->holding && (s->heldFrame.p_data == s->scratch[x])) s->holding = false;
+      if (s->scratch[x] != nullptr)
+        freeFrameMemory(s->scratch[x], s->scratchSize, s->scratchHuge[x]);
+      s->scratch[x] = nullptr;
+    }
+    s->scratchSize = size;
+  }
+  uint32_t next = s->scratchNext;
+  s->scratchNext ^= 1;
+  if (s->scratch[next] == nullptr)
+    s->scratch[next] = (uint8_t*) allocateFrameMemory(size, false, &s->scratchHuge[next]);
+  return s->scratch[next];
+}
+
 void videoSendExecute(napi_env env, void* data) {
   sendDataCarrier* c = (sendDataCarrier*) data;
+  sendInstance* s = c->instance;
+
+  bool converted = false;
+  if (c->convertTo == NDIlib_FourCC_video_type_UYVY) {
+    int32_t stride = (c->videoFrame.xres + 1) / 2 * 4;
+    uint8_t* dst = scratchBuffer(s, c->send, (size_t) stride * c->videoFrame.yres);
+    if (dst == nullptr) {
+      c->status = GRANDIOSE_ALLOCATION_FAILURE;
+      c->errorMsg = "Failed to allocate memory for converted video frame.";
+      s->mux.skip();
+      return;
+    }
+    convertToUYVY(&c->videoFrame, dst, stride, c->colorMatrix);
+    c->videoFrame.p_data = dst;
+    c->videoFrame.FourCC = NDIlib_FourCC_video_type_UYVY;
+    c->videoFrame.line_stride_in_bytes = stride;
+    converted = true;
+  }
 
-  NDIlib_send_send_video_v2(c->send, &c->videoFrame);
+  // Audio muxed with the frame is sent just ahead of it, with its timecode
+  if (s->mux.take(c->videoFrame.frame_rate_N, c->videoFrame.frame_rate_D,
+      c->videoFrame.timecode, &c->audioFrame))
+    NDIlib_send_send_audio_v3(c->send, &c->audioFrame);
+
+  if (s->asyncVideo && !c->synchronous) {
+    // Returns once the frame is queued. Submitting it also tells us that
+    // NDI has finished with the previously submitted buffer.
+    NDIlib_send_send_video_async_v2(c->send, &c->videoFrame);
+    c->releaseBufferRef = s->asyncBufferRef;
+    c->releaseFrame = s->asyncFrame;
+    c->releaseMetadata = s->asyncMetadata;
+    s->asyncMetadata = c->frameMetadata;
+    c->frameMetadata = nullptr;
+    // The source of a converted frame can be released straight away
+    if (converted) {
+      s->asyncBufferRef = nullptr;
+      s->asyncFrame = nullptr;
+    } else {
+      s->asyncBufferRef = c->sourceBufferRef;
+      s->asyncFrame = c->sourceFrame;
+      c->sourceBufferRef = nullptr;
+      c->sourceFrame = nullptr;
+    }
+  } else {
+    // A synchronous send also completes any outstanding async frame
+    NDIlib_send_send_video_v2(c->send, &c->videoFrame);
+    c->releaseBufferRef = s->asyncBufferRef;
+    c->releaseFrame = s->asyncFrame;
+    c->releaseMetadata = s->asyncMetadata;
+    s->asyncBufferRef = nullptr;
+    s->asyncFrame = nullptr;
+    s->asyncMetadata = nullptr;
+  }
+  if (s->holdLastFrame) holdVideo(s, c, converted);
 }
 
 void videoSendComplete(napi_env env, napi_status asyncStatus, void* data) {
@@ -327,9 +1046,6 @@ void videoSendComplete(napi_env env, napi_status asyncStatus, void* data) {
   napi_value result;
   napi_status status;
 
-  c->status = napi_delete_reference(env, c->sourceBufferRef);
-  REJECT_STATUS;
-
   if (asyncStatus != napi_ok) {
     c->status = asyncStatus;
     c->errorMsg = "Async video frame receive failed to complete.";
@@ -344,13 +1060,329 @@ void videoSendComplete(napi_env env, napi_status asyncStatus, void* data) {
   tidyCarrier(env, c);
 }
 
-napi_value videoSend(napi_env env, napi_callback_info info) {
+// Reads the properties of a video frame that describe its format, which
+// stay the same from frame to frame of an output.
+void parseVideoFormat(napi_env env, napi_value config,
+    NDIlib_video_frame_v2_t* frame, carrier* c) {
   napi_valuetype type;
-  sendDataCarrier* c = new sendDataCarrier;
+  napi_value param;
+
+  c->status = napi_get_named_property(env, config, "xres", &param);
+  CARRIER_STATUS;
+  c->status = napi_typeof(env, param, &type);
+  CARRIER_STATUS;
+  if (type != napi_number) CARRIER_ERROR(
+    "xres value must be a number",
+    GRANDIOSE_INVALID_ARGS);
+  c->status = napi_get_value_int32(env, param, &frame->xres);
+  CARRIER_STATUS;
+
+  c->status = napi_get_named_property(env, config, "yres", &param);
+  CARRIER_STATUS;
+  c->status = napi_typeof(env, param, &type);
+  CARRIER_STATUS;
+  if (type != napi_number) CARRIER_ERROR(
+    "yres value must be a number",
+    GRANDIOSE_INVALID_ARGS);
+  c->status = napi_get_value_int32(env, param, &frame->yres);
+  CARRIER_STATUS;
+
+  c->status = napi_get_named_property(env, config, "frameRateN", &param);
+  CARRIER_STATUS;
+  c->status = napi_typeof(env, param, &type);
+  CARRIER_STATUS;
+  if (type != napi_number) CARRIER_ERROR(
+    "frameRateN value must be a number",
+    GRANDIOSE_INVALID_ARGS);
+  c->status = napi_get_value_int32(env, param, &frame->frame_rate_N);
+  CARRIER_STATUS;
+
+  c->status = napi_get_named_property(env, config, "frameRateD", &param);
+  CARRIER_STATUS;
+  c->status = napi_typeof(env, param, &type);
+  CARRIER_STATUS;
+  if (type != napi_number) CARRIER_ERROR(
+    "frameRateD value must be a number",
+    GRANDIOSE_INVALID_ARGS);
+  c->status = napi_get_value_int32(env, param, &frame->frame_rate_D);
+  CARRIER_STATUS;
+
+  c->status = napi_get_named_property(env, config, "pictureAspectRatio", &param);
+  CARRIER_STATUS;
+  c->status = napi_typeof(env, param, &type);
+  CARRIER_STATUS;
+  if (type != napi_number) CARRIER_ERROR(
+    "pictureAspectRatio value must be a number",
+    GRANDIOSE_INVALID_ARGS);
+  double pictureAspectRatio;
+  c->status = napi_get_value_double(env, param, &pictureAspectRatio);
+  CARRIER_STATUS;
+  frame->picture_aspect_ratio = (float) pictureAspectRatio;
+
+  /*  initialize also timecode, timestamp (receiver-side only) and metadata  */
+  frame->timecode = NDIlib_send_timecode_synthesize;
+  frame->timestamp = 0;
+  frame->p_metadata = NULL;
+
+  c->status = napi_get_named_property(env, config, "frameFormatType", &param);
+  CARRIER_STATUS;
+  c->status = napi_typeof(env, param, &type);
+  CARRIER_STATUS;
+  if (type != napi_number) CARRIER_ERROR(
+    "frameFormatType value must be a number",
+    GRANDIOSE_INVALID_ARGS);
+  int32_t formatType;
+  c->status = napi_get_value_int32(env, param, &formatType);
+  CARRIER_STATUS;
+  if ((formatType < NDIlib_frame_format_type_interleaved) ||
+      (formatType > NDIlib_frame_format_type_field_1)) CARRIER_ERROR(
+    "frameFormatType value must be one of the FORMAT_TYPE constants",
+    GRANDIOSE_INVALID_ARGS);
+  frame->frame_format_type = (NDIlib_frame_format_type_e) formatType;
+
+  c->status = napi_get_named_property(env, config, "lineStrideBytes", &param);
+  CARRIER_STATUS;
+  c->status = napi_typeof(env, param, &type);
+  CARRIER_STATUS;
+  if (type != napi_number) CARRIER_ERROR(
+    "lineStrideBytes value must be a number",
+    GRANDIOSE_INVALID_ARGS);
+  c->status = napi_get_value_int32(env, param, &frame->line_stride_in_bytes);
+  CARRIER_STATUS;
+
+  c->status = napi_get_named_property(env, config, "fourCC", &param);
+  CARRIER_STATUS;
+  c->status = napi_typeof(env, param, &type);
+  CARRIER_STATUS;
+  if (type != napi_number) CARRIER_ERROR(
+    "fourCC value must be a number",
+    GRANDIOSE_INVALID_ARGS);
+  int32_t fourCC;
+  c->status = napi_get_value_int32(env, param, &fourCC);
+  CARRIER_STATUS;
+  frame->FourCC = (NDIlib_FourCC_video_type_e) fourCC;
 
-  napi_value promise;
-  c->status = napi_create_promise(env, &c->_deferred, &promise);
-  REJECT_RETURN;
+  if ((frame->xres <= 0) || (frame->yres <= 0)) CARRIER_ERROR(
+    "xres and yres must be positive",
+    GRANDIOSE_INVALID_ARGS);
+  int32_t minimumStride = defaultLineStride(frame->FourCC, frame->xres);
+  if (minimumStride == 0) CARRIER_ERROR(
+    "fourCC value must be one of the video FOURCC constants",
+    GRANDIOSE_INVALID_ARGS);
+  if (frame->line_stride_in_bytes < minimumStride) CARRIER_ERROR(
+    "lineStrideBytes is too small for the width of the frame",
+    GRANDIOSE_INVALID_ARGS);
+}
+
+// Reads the optional roi property of a video frame or format, which picks
+// out the region { x, y, width, height } of the frame to send
+void parseVideoRegion(napi_env env, napi_value config, const NDIlib_video_frame_v2_t* frame,
+    videoRegion* region, carrier* c) {
+  napi_valuetype type;
+  napi_value roi;
+
+  c->status = napi_get_named_property(env, config, "roi", &roi);
+  CARRIER_STATUS;
+  c->status = napi_typeof(env, roi, &type);
+  CARRIER_STATUS;
+  region->set = false;
+  if (type == napi_undefined) return;
+  if (type != napi_object) CARRIER_ERROR(
+    "roi value must be an object",
+    GRANDIOSE_INVALID_ARGS);
+
+  switch (frame->FourCC) {
+    case NDIlib_FourCC_video_type_UYVY:
+    case NDIlib_FourCC_video_type_RGBA:
+    case NDIlib_FourCC_video_type_RGBX:
+    case NDIlib_FourCC_video_type_BGRA:
+    case NDIlib_FourCC_video_type_BGRX:
+      break;
+    default:
+      CARRIER_ERROR(
+        "roi can only be used with UYVY, RGBA, RGBX, BGRA or BGRX video",
+        GRANDIOSE_INVALID_ARGS);
+  }
+
+  region->x = 0;
+  region->y = 0;
+  parseOptionalInt32(env, roi, "x", &region->x, c);
+  CARRIER_STATUS;
+  parseOptionalInt32(env, roi, "y", &region->y, c);
+  CARRIER_STATUS;
+  region->width = frame->xres - region->x;
+  region->height = frame->yres - region->y;
+  parseOptionalInt32(env, roi, "width", &region->width, c);
+  CARRIER_STATUS;
+  parseOptionalInt32(env, roi, "height", &region->height, c);
+  CARRIER_STATUS;
+  if ((region->x < 0) || (region->y < 0) || (region->width <= 0) || (region->height <= 0) ||
+      (region->width > frame->xres - region->x) || (region->height > frame->yres - region->y)) CARRIER_ERROR(
+    "roi must be a region of at least one pixel inside the frame",
+    GRANDIOSE_INVALID_ARGS);
+  // UYVY pixels are stored in pairs that share their chroma
+  if ((frame->FourCC == NDIlib_FourCC_video_type_UYVY) && (region->x % 2 != 0)) CARRIER_ERROR(
+    "roi x must be even for UYVY video",
+    GRANDIOSE_INVALID_ARGS);
+  region->set = true;
+}
+
+// Reads the optional convertTo and colorMatrix properties of a video frame
+// or format. Conversion is skipped if the frame is already in the target.
+void parseVideoConversion(napi_env env, napi_value config, const NDIlib_video_frame_v2_t* frame,
+    NDIlib_FourCC_video_type_e* convertTo, Grandiose_color_matrix_e* colorMatrix, carrier* c) {
+  napi_valuetype type;
+  napi_value param;
+
+  c->status = napi_get_named_property(env, config, "convertTo", &param);
+  CARRIER_STATUS;
+  c->status = napi_typeof(env, param, &type);
+  CARRIER_STATUS;
+  if (type == napi_undefined) return;
+  if (type != napi_number) CARRIER_ERROR(
+    "convertTo value must be a number",
+    GRANDIOSE_INVALID_ARGS);
+  int32_t target;
+  c->status = napi_get_value_int32(env, param, &target);
+  CARRIER_STATUS;
+  if (target != NDIlib_FourCC_video_type_UYVY) CARRIER_ERROR(
+    "convertTo value must be FOURCC_UYVY",
+    GRANDIOSE_INVALID_ARGS);
+
+  c->status = napi_get_named_property(env, config, "colorMatrix", &param);
+  CARRIER_STATUS;
+  c->status = napi_typeof(env, param, &type);
+  CARRIER_STATUS;
+  if (type == napi_number) {
+    int32_t matrix;
+    c->status = napi_get_value_int32(env, param, &matrix);
+    CARRIER_STATUS;
+    if (!validColorMatrix((Grandiose_color_matrix_e) matrix)) CARRIER_ERROR(
+      "colorMatrix value must be one of the COLOR_MATRIX constants",
+      GRANDIOSE_INVALID_ARGS);
+    *colorMatrix = (Grandiose_color_matrix_e) matrix;
+  }
+  else if (type != napi_undefined) CARRIER_ERROR(
+    "colorMatrix value must be a number",
+    GRANDIOSE_INVALID_ARGS);
+
+  if (frame->FourCC == target) return;
+  if (!canConvertToUYVY(frame->FourCC)) CARRIER_ERROR(
+    "video can only be converted from RGBA, RGBX, BGRA, BGRX, I420, YV12 or NV12",
+    GRANDIOSE_INVALID_ARGS);
+  if ((frame->xres <= 0) || (frame->yres <= 0)) CARRIER_ERROR(
+    "xres and yres must be positive to convert video",
+    GRANDIOSE_INVALID_ARGS);
+  bool subsampled = (frame->FourCC == NDIlib_FourCC_video_type_I420) ||
+    (frame->FourCC == NDIlib_FourCC_video_type_YV12) ||
+    (frame->FourCC == NDIlib_FourCC_video_type_NV12);
+  if (subsampled && ((frame->xres % 2 != 0) || (frame->yres % 2 != 0))) CARRIER_ERROR(
+    "xres and yres must be even to convert I420, YV12 or NV12 video",
+    GRANDIOSE_INVALID_ARGS);
+  bool packed = (frame->FourCC == NDIlib_FourCC_video_type_RGBA) ||
+    (frame->FourCC == NDIlib_FourCC_video_type_RGBX) ||
+    (frame->FourCC == NDIlib_FourCC_video_type_BGRA) ||
+    (frame->FourCC == NDIlib_FourCC_video_type_BGRX);
+  if (frame->line_stride_in_bytes < (packed ? frame->xres * 4 : frame->xres)) CARRIER_ERROR(
+    "lineStrideBytes is too small for the width of the frame",
+    GRANDIOSE_INVALID_ARGS);
+  *convertTo = (NDIlib_FourCC_video_type_e) target;
+}
+
+// Reads an optional timecode given as a number or bigint
+void parseTimecode(napi_env env, napi_value param, int64_t* timecode, carrier* c) {
+  napi_valuetype type;
+  c->status = napi_typeof(env, param, &type);
+  CARRIER_STATUS;
+  if (type == napi_number) {
+    c->status = napi_get_value_int64(env, param, timecode);
+    CARRIER_STATUS;
+  }
+  else if (type == napi_bigint) {
+    bool lossless;
+    c->status = napi_get_value_bigint_int64(env, param, timecode, &lossless);
+    CARRIER_STATUS;
+  }
+  else if (type != napi_undefined) CARRIER_ERROR(
+    "timecode value must be a number or bigint",
+    GRANDIOSE_INVALID_ARGS);
+}
+
+// Copies a string for NDI into memory that the caller frees
+void copyMetadata(napi_env env, napi_value param, char** result, carrier* c) {
+  napi_valuetype type;
+  c->status = napi_typeof(env, param, &type);
+  CARRIER_STATUS;
+  if (type != napi_string) CARRIER_ERROR(
+    "metadata must be a string",
+    GRANDIOSE_INVALID_ARGS);
+  size_t length;
+  c->status = napi_get_value_string_utf8(env, param, nullptr, 0, &length);
+  CARRIER_STATUS;
+  *result = (char*) malloc(length + 1);
+  c->status = napi_get_value_string_utf8(env, param, *result, length + 1, &length);
+  CARRIER_STATUS;
+}
+
+// Reads the optional metadata property of a video or audio frame
+void parseFrameMetadata(napi_env env, napi_value config, sendDataCarrier* c) {
+  napi_valuetype type;
+  napi_value param;
+  c->status = napi_get_named_property(env, config, "metadata", &param);
+  CARRIER_STATUS;
+  c->status = napi_typeof(env, param, &type);
+  CARRIER_STATUS;
+  if (type == napi_undefined) return;
+  copyMetadata(env, param, &c->frameMetadata, c);
+}
+
+// Takes a reference to the buffer for the frame's pixel data
+void setVideoData(napi_env env, napi_value videoBuffer, sendDataCarrier* c) {
+  bool isBuffer;
+  c->status = napi_is_buffer(env, videoBuffer, &isBuffer);
+  CARRIER_STATUS;
+  if (!isBuffer) CARRIER_ERROR(
+    "data must be provided as a Node Buffer",
+    GRANDIOSE_INVALID_ARGS);
+  void * data;
+  size_t length;
+  c->status = napi_get_buffer_info(env, videoBuffer, &data, &length);
+  CARRIER_STATUS;
+  // Every plane of the whole frame must be in the buffer, even for a region
+  size_t required = videoFrameBytes(c->videoFrame.FourCC, c->videoFrame.xres,
+    c->videoFrame.yres, c->videoFrame.line_stride_in_bytes);
+  if (length < required) CARRIER_ERROR(
+    "data buffer is too small for the frame",
+    GRANDIOSE_INVALID_ARGS);
+  c->videoFrame.p_data = (uint8_t*) data;
+  // A region is sent from within the frame, with the frame's line stride
+  if (c->region.set) {
+    int32_t pixelBytes = (c->videoFrame.FourCC == NDIlib_FourCC_video_type_UYVY) ? 2 : 4;
+    c->videoFrame.p_data += (size_t) c->region.y * c->videoFrame.line_stride_in_bytes +
+      (size_t) c->region.x * pixelBytes;
+    c->videoFrame.xres = c->region.width;
+    c->videoFrame.yres = c->region.height;
+  }
+  c->status = napi_create_reference(env, videoBuffer, 1, &c->sourceBufferRef);
+  CARRIER_STATUS;
+
+  // Pool frames are in use until NDI has finished with them
+  for ( auto f : c->instance->pool ) {
+    if ((c->videoFrame.p_data >= f->data) && (c->videoFrame.p_data < f->data + f->size)) {
+      f->inFlight++;
+      c->sourceFrame = f;
+      break;
+    }
+  }
+}
+
+napi_value videoSend(napi_env env, napi_callback_info info) {
+  napi_valuetype type;
+  sendDataCarrier* c = new sendDataCarrier;
+
+  napi_value promise;
+  c->status = napi_create_promise(env, &c->_deferred, &promise);
+  REJECT_RETURN;
 
   size_t argc = 1;
   napi_value args[1];
@@ -358,13 +1390,13 @@ napi_value videoSend(napi_env env, napi_callback_info info) {
   c->status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
   REJECT_RETURN;
 
-  napi_value sendValue;
-  c->status = napi_get_named_property(env, thisValue, "embedded", &sendValue);
-  REJECT_RETURN;
-  void* sendData;
-  c->status = napi_get_value_external(env, sendValue, &sendData);
-  c->send = (NDIlib_send_instance_t) sendData;
+  c->status = getSendInstance(env, thisValue, &c->instance);
   REJECT_RETURN;
+  retainSend(c->instance);
+  c->send = c->instance->send;
+  if (c->instance->playout != nullptr) REJECT_ERROR_RETURN(
+    "Sender is playing a file or test signal.",
+    GRANDIOSE_INVALID_ARGS);
 
   if (argc >= 1) {
     napi_value config;
@@ -375,180 +1407,1503 @@ napi_value videoSend(napi_env env, napi_callback_info info) {
       "frame must be an object",
       GRANDIOSE_INVALID_ARGS);
 
-    bool isArray, isBuffer;
+    bool isArray;
     c->status = napi_is_array(env, config, &isArray);
     REJECT_RETURN;
     if (isArray) REJECT_ERROR_RETURN(
       "Argument to video send cannot be an array.",
       GRANDIOSE_INVALID_ARGS);
 
-    napi_value param;
-    c->status = napi_get_named_property(env, config, "xres", &param);
+    parseVideoFormat(env, config, &c->videoFrame, c);
     REJECT_RETURN;
-    c->status = napi_typeof(env, param, &type);
+    parseVideoRegion(env, config, &c->videoFrame, &c->region, c);
     REJECT_RETURN;
-    if (type != napi_number) REJECT_ERROR_RETURN(
-      "yres value must be a number",
-      GRANDIOSE_INVALID_ARGS);
-    c->status = napi_get_value_int32(env, param, &c->videoFrame.xres);
+    parseVideoConversion(env, config, &c->videoFrame, &c->convertTo, &c->colorMatrix, c);
     REJECT_RETURN;
 
-    c->status = napi_get_named_property(env, config, "yres", &param);
-    REJECT_RETURN;
-    c->status = napi_typeof(env, param, &type);
+    napi_value param;
+    c->status = napi_get_named_property(env, config, "timecode", &param);
     REJECT_RETURN;
-    if (type != napi_number) REJECT_ERROR_RETURN(
-      "yres value must be a number",
-      GRANDIOSE_INVALID_ARGS);
-    c->status = napi_get_value_int32(env, param, &c->videoFrame.yres);
+    parseTimecode(env, param, &c->videoFrame.timecode, c);
     REJECT_RETURN;
 
-    c->status = napi_get_named_property(env, config, "frameRateN", &param);
-    REJECT_RETURN;
-    c->status = napi_typeof(env, param, &type);
+    c->status = napi_get_named_property(env, config, "data", &param);
     REJECT_RETURN;
-    if (type != napi_number) REJECT_ERROR_RETURN(
-      "frameRateN value must be a number",
-      GRANDIOSE_INVALID_ARGS);
-    c->status = napi_get_value_int32(env, param, &c->videoFrame.frame_rate_N);
+    setVideoData(env, param, c);
     REJECT_RETURN;
 
-    c->status = napi_get_named_property(env, config, "frameRateD", &param);
-    REJECT_RETURN;
-    c->status = napi_typeof(env, param, &type);
-    REJECT_RETURN;
-    if (type != napi_number) REJECT_ERROR_RETURN(
-      "frameRateD value must be a number",
-      GRANDIOSE_INVALID_ARGS);
-    c->status = napi_get_value_int32(env, param, &c->videoFrame.frame_rate_D);
+    parseFrameMetadata(env, config, c);
     REJECT_RETURN;
+    c->videoFrame.p_metadata = c->frameMetadata;
+
+  } else REJECT_ERROR_RETURN(
+      "frame not provided",
+    GRANDIOSE_INVALID_ARGS);
+
+  c->status = queueSendWork(env, c, videoSendExecute, videoSendComplete);
+  REJECT_RETURN;
+
+  return promise;
+}
+
+// sender.configureVideo(format) stores the format of the sender's video, as
+// for a frame without data or timecode, for use by sender.videoData().
+napi_value configureVideo(napi_env env, napi_callback_info info) {
+  napi_valuetype type;
+  carrier* c = new carrier;
+
+  napi_value promise;
+  c->status = napi_create_promise(env, &c->_deferred, &promise);
+  REJECT_RETURN;
+
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value thisValue;
+  c->status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  REJECT_RETURN;
+
+  sendInstance* s;
+  c->status = getSendInstance(env, thisValue, &s);
+  REJECT_RETURN;
+
+  if (argc < 1) REJECT_ERROR_RETURN(
+    "video format not provided",
+    GRANDIOSE_INVALID_ARGS);
+  c->status = napi_typeof(env, args[0], &type);
+  REJECT_RETURN;
+  if (type != napi_object) REJECT_ERROR_RETURN(
+    "video format must be an object",
+    GRANDIOSE_INVALID_ARGS);
+
+  NDIlib_video_frame_v2_t format;
+  parseVideoFormat(env, args[0], &format, c);
+  REJECT_RETURN;
+  videoRegion region;
+  parseVideoRegion(env, args[0], &format, &region, c);
+  REJECT_RETURN;
+  NDIlib_FourCC_video_type_e convertTo = (NDIlib_FourCC_video_type_e) 0;
+  Grandiose_color_matrix_e colorMatrix = Grandiose_color_matrix_auto;
+  parseVideoConversion(env, args[0], &format, &convertTo, &colorMatrix, c);
+  REJECT_RETURN;
+  s->videoFormat = format;
+  s->videoRoi = region;
+  s->videoConvertTo = convertTo;
+  s->videoColorMatrix = colorMatrix;
+  s->videoConfigured = true;
+
+  napi_value undefined;
+  c->status = napi_get_undefined(env, &undefined);
+  REJECT_RETURN;
+  c->status = napi_resolve_deferred(env, c->_deferred, undefined);
+  REJECT_RETURN;
+  tidyCarrier(env, c);
+
+  return promise;
+}
+
+// sender.videoData(data, timecode?) sends a frame in the configured format,
+// reading no properties.
+napi_value videoDataSend(napi_env env, napi_callback_info info) {
+  sendDataCarrier* c = new sendDataCarrier;
+
+  napi_value promise;
+  c->status = napi_create_promise(env, &c->_deferred, &promise);
+  REJECT_RETURN;
+
+  size_t argc = 2;
+  napi_value args[2];
+  napi_value thisValue;
+  c->status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  REJECT_RETURN;
+
+  c->status = getSendInstance(env, thisValue, &c->instance);
+  REJECT_RETURN;
+  retainSend(c->instance);
+  c->send = c->instance->send;
+  if (c->instance->playout != nullptr) REJECT_ERROR_RETURN(
+    "Sender is playing a file or test signal.",
+    GRANDIOSE_INVALID_ARGS);
+
+  if (!c->instance->videoConfigured) REJECT_ERROR_RETURN(
+    "video format must be set with configureVideo before sending video data",
+    GRANDIOSE_INVALID_ARGS);
+  c->videoFrame = c->instance->videoFormat;
+  c->region = c->instance->videoRoi;
+  c->convertTo = c->instance->videoConvertTo;
+  c->colorMatrix = c->instance->videoColorMatrix;
+
+  if (argc < 1) REJECT_ERROR_RETURN(
+    "video data not provided",
+    GRANDIOSE_INVALID_ARGS);
+  setVideoData(env, args[0], c);
+  REJECT_RETURN;
 
-    c->status = napi_get_named_property(env, config, "pictureAspectRatio", &param);
+  if (argc >= 2) {
+    parseTimecode(env, args[1], &c->videoFrame.timecode, c);
     REJECT_RETURN;
-    c->status = napi_typeof(env, param, &type);
+  }
+
+  c->status = queueSendWork(env, c, videoSendExecute, videoSendComplete);
+  REJECT_RETURN;
+
+  return promise;
+}
+
+// Main thread. Settles the group's promise once every sender is done with
+// the frame, and the frame has been queued on all of them.
+void settleGroupSend(napi_env env, sendGroupCarrier* c) {
+  if (--c->pending > 0) return;
+  REJECT_STATUS;
+
+  napi_value result, param;
+  napi_status status;
+  c->status = napi_create_object(env, &result);
+  REJECT_STATUS;
+  c->status = napi_create_uint32(env, c->sent, &param);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "sent", param);
+  REJECT_STATUS;
+  c->status = napi_create_uint32(env, c->dropped, &param);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "dropped", param);
+  REJECT_STATUS;
+  status = napi_resolve_deferred(env, c->_deferred, result);
+  FLOATING_STATUS;
+
+  tidyCarrier(env, c);
+}
+
+// Main thread. Records the outcome of one sender's part of a group frame.
+void settleGroupPart(napi_env env, sendGroupCarrier* c, sendDataCarrier* part, bool dropped) {
+  if (dropped)
+    c->dropped++;
+  else if (part->status == GRANDIOSE_SUCCESS)
+    c->sent++;
+  else if (c->status == GRANDIOSE_SUCCESS) {
+    c->status = part->status;
+    c->errorMsg = part->errorMsg;
+  }
+  settleGroupSend(env, c);
+}
+
+void groupVideoComplete(napi_env env, napi_status asyncStatus, void* data) {
+  sendDataCarrier* c = (sendDataCarrier*) data;
+
+  if (asyncStatus != napi_ok) {
+    c->status = asyncStatus;
+    c->errorMsg = "Async group video frame send failed to complete.";
+  }
+  settleGroupPart(env, c->group, c, false);
+  tidyCarrier(env, c);
+}
+
+napi_status getSendGroupInstance(napi_env env, napi_value thisValue, sendGroupInstance** g) {
+  napi_status status;
+  napi_value groupValue;
+  status = napi_get_named_property(env, thisValue, "embedded", &groupValue);
+  PASS_STATUS;
+  void* groupData;
+  status = napi_get_value_external(env, groupValue, &groupData);
+  PASS_STATUS;
+  *g = (sendGroupInstance*) groupData;
+  return napi_ok;
+}
+
+// group.video(frame) validates the frame and takes a reference to its buffer
+// once, then queues it on the thread of every sender in the group. The
+// promise resolves once every sender has sent or dropped the frame, after
+// which the buffer can be reused.
+napi_value groupVideoSend(napi_env env, napi_callback_info info) {
+  napi_valuetype type;
+  sendGroupCarrier* c = new sendGroupCarrier;
+
+  napi_value promise;
+  c->status = napi_create_promise(env, &c->_deferred, &promise);
+  REJECT_RETURN;
+
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value thisValue;
+  c->status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  REJECT_RETURN;
+
+  sendGroupInstance* g;
+  c->status = getSendGroupInstance(env, thisValue, &g);
+  REJECT_RETURN;
+  napi_value members;
+  c->status = napi_get_reference_value(env, g->senders, &members);
+  REJECT_RETURN;
+  std::vector<sendInstance*> senders;
+  for ( uint32_t x = 0 ; x < g->length ; x++ ) {
+    napi_value element;
+    c->status = napi_get_element(env, members, x, &element);
     REJECT_RETURN;
-    if (type != napi_number) REJECT_ERROR_RETURN(
-      "pictureAspectRatio value must be a number",
+    sendInstance* s;
+    if (getSendInstance(env, element, &s) != napi_ok) REJECT_ERROR_RETURN(
+      "A sender in the group has been destroyed.",
       GRANDIOSE_INVALID_ARGS);
-    double pictureAspectRatio;
-    c->status = napi_get_value_double(env, param, &pictureAspectRatio);
-    REJECT_RETURN;
-    c->videoFrame.picture_aspect_ratio = (float) pictureAspectRatio;
+    if (s->playout != nullptr) REJECT_ERROR_RETURN(
+      "A sender in the group is playing a file or test signal.",
+      GRANDIOSE_INVALID_ARGS);
+    senders.push_back(s);
+  }
+  // The buffer is tracked against the first sender, and its pool
+  c->instance = senders.front();
+  retainSend(c->instance);
 
-    c->videoFrame.timecode = NDIlib_send_timecode_synthesize;
-    c->status = napi_get_named_property(env, config, "timecode", &param);
-    REJECT_RETURN;
-    c->status = napi_typeof(env, param, &type);
-    REJECT_RETURN;
-    if (type != napi_undefined) {
-        if (type == napi_number) {
-            c->status = napi_get_value_int64(env, param, &c->videoFrame.timecode);
-            REJECT_RETURN;
-        }
-        else if (type == napi_bigint) {
-            bool lossless;
-            c->status = napi_get_value_bigint_int64(env, param, &c->videoFrame.timecode, &lossless);
-            REJECT_RETURN;
-        }
-        else
-            REJECT_ERROR_RETURN("timecode value must be a number or bigint", GRANDIOSE_INVALID_ARGS);
+  if (argc < 1) REJECT_ERROR_RETURN(
+    "frame not provided",
+    GRANDIOSE_INVALID_ARGS);
+  napi_value config = args[0];
+  c->status = napi_typeof(env, config, &type);
+  REJECT_RETURN;
+  if (type != napi_object) REJECT_ERROR_RETURN(
+    "frame must be an object",
+    GRANDIOSE_INVALID_ARGS);
+
+  parseVideoFormat(env, config, &c->videoFrame, c);
+  REJECT_RETURN;
+  parseVideoRegion(env, config, &c->videoFrame, &c->region, c);
+  REJECT_RETURN;
+  parseVideoConversion(env, config, &c->videoFrame, &c->convertTo, &c->colorMatrix, c);
+  REJECT_RETURN;
+
+  napi_value param;
+  c->status = napi_get_named_property(env, config, "timecode", &param);
+  REJECT_RETURN;
+  parseTimecode(env, param, &c->videoFrame.timecode, c);
+  REJECT_RETURN;
+
+  c->status = napi_get_named_property(env, config, "data", &param);
+  REJECT_RETURN;
+  setVideoData(env, param, c);
+  REJECT_RETURN;
+  // Pool frames of other senders in the group are tracked too
+  for ( size_t x = 1 ; (x < senders.size()) && (c->sourceFrame == nullptr) ; x++ ) {
+    for ( auto f : senders[x]->pool ) {
+      if ((c->videoFrame.p_data >= f->data) && (c->videoFrame.p_data < f->data + f->size)) {
+        f->inFlight++;
+        c->sourceFrame = f;
+        break;
+      }
     }
+  }
 
-    /*  initialize also timestamp (receiver-side only) and metadata  */
-    c->videoFrame.timestamp = 0;
-    c->videoFrame.p_metadata = NULL;
+  parseFrameMetadata(env, config, c);
+  REJECT_RETURN;
+  c->videoFrame.p_metadata = c->frameMetadata;
+
+  // Each part shares the group's buffer and metadata. A frame dropped as it
+  // is queued settles straight away, so the group is held until all are.
+  c->pending = (uint32_t) senders.size() + 1;
+  for ( auto s : senders ) {
+    sendDataCarrier* part = new sendDataCarrier;
+    part->instance = s;
+    retainSend(s);
+    part->send = s->send;
+    part->group = c;
+    part->synchronous = true;
+    part->videoFrame = c->videoFrame;
+    part->region = c->region;
+    part->convertTo = c->convertTo;
+    part->colorMatrix = c->colorMatrix;
+    if (queueSendWork(env, part, videoSendExecute, groupVideoComplete) != napi_ok) {
+      tidyCarrier(env, part);
+      c->status = GRANDIOSE_ASYNC_FAILURE;
+      c->errorMsg = "Failed to queue video frame for a sender in the group.";
+      settleGroupSend(env, c);
+    }
+  }
+  settleGroupSend(env, c);
 
-    c->status = napi_get_named_property(env, config, "frameFormatType", &param);
-    REJECT_RETURN;
-    c->status = napi_typeof(env, param, &type);
-    REJECT_RETURN;
-    if (type != napi_number) REJECT_ERROR_RETURN(
-      "frameFormatType value must be a number",
-      GRANDIOSE_INVALID_ARGS);
-    int32_t formatType;
-    c->status = napi_get_value_int32(env, param, &formatType);
-    REJECT_RETURN;
-    // TODO: checks
-    c->videoFrame.frame_format_type = (NDIlib_frame_format_type_e) formatType;
+  return promise;
+}
 
-    c->status = napi_get_named_property(env, config, "lineStrideBytes", &param);
-    REJECT_RETURN;
-    c->status = napi_typeof(env, param, &type);
-    REJECT_RETURN;
-    if (type != napi_number) REJECT_ERROR_RETURN(
-      "lineStrideBytes value must be a number",
-      GRANDIOSE_INVALID_ARGS);
-    c->status = napi_get_value_int32(env, param, &c->videoFrame.line_stride_in_bytes);
-    REJECT_RETURN;
+void finalizeSendGroup(napi_env env, void* data, void* hint) {
+  sendGroupInstance* g = (sendGroupInstance*) data;
+  if (g->senders != nullptr) napi_delete_reference(env, g->senders);
+  delete g;
+}
 
-    napi_value videoBuffer;
-    c->status = napi_get_named_property(env, config, "data", &videoBuffer);
-    REJECT_RETURN;
-    c->status = napi_is_buffer(env, videoBuffer, &isBuffer);
-    REJECT_RETURN;
-    if (!isBuffer) REJECT_ERROR_RETURN(
-      "data must be provided as a Node Buffer",
-      GRANDIOSE_INVALID_ARGS);
-    void * data;
-    size_t length;
-    c->status = napi_get_buffer_info(env, videoBuffer, &data, &length);
-    REJECT_RETURN;
-    c->videoFrame.p_data = (uint8_t*) data;
-    c->status = napi_create_reference(env, videoBuffer, 1, &c->sourceBufferRef);
-    REJECT_RETURN;
-    // TODO: check length
+// grandiose.sendGroup(senders) groups senders so that each frame is checked
+// once and sent by all of them.
+napi_value sendGroup(napi_env env, napi_callback_info info) {
+  napi_status status;
+  bool isArray;
+
+  size_t argc = 1;
+  napi_value args[1];
+  status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+  CHECK_STATUS;
+  if (argc < 1)
+    NAPI_THROW_ERROR("Send group must be created with an array of senders.");
+  status = napi_is_array(env, args[0], &isArray);
+  CHECK_STATUS;
+  if (!isArray)
+    NAPI_THROW_ERROR("Send group must be created with an array of senders.");
+
+  uint32_t length;
+  status = napi_get_array_length(env, args[0], &length);
+  CHECK_STATUS;
+  if (length == 0)
+    NAPI_THROW_ERROR("Send group must contain at least one sender.");
+
+  // Kept privately, so that the members cannot change after validation
+  napi_value members;
+  status = napi_create_array_with_length(env, length, &members);
+  CHECK_STATUS;
+  std::vector<sendInstance*> senders;
+  for ( uint32_t x = 0 ; x < length ; x++ ) {
+    napi_value element;
+    status = napi_get_element(env, args[0], x, &element);
+    CHECK_STATUS;
+    status = napi_set_element(env, members, x, element);
+    CHECK_STATUS;
+    napi_valuetype type;
+    status = napi_typeof(env, element, &type);
+    CHECK_STATUS;
+    sendInstance* s = nullptr;
+    if (type == napi_object) {
+      status = getSendInstance(env, element, &s);
+      if (status != napi_ok) s = nullptr;
+    }
+    if (s == nullptr)
+      NAPI_THROW_ERROR("Send group members must be senders that have not been destroyed.");
+    if (std::find(senders.begin(), senders.end(), s) != senders.end())
+      NAPI_THROW_ERROR("Send group members must be distinct.");
+    senders.push_back(s);
+  }
+
+  sendGroupInstance* g = new sendGroupInstance;
+  g->length = length;
+  napi_value result, embedded;
+  status = napi_create_external(env, g, finalizeSendGroup, nullptr, &embedded);
+  if (status != napi_ok) finalizeSendGroup(env, g, nullptr);
+  CHECK_STATUS;
+  status = napi_create_reference(env, members, 1, &g->senders);
+  CHECK_STATUS;
+
+  status = napi_create_object(env, &result);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "embedded", embedded);
+  CHECK_STATUS;
+
+  napi_value videoFn;
+  status = napi_create_function(env, "video", NAPI_AUTO_LENGTH, groupVideoSend,
+    nullptr, &videoFn);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "video", videoFn);
+  CHECK_STATUS;
+
+  napi_value copy;
+  status = napi_create_array_with_length(env, length, &copy);
+  CHECK_STATUS;
+  for ( uint32_t x = 0 ; x < length ; x++ ) {
+    napi_value element;
+    status = napi_get_element(env, members, x, &element);
+    CHECK_STATUS;
+    status = napi_set_element(env, copy, x, element);
+    CHECK_STATUS;
+  }
+  status = napi_set_named_property(env, result, "senders", copy);
+  CHECK_STATUS;
+
+  return result;
+}
+
+void videoFlushExecute(napi_env env, void* data) {
+  sendDataCarrier* c = (sendDataCarrier*) data;
+  sendInstance* s = c->instance;
+
+  // A NULL frame waits until NDI has finished with the last async frame
+  if (s->asyncBufferRef != nullptr) {
+    NDIlib_send_send_video_async_v2(c->send, NULL);
+    c->releaseBufferRef = s->asyncBufferRef;
+    c->releaseFrame = s->asyncFrame;
+    c->releaseMetadata = s->asyncMetadata;
+    s->asyncBufferRef = nullptr;
+    s->asyncFrame = nullptr;
+    s->asyncMetadata = nullptr;
+  }
+}
+
+void videoFlushComplete(napi_env env, napi_status asyncStatus, void* data) {
+  sendDataCarrier* c = (sendDataCarrier*) data;
+  napi_value result;
+  napi_status status;
+
+  if (asyncStatus != napi_ok) {
+    c->status = asyncStatus;
+    c->errorMsg = "Async video flush failed to complete.";
+  }
+  REJECT_STATUS;
+
+  c->status = napi_get_undefined(env, &result);
+  REJECT_STATUS;
+  status = napi_resolve_deferred(env, c->_deferred, result);
+  FLOATING_STATUS;
+
+  tidyCarrier(env, c);
+}
+
+// sender.flush() resolves once NDI has finished reading the buffer of the
+// last asynchronously sent video frame, so that it can be safely reused.
+napi_value videoFlush(napi_env env, napi_callback_info info) {
+  sendDataCarrier* c = new sendDataCarrier;
+
+  napi_value promise;
+  c->status = napi_create_promise(env, &c->_deferred, &promise);
+  REJECT_RETURN;
+
+  size_t argc = 0;
+  napi_value thisValue;
+  c->status = napi_get_cb_info(env, info, &argc, nullptr, &thisValue, nullptr);
+  REJECT_RETURN;
+
+  c->status = getSendInstance(env, thisValue, &c->instance);
+  REJECT_RETURN;
+  retainSend(c->instance);
+  c->send = c->instance->send;
+
+  c->droppable = false;
+  c->status = queueSendWork(env, c, videoFlushExecute, videoFlushComplete);
+  REJECT_RETURN;
+
+  return promise;
+}
+
+void audioSendExecute(napi_env env, void* data) {
+  sendDataCarrier* c = (sendDataCarrier*) data;
+  sendInstance* s = c->instance;
+
+  NDIlib_send_send_audio_v3(c->send, &c->audioFrame);
+  // Silence sent with a held frame takes the format of the last audio
+  s->holdAudioSent = true;
+  s->holdSampleRate = c->audioFrame.sample_rate;
+  s->holdChannels = c->audioFrame.no_channels;
+}
+
+void audioSendComplete(napi_env env, napi_status asyncStatus, void* data) {
+  sendDataCarrier* c = (sendDataCarrier*) data;
+  napi_value result;
+  napi_status status;
+
+  if (asyncStatus != napi_ok) {
+    c->status = asyncStatus;
+    c->errorMsg = "Async audio frame send failed to complete.";
+  }
+  REJECT_STATUS;
+
+  c->status = napi_create_object(env, &result);
+  REJECT_STATUS;
+  status = napi_resolve_deferred(env, c->_deferred, result);
+  FLOATING_STATUS;
+
+  tidyCarrier(env, c);
+}
+
+napi_value audioSend(napi_env env, napi_callback_info info) {
+  napi_valuetype type;
+  sendDataCarrier* c = new sendDataCarrier;
+
+  napi_value promise;
+  c->status = napi_create_promise(env, &c->_deferred, &promise);
+  REJECT_RETURN;
+
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value thisValue;
+  c->status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  REJECT_RETURN;
+
+  c->status = getSendInstance(env, thisValue, &c->instance);
+  REJECT_RETURN;
+  retainSend(c->instance);
+  c->send = c->instance->send;
+  if (c->instance->playout != nullptr) REJECT_ERROR_RETURN(
+    "Sender is playing a file or test signal.",
+    GRANDIOSE_INVALID_ARGS);
+
+  if (argc >= 1) {
+    napi_value config;
+    config = args[0];
+    c->status = napi_typeof(env, config, &type);
+    REJECT_RETURN;
+    if (type != napi_object) REJECT_ERROR_RETURN(
+      "frame must be an object",
+      GRANDIOSE_INVALID_ARGS);
+
+    bool isArray, isBuffer;
+    c->status = napi_is_array(env, config, &isArray);
+    REJECT_RETURN;
+    if (isArray) REJECT_ERROR_RETURN(
+      "Argument to audio send cannot be an array.",
+      GRANDIOSE_INVALID_ARGS);
+
+    napi_value param;
+    c->status = napi_get_named_property(env, config, "sampleRate", &param);
+    REJECT_RETURN;
+    c->status = napi_typeof(env, param, &type);
+    REJECT_RETURN;
+    if (type != napi_number) REJECT_ERROR_RETURN(
+      "sampleRate value must be a number",
+      GRANDIOSE_INVALID_ARGS);
+    c->status = napi_get_value_int32(env, param, &c->audioFrame.sample_rate);
+    REJECT_RETURN;
+
+    c->status = napi_get_named_property(env, config, "noChannels", &param);
+    REJECT_RETURN;
+    c->status = napi_typeof(env, param, &type);
+    REJECT_RETURN;
+    if (type != napi_number) REJECT_ERROR_RETURN(
+      "noChannels value must be a number",
+      GRANDIOSE_INVALID_ARGS);
+    c->status = napi_get_value_int32(env, param, &c->audioFrame.no_channels);
+    REJECT_RETURN;
+
+    c->status = napi_get_named_property(env, config, "noSamples", &param);
+    REJECT_RETURN;
+    c->status = napi_typeof(env, param, &type);
+    REJECT_RETURN;
+    if (type != napi_number) REJECT_ERROR_RETURN(
+      "Samples value must be a number",
+      GRANDIOSE_INVALID_ARGS);
+    c->status = napi_get_value_int32(env, param, &c->audioFrame.no_samples);
+    REJECT_RETURN;
+
+    c->audioFrame.timecode = NDIlib_send_timecode_synthesize;
+    c->status = napi_get_named_property(env, config, "timecode", &param);
+    REJECT_RETURN;
+    c->status = napi_typeof(env, param, &type);
+    REJECT_RETURN;
+    if (type != napi_undefined) {
+        if (type == napi_number) {
+            c->status = napi_get_value_int64(env, param, &c->audioFrame.timecode);
+            REJECT_RETURN;
+        }
+        else if (type == napi_bigint) {
+            bool lossless;
+            c->status = napi_get_value_bigint_int64(env, param, &c->audioFrame.timecode, &lossless);
+            REJECT_RETURN;
+        }
+        else
+            REJECT_ERROR_RETURN("timecode value must be a number or bigint", GRANDIOSE_INVALID_ARGS);
+    }
+
+    /*  initialize also timestamp (receiver-side only) and metadata  */
+    c->audioFrame.timestamp = 0;
+    c->audioFrame.p_metadata = NULL;
+
+    c->status = napi_get_named_property(env, config, "channelStrideBytes", &param);
+    REJECT_RETURN;
+    c->status = napi_typeof(env, param, &type);
+    REJECT_RETURN;
+    if (type != napi_number) REJECT_ERROR_RETURN(
+      "channelStrideBytes value must be a number",
+      GRANDIOSE_INVALID_ARGS);
+    c->status = napi_get_value_int32(env, param, &c->audioFrame.channel_stride_in_bytes);
+    REJECT_RETURN;
+
+    napi_value audioBuffer;
+    c->status = napi_get_named_property(env, config, "data", &audioBuffer);
+    REJECT_RETURN;
+    c->status = napi_is_buffer(env, audioBuffer, &isBuffer);
+    REJECT_RETURN;
+    if (!isBuffer) REJECT_ERROR_RETURN(
+      "data must be provided as a Node Buffer",
+      GRANDIOSE_INVALID_ARGS);
+    void * data;
+    size_t length;
+    c->status = napi_get_buffer_info(env, audioBuffer, &data, &length);
+    REJECT_RETURN;
+    c->audioFrame.p_data = (uint8_t *) data;
+    c->status = napi_create_reference(env, audioBuffer, 1, &c->sourceBufferRef);
+    REJECT_RETURN;
+
+    parseFrameMetadata(env, config, c);
+    REJECT_RETURN;
+    c->audioFrame.p_metadata = c->frameMetadata;
+
+    c->status = napi_get_named_property(env, config, "fourCC", &param);
+    REJECT_RETURN;
+    c->status = napi_typeof(env, param, &type);
+    REJECT_RETURN;
+    if (type != napi_number) REJECT_ERROR_RETURN(
+      "fourCC value must be a number",
+      GRANDIOSE_INVALID_ARGS);
+    int32_t fourCC;
+    c->status = napi_get_value_int32(env, param, &fourCC);
+    REJECT_RETURN;
+    c->audioFrame.FourCC = (NDIlib_FourCC_audio_type_e)fourCC;
+
+  } else REJECT_ERROR_RETURN(
+      "frame not provided",
+    GRANDIOSE_INVALID_ARGS);
+
+  c->status = queueSendWork(env, c, audioSendExecute, audioSendComplete);
+  REJECT_RETURN;
+
+  return promise;
+}
+
+// Reads an optional integer property, leaving value unchanged if undefined
+void parseOptionalInt32(napi_env env, napi_value config, const char* name,
+    int32_t* value, carrier* c) {
+  napi_valuetype type;
+  napi_value param;
+  c->status = napi_get_named_property(env, config, name, &param);
+  CARRIER_STATUS;
+  c->status = napi_typeof(env, param, &type);
+  CARRIER_STATUS;
+  if (type == napi_undefined) return;
+  if (type != napi_number) {
+    c->errorMsg = std::string(name) + " value must be a number";
+    c->status = GRANDIOSE_INVALID_ARGS;
+    return;
+  }
+  c->status = napi_get_value_int32(env, param, value);
+  CARRIER_STATUS;
+}
+
+// sender.configureAudio(format) starts muxing audio added with
+// sender.audioData() into the video, sending with each video frame the
+// audio that spans it. Calling it again with the same format moves the
+// buffered audio by the change in offset.
+napi_value configureAudio(napi_env env, napi_callback_info info) {
+  napi_valuetype type;
+  carrier* c = new carrier;
+
+  napi_value promise;
+  c->status = napi_create_promise(env, &c->_deferred, &promise);
+  REJECT_RETURN;
+
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value thisValue;
+  c->status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  REJECT_RETURN;
+
+  sendInstance* s;
+  c->status = getSendInstance(env, thisValue, &s);
+  REJECT_RETURN;
+
+  if (argc < 1) REJECT_ERROR_RETURN(
+    "audio format not provided",
+    GRANDIOSE_INVALID_ARGS);
+  c->status = napi_typeof(env, args[0], &type);
+  REJECT_RETURN;
+  if (type != napi_object) REJECT_ERROR_RETURN(
+    "audio format must be an object",
+    GRANDIOSE_INVALID_ARGS);
+
+  int32_t sampleRate = 0, noChannels = 0, offset = 0, bufferSamples = -1;
+  parseOptionalInt32(env, args[0], "sampleRate", &sampleRate, c);
+  REJECT_RETURN;
+  if (sampleRate <= 0) REJECT_ERROR_RETURN(
+    "sampleRate must be a positive number",
+    GRANDIOSE_INVALID_ARGS);
+  parseOptionalInt32(env, args[0], "noChannels", &noChannels, c);
+  REJECT_RETURN;
+  if (noChannels <= 0) REJECT_ERROR_RETURN(
+    "noChannels must be a positive number",
+    GRANDIOSE_INVALID_ARGS);
+  parseOptionalInt32(env, args[0], "offset", &offset, c);
+  REJECT_RETURN;
+  // One second by default
+  parseOptionalInt32(env, args[0], "bufferSamples", &bufferSamples, c);
+  REJECT_RETURN;
+  if (bufferSamples == -1) bufferSamples = sampleRate;
+  if (bufferSamples <= 0) REJECT_ERROR_RETURN(
+    "bufferSamples must be a positive number",
+    GRANDIOSE_INVALID_ARGS);
+
+  s->mux.configure(sampleRate, noChannels, (uint32_t) bufferSamples, offset);
+
+  napi_value undefined;
+  c->status = napi_get_undefined(env, &undefined);
+  REJECT_RETURN;
+  c->status = napi_resolve_deferred(env, c->_deferred, undefined);
+  REJECT_RETURN;
+  tidyCarrier(env, c);
+
+  return promise;
+}
+
+// sender.audioData(data) copies planar 32-bit float audio, of any number of
+// samples, into the buffer of a sender set up with configureAudio(). Returns
+// the number of samples per channel now buffered.
+napi_value audioDataSend(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  CHECK_STATUS;
+
+  sendInstance* s;
+  status = getSendInstance(env, thisValue, &s);
+  CHECK_STATUS;
+  if (!s->mux.enabled())
+    NAPI_THROW_ERROR("Audio format must be set with configureAudio before sending audio data.");
+
+  bool isBuffer = false;
+  if (argc >= 1) {
+    status = napi_is_buffer(env, args[0], &isBuffer);
+    CHECK_STATUS;
+  }
+  if (!isBuffer)
+    NAPI_THROW_ERROR("Audio data must be provided as a Node Buffer.");
+  void* data;
+  size_t length;
+  status = napi_get_buffer_info(env, args[0], &data, &length);
+  CHECK_STATUS;
+
+  size_t channelStride = length / s->mux.channels();
+  if ((channelStride * s->mux.channels() != length) || (channelStride % sizeof(float) != 0))
+    NAPI_THROW_ERROR("Audio data must hold the same whole number of 32-bit float samples for each channel.");
+  s->mux.push((const float*) data, (uint32_t) (channelStride / sizeof(float)),
+    (int32_t) channelStride);
+
+  napi_value result;
+  status = napi_create_uint32(env, s->mux.buffered, &result);
+  CHECK_STATUS;
+  return result;
+}
+
+void metadataSendExecute(napi_env env, void* data) {
+  sendDataCarrier* c = (sendDataCarrier*) data;
+
+  for ( auto& m : c->metadata ) {
+    c->metadataFrame.p_data = (char*) m.c_str();
+    c->metadataFrame.length = (int) m.length() + 1;
+    NDIlib_send_send_metadata(c->send, &c->metadataFrame);
+  }
+}
+
+void metadataSendComplete(napi_env env, napi_status asyncStatus, void* data) {
+  sendDataCarrier* c = (sendDataCarrier*) data;
+  napi_value result;
+  napi_status status;
+
+  if (asyncStatus != napi_ok) {
+    c->status = asyncStatus;
+    c->errorMsg = "Async metadata send failed to complete.";
+  }
+  REJECT_STATUS;
+
+  c->status = napi_create_object(env, &result);
+  REJECT_STATUS;
+  status = napi_resolve_deferred(env, c->_deferred, result);
+  FLOATING_STATUS;
+
+  tidyCarrier(env, c);
+}
+
+// sender.metadata(data, timecode?) sends an XML metadata frame. Given an
+// array of strings, all are sent as one piece of work on the send thread.
+napi_value metadataSend(napi_env env, napi_callback_info info) {
+  napi_valuetype type;
+  sendDataCarrier* c = new sendDataCarrier;
+
+  napi_value promise;
+  c->status = napi_create_promise(env, &c->_deferred, &promise);
+  REJECT_RETURN;
+
+  size_t argc = 2;
+  napi_value args[2];
+  napi_value thisValue;
+  c->status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  REJECT_RETURN;
+
+  c->status = getSendInstance(env, thisValue, &c->instance);
+  REJECT_RETURN;
+  retainSend(c->instance);
+  c->send = c->instance->send;
+
+  if (argc < 1) REJECT_ERROR_RETURN(
+    "metadata not provided",
+    GRANDIOSE_INVALID_ARGS);
+
+  bool isArray;
+  c->status = napi_is_array(env, args[0], &isArray);
+  REJECT_RETURN;
+  uint32_t count = 1;
+  if (isArray) {
+    c->status = napi_get_array_length(env, args[0], &count);
+    REJECT_RETURN;
+  }
+  c->metadata.reserve(count);
+  for ( uint32_t x = 0 ; x < count ; x++ ) {
+    napi_value item = args[0];
+    if (isArray) {
+      c->status = napi_get_element(env, args[0], x, &item);
+      REJECT_RETURN;
+    }
+    c->status = napi_typeof(env, item, &type);
+    REJECT_RETURN;
+    if (type != napi_string) REJECT_ERROR_RETURN(
+      "metadata must be a string or an array of strings",
+      GRANDIOSE_INVALID_ARGS);
+    size_t length;
+    c->status = napi_get_value_string_utf8(env, item, nullptr, 0, &length);
+    REJECT_RETURN;
+    std::string value(length, '\0');
+    c->status = napi_get_value_string_utf8(env, item, &value[0], length + 1, &length);
+    REJECT_RETURN;
+    c->metadata.push_back(std::move(value));
+  }
+
+  c->metadataFrame.timecode = NDIlib_send_timecode_synthesize;
+  if (argc >= 2) {
+    parseTimecode(env, args[1], &c->metadataFrame.timecode, c);
+    REJECT_RETURN;
+  }
+
+  c->status = queueSendWork(env, c, metadataSendExecute, metadataSendComplete);
+  REJECT_RETURN;
+
+  return promise;
+}
+
+napi_value connections(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  CHECK_STATUS;
+
+  sendInstance* s;
+  status = getSendInstance(env, thisValue, &s);
+  CHECK_STATUS;
+  NDIlib_send_instance_t sender = s->send;
+
+  int conns = NDIlib_send_get_no_connections(sender, 0);
+  napi_value result;
+  status = napi_create_int32(env, (int32_t)conns, &result);
+  CHECK_STATUS;
+
+  return result;
+}
+
+napi_value tally(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  CHECK_STATUS;
+
+  sendInstance* s;
+  status = getSendInstance(env, thisValue, &s);
+  CHECK_STATUS;
+  NDIlib_send_instance_t sender = s->send;
+
+  NDIlib_tally_t tally;
+  bool changed = NDIlib_send_get_tally(sender, &tally, 0);
+
+  napi_value result;
+  status = napi_create_object(env, &result);
+  CHECK_STATUS;
+
+  napi_value value;
+  napi_get_boolean(env, changed, &value);
+  status = napi_set_named_property(env, result, "changed", value);
+  CHECK_STATUS;
+  napi_get_boolean(env, tally.on_program, &value);
+  status = napi_set_named_property(env, result, "on_program", value);
+  CHECK_STATUS;
+  napi_get_boolean(env, tally.on_preview, &value);
+  status = napi_set_named_property(env, result, "on_preview", value);
+  CHECK_STATUS;
+
+  return result;
+}
+
+napi_value sourcename(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  CHECK_STATUS;
+
+  sendInstance* s;
+  status = getSendInstance(env, thisValue, &s);
+  CHECK_STATUS;
+  NDIlib_send_instance_t sender = s->send;
+
+  const NDIlib_source_t *source = NDIlib_send_get_source_name(sender);
+  napi_value result;
+  status = napi_create_string_utf8(env, source->p_ndi_name, NAPI_AUTO_LENGTH, &result);
+  CHECK_STATUS;
+
+  return result;
+}
+
+// sender.stats() reports the state of the sender's queue and counts of
+// frames submitted, sent and dropped by the overflow policy, and of frames
+// repeated by holdLastFrame.
+napi_value sendStats(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 0;
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, &argc, nullptr, &thisValue, nullptr);
+  CHECK_STATUS;
+
+  sendInstance* s;
+  status = getSendInstance(env, thisValue, &s);
+  CHECK_STATUS;
+
+  const char* overflow =
+    (s->overflow == Grandiose_overflow_drop_oldest) ? "drop-oldest" :
+    (s->overflow == Grandiose_overflow_drop_newest) ? "drop-newest" : "block";
+
+  napi_value result, param;
+  status = napi_create_object(env, &result);
+  CHECK_STATUS;
+
+  status = napi_create_uint32(env, s->queue->depth, &param);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "queueDepth", param);
+  CHECK_STATUS;
+  status = napi_create_string_utf8(env, overflow, NAPI_AUTO_LENGTH, &param);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "overflow", param);
+  CHECK_STATUS;
+  status = napi_create_uint32(env, s->queue->size(), &param);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "queued", param);
+  CHECK_STATUS;
+  status = napi_create_uint32(env, (uint32_t) s->waiting.size(), &param);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "waiting", param);
+  CHECK_STATUS;
+  status = napi_create_double(env, (double) s->submitted, &param);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "submitted", param);
+  CHECK_STATUS;
+  status = napi_create_double(env, (double) s->sent, &param);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "sent", param);
+  CHECK_STATUS;
+  status = napi_create_double(env, (double) s->dropped, &param);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "dropped", param);
+  CHECK_STATUS;
+  if (s->holdLastFrame) {
+    status = napi_create_double(env, (double) s->repeated, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, result, "repeated", param);
+    CHECK_STATUS;
+    status = napi_create_double(env, (double) s->stalls, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, result, "stalls", param);
+    CHECK_STATUS;
+  }
+  if (s->mux.enabled()) {
+    status = napi_create_uint32(env, s->mux.buffered, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, result, "audioBuffered", param);
+    CHECK_STATUS;
+    status = napi_create_double(env, (double) s->mux.silence, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, result, "audioSilence", param);
+    CHECK_STATUS;
+    status = napi_create_double(env, (double) s->mux.discarded, &param);
+    CHECK_STATUS;
+    status = napi_set_named_property(env, result, "audioDiscarded", param);
+    CHECK_STATUS;
+  }
+
+  return result;
+}
+
+void finalizePoolFrame(napi_env env, void* data, void* hint) {
+  poolFrame* f = (poolFrame*) hint;
+  freeFrameMemory(f->data, f->size, f->huge);
+  delete f;
+}
+
+// sender.allocateFrames(count, { size, hugePages }) adds frames to the
+// sender's pool, returning them as Buffers. The size defaults to that of the
+// format set with configureVideo().
+napi_value allocateFrames(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_valuetype type;
+
+  size_t argc = 2;
+  napi_value args[2];
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  CHECK_STATUS;
+
+  sendInstance* s;
+  status = getSendInstance(env, thisValue, &s);
+  CHECK_STATUS;
+
+  if (argc < 1)
+    NAPI_THROW_ERROR("Number of frames to allocate must be provided.");
+  status = napi_typeof(env, args[0], &type);
+  CHECK_STATUS;
+  if (type != napi_number)
+    NAPI_THROW_ERROR("Number of frames to allocate must be a number.");
+  uint32_t count;
+  status = napi_get_value_uint32(env, args[0], &count);
+  CHECK_STATUS;
+
+  size_t size = 0;
+  // Sized as setVideoData checks frames, including planes after the first
+  if (s->videoConfigured)
+    size = videoFrameBytes(s->videoFormat.FourCC, s->videoFormat.xres, s->videoFormat.yres,
+      s->videoFormat.line_stride_in_bytes);
+  bool hugePages = false;
+  if (argc >= 2) {
+    status = napi_typeof(env, args[1], &type);
+    CHECK_STATUS;
+    if (type != napi_object)
+      NAPI_THROW_ERROR("Frame options must be an object.");
+
+    napi_value param;
+    status = napi_get_named_property(env, args[1], "size", &param);
+    CHECK_STATUS;
+    status = napi_typeof(env, param, &type);
+    CHECK_STATUS;
+    if (type == napi_number) {
+      int64_t value;
+      status = napi_get_value_int64(env, param, &value);
+      CHECK_STATUS;
+      size = value > 0 ? (size_t) value : 0;
+    }
+    else if (type != napi_undefined)
+      NAPI_THROW_ERROR("Frame size must be a number if present.");
+
+    status = napi_get_named_property(env, args[1], "hugePages", &param);
+    CHECK_STATUS;
+    status = napi_typeof(env, param, &type);
+    CHECK_STATUS;
+    if (type == napi_boolean) {
+      status = napi_get_value_bool(env, param, &hugePages);
+      CHECK_STATUS;
+    }
+    else if (type != napi_undefined)
+      NAPI_THROW_ERROR("HugePages must be a boolean if present.");
+  }
+  if (size == 0)
+    NAPI_THROW_ERROR("Frame size must be given or set with configureVideo.");
+
+  napi_value result;
+  status = napi_create_array_with_length(env, count, &result);
+  CHECK_STATUS;
+
+  for ( uint32_t x = 0 ; x < count ; x++ ) {
+    poolFrame* f = new poolFrame;
+    f->size = size;
+    f->data = (uint8_t*) allocateFrameMemory(size, hugePages, &f->huge);
+    if (f->data == nullptr) {
+      delete f;
+      NAPI_THROW_ERROR("Failed to allocate frame memory.");
+    }
+    // Touch every page now rather than when the first frame is rendered
+    memset(f->data, 0, size);
+
+    napi_value buffer;
+    status = napi_create_external_buffer(env, size, f->data, finalizePoolFrame, f, &buffer);
+    if (status != napi_ok) {
+      freeFrameMemory(f->data, f->size, f->huge);
+      delete f;
+    }
+    CHECK_STATUS;
+    status = napi_create_reference(env, buffer, 1, &f->bufferRef);
+    CHECK_STATUS;
+    s->pool.push_back(f);
+
+    status = napi_set_element(env, result, x, buffer);
+    CHECK_STATUS;
+  }
+
+  return result;
+}
+
+// sender.acquireFrame() returns a pool frame that is not in use, or null if
+// all are in use. A frame is in use from being acquired until NDI has
+// finished sending it.
+napi_value acquireFrame(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 0;
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, &argc, nullptr, &thisValue, nullptr);
+  CHECK_STATUS;
+
+  sendInstance* s;
+  status = getSendInstance(env, thisValue, &s);
+  CHECK_STATUS;
+
+  napi_value result;
+  for ( auto f : s->pool ) {
+    if (!f->acquired && (f->inFlight == 0)) {
+      status = napi_get_reference_value(env, f->bufferRef, &result);
+      CHECK_STATUS;
+      f->acquired = true;
+      return result;
+    }
+  }
+
+  status = napi_get_null(env, &result);
+  CHECK_STATUS;
+  return result;
+}
+
+// sender.framePool() reports the occupancy of the sender's frame pool
+napi_value framePool(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 0;
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, &argc, nullptr, &thisValue, nullptr);
+  CHECK_STATUS;
+
+  sendInstance* s;
+  status = getSendInstance(env, thisValue, &s);
+  CHECK_STATUS;
+
+  uint32_t available = 0, acquired = 0, inFlight = 0, huge = 0;
+  double bytes = 0;
+  for ( auto f : s->pool ) {
+    if (f->inFlight > 0) inFlight++;
+    else if (f->acquired) acquired++;
+    else available++;
+    if (f->huge) huge++;
+    bytes += (double) f->size;
+  }
+
+  napi_value result, param;
+  status = napi_create_object(env, &result);
+  CHECK_STATUS;
+
+  status = napi_create_uint32(env, (uint32_t) s->pool.size(), &param);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "frames", param);
+  CHECK_STATUS;
+  status = napi_create_uint32(env, available, &param);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "free", param);
+  CHECK_STATUS;
+  status = napi_create_uint32(env, acquired, &param);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "acquired", param);
+  CHECK_STATUS;
+  status = napi_create_uint32(env, inFlight, &param);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "inFlight", param);
+  CHECK_STATUS;
+  status = napi_create_uint32(env, huge, &param);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "hugePages", param);
+  CHECK_STATUS;
+  status = napi_create_double(env, bytes, &param);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "bytes", param);
+  CHECK_STATUS;
+
+  return result;
+}
+
+struct monitorEvent {
+  bool tally;
+  NDIlib_tally_t state;
+  int connections;
+};
+
+// Body of the per-sender monitor thread. Waiting in NDIlib_send_get_tally
+// wakes the thread as soon as tally changes, with the number of connections
+// checked at least every monitorWait milliseconds.
+void monitorLoop(sendInstance* s) {
+  napi_status status = napi_ok;
+  NDIlib_tally_t lastTally;
+  int lastConnections = -1;
+  bool first = true;
+
+  while (s->monitoring) {
+    monitorEvent* e;
+    NDIlib_tally_t tally;
+    NDIlib_send_get_tally(s->send, &tally, first ? 0 : s->monitorWait);
+    if (first || (tally.on_program != lastTally.on_program) ||
+        (tally.on_preview != lastTally.on_preview)) {
+      lastTally = tally;
+      e = new monitorEvent { true, tally, 0 };
+      status = napi_call_threadsafe_function(s->monitorFn, e, napi_tsfn_blocking);
+      if (status != napi_ok) {
+        delete e;
+        break;
+      }
+    }
+
+    int connections = NDIlib_send_get_no_connections(s->send, 0);
+    if (connections != lastConnections) {
+      lastConnections = connections;
+      e = new monitorEvent { false, tally, connections };
+      status = napi_call_threadsafe_function(s->monitorFn, e, napi_tsfn_blocking);
+      if (status != napi_ok) {
+        delete e;
+        break;
+      }
+    }
+    first = false;
+  }
+
+  if (status != napi_closing) {
+    napi_release_threadsafe_function(s->monitorFn, napi_tsfn_release);
+  }
+}
+
+void monitorCallJS(napi_env env, napi_value callback, void* context, void* data) {
+  monitorEvent* e = (monitorEvent*) data;
+  napi_status status;
+
+  if (env == nullptr) {
+    delete e;
+    return;
+  }
+
+  napi_value event, param, undefined, result;
+  status = napi_create_object(env, &event);
+  FLOATING_STATUS;
+  if (e->tally) {
+    status = napi_create_string_utf8(env, "tally", NAPI_AUTO_LENGTH, &param);
+    FLOATING_STATUS;
+    status = napi_set_named_property(env, event, "type", param);
+    FLOATING_STATUS;
+    status = napi_get_boolean(env, e->state.on_program, &param);
+    FLOATING_STATUS;
+    status = napi_set_named_property(env, event, "on_program", param);
+    FLOATING_STATUS;
+    status = napi_get_boolean(env, e->state.on_preview, &param);
+    FLOATING_STATUS;
+    status = napi_set_named_property(env, event, "on_preview", param);
+    FLOATING_STATUS;
+  } else {
+    status = napi_create_string_utf8(env, "connections", NAPI_AUTO_LENGTH, &param);
+    FLOATING_STATUS;
+    status = napi_set_named_property(env, event, "type", param);
+    FLOATING_STATUS;
+    status = napi_create_int32(env, e->connections, &param);
+    FLOATING_STATUS;
+    status = napi_set_named_property(env, event, "connections", param);
+    FLOATING_STATUS;
+  }
+
+  status = napi_get_undefined(env, &undefined);
+  FLOATING_STATUS;
+  status = napi_call_function(env, undefined, callback, 1, &event, &result);
+  FLOATING_STATUS;
+
+  delete e;
+}
+
+void monitorFinalize(napi_env env, void* data, void* hint) {
+  sendInstance* s = (sendInstance*) hint;
+  napi_status status;
+
+  s->monitoring = false;
+  if (s->monitorThread.joinable()) {
+    s->monitorThread.join();
+  }
+  s->monitorFn = nullptr;
+
+  if (s->monitorStopped != nullptr) {
+    napi_value undefined;
+    status = napi_get_undefined(env, &undefined);
+    FLOATING_STATUS;
+    status = napi_resolve_deferred(env, s->monitorStopped, undefined);
+    FLOATING_STATUS;
+    s->monitorStopped = nullptr;
+  }
+
+  releaseSend(s);
+}
 
+// sender.startMonitor(listener, [{ wait }]) starts a native thread that calls
+// the listener with 'tally' and 'connections' events as they change, starting
+// with the current state.
+napi_value monitorStart(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_valuetype type;
 
-    c->status = napi_get_named_property(env, config, "fourCC", &param);
-    REJECT_RETURN;
-    c->status = napi_typeof(env, param, &type);
-    REJECT_RETURN;
-    if (type != napi_number) REJECT_ERROR_RETURN(
-      "fourCC value must be a number",
-      GRANDIOSE_INVALID_ARGS);
-    int32_t fourCC;
-    c->status = napi_get_value_int32(env, param, &fourCC);
-    REJECT_RETURN;
-    // TODO: checks
-    c->videoFrame.FourCC = (NDIlib_FourCC_video_type_e) fourCC; // TODO
+  size_t argc = 2;
+  napi_value args[2];
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  CHECK_STATUS;
 
-  } else REJECT_ERROR_RETURN(
-      "frame not provided",
-    GRANDIOSE_INVALID_ARGS);
+  sendInstance* s;
+  status = getSendInstance(env, thisValue, &s);
+  CHECK_STATUS;
+
+  if (s->monitorFn != nullptr)
+    NAPI_THROW_ERROR("Sender monitor is already running.");
+  if (argc < 1)
+    NAPI_THROW_ERROR("Monitor must be started with a listener function.");
+  status = napi_typeof(env, args[0], &type);
+  CHECK_STATUS;
+  if (type != napi_function)
+    NAPI_THROW_ERROR("Monitor must be started with a listener function.");
+
+  uint32_t wait = 100;
+  if (argc >= 2) {
+    status = napi_typeof(env, args[1], &type);
+    CHECK_STATUS;
+    if (type == napi_object) {
+      napi_value param;
+      status = napi_get_named_property(env, args[1], "wait", &param);
+      CHECK_STATUS;
+      status = napi_typeof(env, param, &type);
+      CHECK_STATUS;
+      if (type == napi_number) {
+        status = napi_get_value_uint32(env, param, &wait);
+        CHECK_STATUS;
+      }
+      else if (type != napi_undefined)
+        NAPI_THROW_ERROR("Monitor wait value must be a number if present.");
+    }
+    else if (type != napi_undefined)
+      NAPI_THROW_ERROR("Monitor options must be an object if present.");
+  }
 
   napi_value resource_name;
-  c->status = napi_create_string_utf8(env, "VideoSend", NAPI_AUTO_LENGTH, &resource_name);
+  status = napi_create_string_utf8(env, "SendMonitor", NAPI_AUTO_LENGTH, &resource_name);
+  CHECK_STATUS;
+  status = napi_create_threadsafe_function(env, args[0], nullptr, resource_name,
+    0, 1, nullptr, monitorFinalize, s, monitorCallJS, &s->monitorFn);
+  CHECK_STATUS;
+
+  retainSend(s);
+  s->monitorWait = wait;
+  s->monitoring = true;
+  s->monitorThread = std::thread(monitorLoop, s);
+
+  napi_value undefined;
+  status = napi_get_undefined(env, &undefined);
+  CHECK_STATUS;
+  return undefined;
+}
+
+// sender.stopMonitor() resolves once the monitor thread has finished and its
+// events have been delivered.
+napi_value monitorStop(napi_env env, napi_callback_info info) {
+  carrier* c = new carrier;
+  napi_value promise;
+  c->status = napi_create_promise(env, &c->_deferred, &promise);
   REJECT_RETURN;
-  c->status = napi_create_async_work(env, NULL, resource_name, videoSendExecute,
-    videoSendComplete, c, &c->_request);
+
+  size_t argc = 0;
+  napi_value thisValue;
+  c->status = napi_get_cb_info(env, info, &argc, nullptr, &thisValue, nullptr);
   REJECT_RETURN;
-  c->status = napi_queue_async_work(env, c->_request);
+
+  sendInstance* s;
+  c->status = getSendInstance(env, thisValue, &s);
   REJECT_RETURN;
 
+  if (s->monitorFn == nullptr) {
+    napi_value undefined;
+    napi_get_undefined(env, &undefined);
+    napi_resolve_deferred(env, c->_deferred, undefined);
+  } else if (s->monitorStopped != nullptr) {
+    REJECT_ERROR_RETURN(
+      "Sender monitor is already stopping.",
+      GRANDIOSE_INVALID_ARGS);
+  } else {
+    s->monitorStopped = c->_deferred;
+    s->monitoring = false;
+  }
+
+  delete c;
   return promise;
 }
 
-void audioSendExecute(napi_env env, void* data) {
+// Metadata sent upstream by a receiver, as for metadata frames received
+napi_status makeCapturedMetadata(napi_env env, const std::string& data, int64_t timecode,
+    napi_value* frame) {
+  napi_status status;
+  napi_value result;
+  status = napi_create_object(env, &result);
+  PASS_STATUS;
+
+  napi_value param;
+  status = napi_create_string_utf8(env, "metadata", NAPI_AUTO_LENGTH, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "type", param);
+  PASS_STATUS;
+
+  status = napi_create_int32(env, (int32_t) data.length() + 1, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "length", param);
+  PASS_STATUS;
+
+  napi_value params, paramn;
+  status = napi_create_int32(env, (int32_t) (timecode / 10000000), &params);
+  PASS_STATUS;
+  status = napi_create_int32(env, (timecode % 10000000) * 100, &paramn);
+  PASS_STATUS;
+  status = napi_create_array(env, &param);
+  PASS_STATUS;
+  status = napi_set_element(env, param, 0, params);
+  PASS_STATUS;
+  status = napi_set_element(env, param, 1, paramn);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "timecode", param);
+  PASS_STATUS;
+
+  status = napi_create_string_utf8(env, data.c_str(), data.length(), &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, result, "data", param);
+  PASS_STATUS;
+
+  *frame = result;
+  return napi_ok;
+}
+
+void metadataCaptureExecute(napi_env env, void* data) {
   sendDataCarrier* c = (sendDataCarrier*) data;
 
-  NDIlib_send_send_audio_v3(c->send, &c->audioFrame);
+  switch (NDIlib_send_capture(c->send, &c->metadataFrame, c->wait)) {
+    case NDIlib_frame_type_none:
+      c->status = GRANDIOSE_NOT_FOUND;
+      c->errorMsg = "No metadata received in the requested time interval.";
+      break;
+
+    case NDIlib_frame_type_metadata:
+      c->metadata.emplace_back(c->metadataFrame.p_data != nullptr ?
+        c->metadataFrame.p_data : "");
+      NDIlib_send_free_metadata(c->send, &c->metadataFrame);
+      break;
+
+    default:
+      c->status = GRANDIOSE_NOT_METADATA;
+      c->errorMsg = "Non-metadata payload received on metadata capture.";
+      break;
+  }
 }
 
-void audioSendComplete(napi_env env, napi_status asyncStatus, void* data) {
+void metadataCaptureComplete(napi_env env, napi_status asyncStatus, void* data) {
   sendDataCarrier* c = (sendDataCarrier*) data;
-  napi_value result;
   napi_status status;
 
-  c->status = napi_delete_reference(env, c->sourceBufferRef);
-  REJECT_STATUS;
-
   if (asyncStatus != napi_ok) {
     c->status = asyncStatus;
-    c->errorMsg = "Async audio frame send failed to complete.";
+    c->errorMsg = "Async metadata capture failed to complete.";
   }
   REJECT_STATUS;
 
-  c->status = napi_create_object(env, &result);
+  napi_value result;
+  c->status = makeCapturedMetadata(env, c->metadata[0], c->metadataFrame.timecode, &result);
   REJECT_STATUS;
   status = napi_resolve_deferred(env, c->_deferred, result);
   FLOATING_STATUS;
@@ -556,7 +2911,9 @@ void audioSendComplete(napi_env env, napi_status asyncStatus, void* data) {
   tidyCarrier(env, c);
 }
 
-napi_value audioSend(napi_env env, napi_callback_info info) {
+// sender.captureMetadata(timeout) waits for the next metadata frame sent to
+// this sender by a receiver, such as a PTZ command.
+napi_value metadataCapture(napi_env env, napi_callback_info info) {
   napi_valuetype type;
   sendDataCarrier* c = new sendDataCarrier;
 
@@ -570,223 +2927,199 @@ napi_value audioSend(napi_env env, napi_callback_info info) {
   c->status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
   REJECT_RETURN;
 
-  napi_value sendValue;
-  c->status = napi_get_named_property(env, thisValue, "embedded", &sendValue);
-  REJECT_RETURN;
-  void* sendData;
-  c->status = napi_get_value_external(env, sendValue, &sendData);
-  c->send = (NDIlib_send_instance_t) sendData;
+  c->status = getSendInstance(env, thisValue, &c->instance);
   REJECT_RETURN;
+  retainSend(c->instance);
+  c->send = c->instance->send;
 
   if (argc >= 1) {
-    napi_value config;
-    config = args[0];
-    c->status = napi_typeof(env, config, &type);
-    REJECT_RETURN;
-    if (type != napi_object) REJECT_ERROR_RETURN(
-      "frame must be an object",
-      GRANDIOSE_INVALID_ARGS);
-
-    bool isArray, isBuffer;
-    c->status = napi_is_array(env, config, &isArray);
-    REJECT_RETURN;
-    if (isArray) REJECT_ERROR_RETURN(
-      "Argument to audio send cannot be an array.",
-      GRANDIOSE_INVALID_ARGS);
-
-    napi_value param;
-    c->status = napi_get_named_property(env, config, "sampleRate", &param);
-    REJECT_RETURN;
-    c->status = napi_typeof(env, param, &type);
+    c->status = napi_typeof(env, args[0], &type);
     REJECT_RETURN;
-    if (type != napi_number) REJECT_ERROR_RETURN(
-      "sampleRate value must be a number",
+    if (type == napi_number) {
+      c->status = napi_get_value_uint32(env, args[0], &c->wait);
+      REJECT_RETURN;
+    }
+    else if (type != napi_undefined) REJECT_ERROR_RETURN(
+      "Timeout must be a number if present.",
       GRANDIOSE_INVALID_ARGS);
-    c->status = napi_get_value_int32(env, param, &c->audioFrame.sample_rate);
-    REJECT_RETURN;
+  }
 
-    c->status = napi_get_named_property(env, config, "noChannels", &param);
-    REJECT_RETURN;
-    c->status = napi_typeof(env, param, &type);
-    REJECT_RETURN;
-    if (type != napi_number) REJECT_ERROR_RETURN(
-      "noChannels value must be a number",
-      GRANDIOSE_INVALID_ARGS);
-    c->status = napi_get_value_int32(env, param, &c->audioFrame.no_channels);
-    REJECT_RETURN;
+  c->status = queueNDIWork(env, c, Grandiose_lane_metadata,
+    metadataCaptureExecute, metadataCaptureComplete);
+  REJECT_RETURN;
 
-    c->status = napi_get_named_property(env, config, "noSamples", &param);
-    REJECT_RETURN;
-    c->status = napi_typeof(env, param, &type);
-    REJECT_RETURN;
-    if (type != napi_number) REJECT_ERROR_RETURN(
-      "Samples value must be a number",
-      GRANDIOSE_INVALID_ARGS);
-    c->status = napi_get_value_int32(env, param, &c->audioFrame.no_samples);
-    REJECT_RETURN;
+  return promise;
+}
 
-    c->audioFrame.timecode = NDIlib_send_timecode_synthesize;
-    c->status = napi_get_named_property(env, config, "timecode", &param);
-    REJECT_RETURN;
-    c->status = napi_typeof(env, param, &type);
-    REJECT_RETURN;
-    if (type != napi_undefined) {
-        if (type == napi_number) {
-            c->status = napi_get_value_int64(env, param, &c->audioFrame.timecode);
-            REJECT_RETURN;
-        }
-        else if (type == napi_bigint) {
-            bool lossless;
-            c->status = napi_get_value_bigint_int64(env, param, &c->audioFrame.timecode, &lossless);
-            REJECT_RETURN;
-        }
-        else
-            REJECT_ERROR_RETURN("timecode value must be a number or bigint", GRANDIOSE_INVALID_ARGS);
+struct capturedMetadata {
+  std::string data;
+  int64_t timecode;
+};
+
+// Body of the per-sender metadata capture thread. Messages are copied out of
+// NDI as they arrive and delivered in order.
+void metadataCaptureLoop(sendInstance* s) {
+  napi_status status = napi_ok;
+
+  while (s->capturingMetadata) {
+    NDIlib_metadata_frame_t frame;
+    if (NDIlib_send_capture(s->send, &frame, s->metadataWait) != NDIlib_frame_type_metadata)
+      continue;
+    capturedMetadata* m = new capturedMetadata;
+    m->data = frame.p_data != nullptr ? frame.p_data : "";
+    m->timecode = frame.timecode;
+    NDIlib_send_free_metadata(s->send, &frame);
+
+    status = napi_call_threadsafe_function(s->metadataFn, m, napi_tsfn_blocking);
+    if (status != napi_ok) {
+      delete m;
+      break;
     }
+  }
 
-    /*  initialize also timestamp (receiver-side only) and metadata  */
-    c->audioFrame.timestamp = 0;
-    c->audioFrame.p_metadata = NULL;
-
-    c->status = napi_get_named_property(env, config, "channelStrideBytes", &param);
-    REJECT_RETURN;
-    c->status = napi_typeof(env, param, &type);
-    REJECT_RETURN;
-    if (type != napi_number) REJECT_ERROR_RETURN(
-      "channelStrideBytes value must be a number",
-      GRANDIOSE_INVALID_ARGS);
-    c->status = napi_get_value_int32(env, param, &c->audioFrame.channel_stride_in_bytes);
-    REJECT_RETURN;
-
-    napi_value audioBuffer;
-    c->status = napi_get_named_property(env, config, "data", &audioBuffer);
-    REJECT_RETURN;
-    c->status = napi_is_buffer(env, audioBuffer, &isBuffer);
-    REJECT_RETURN;
-    if (!isBuffer) REJECT_ERROR_RETURN(
-      "data must be provided as a Node Buffer",
-      GRANDIOSE_INVALID_ARGS);
-    void * data;
-    size_t length;
-    c->status = napi_get_buffer_info(env, audioBuffer, &data, &length);
-    REJECT_RETURN;
-    c->audioFrame.p_data = (uint8_t *) data;
-    c->status = napi_create_reference(env, audioBuffer, 1, &c->sourceBufferRef);
-    REJECT_RETURN;
+  if (status != napi_closing) {
+    napi_release_threadsafe_function(s->metadataFn, napi_tsfn_release);
+  }
+}
 
-    c->status = napi_get_named_property(env, config, "fourCC", &param);
-    REJECT_RETURN;
-    c->status = napi_typeof(env, param, &type);
-    REJECT_RETURN;
-    if (type != napi_number) REJECT_ERROR_RETURN(
-      "fourCC value must be a number",
-      GRANDIOSE_INVALID_ARGS);
-    int32_t fourCC;
-    c->status = napi_get_value_int32(env, param, &fourCC);
-    REJECT_RETURN;
-    c->audioFrame.FourCC = (NDIlib_FourCC_audio_type_e)fourCC;
+void metadataCaptureCallJS(napi_env env, napi_value callback, void* context, void* data) {
+  capturedMetadata* m = (capturedMetadata*) data;
+  napi_status status;
 
-  } else REJECT_ERROR_RETURN(
-      "frame not provided",
-    GRANDIOSE_INVALID_ARGS);
+  if (env == nullptr) {
+    delete m;
+    return;
+  }
 
-  napi_value resource_name;
-  c->status = napi_create_string_utf8(env, "AudioSend", NAPI_AUTO_LENGTH, &resource_name);
-  REJECT_RETURN;
-  c->status = napi_create_async_work(env, NULL, resource_name, audioSendExecute,
-    audioSendComplete, c, &c->_request);
-  REJECT_RETURN;
-  c->status = napi_queue_async_work(env, c->_request);
-  REJECT_RETURN;
+  napi_value frame, undefined, result;
+  status = makeCapturedMetadata(env, m->data, m->timecode, &frame);
+  FLOATING_STATUS;
+  if (status == napi_ok) {
+    status = napi_get_undefined(env, &undefined);
+    FLOATING_STATUS;
+    status = napi_call_function(env, undefined, callback, 1, &frame, &result);
+    FLOATING_STATUS;
+  }
 
-  return promise;
+  delete m;
 }
 
-napi_value connections(napi_env env, napi_callback_info info) {
+void metadataCaptureFinalize(napi_env env, void* data, void* hint) {
+  sendInstance* s = (sendInstance*) hint;
   napi_status status;
 
-  size_t argc = 1;
-  napi_value args[1];
-  napi_value thisValue;
-  status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
-  CHECK_STATUS;
-
-  napi_value sendValue;
-  status = napi_get_named_property(env, thisValue, "embedded", &sendValue);
-  CHECK_STATUS;
-  void *sendData;
-  status = napi_get_value_external(env, sendValue, &sendData);
-  CHECK_STATUS;
-  NDIlib_send_instance_t sender = (NDIlib_send_instance_t)sendData;
+  s->capturingMetadata = false;
+  if (s->metadataThread.joinable()) {
+    s->metadataThread.join();
+  }
+  s->metadataFn = nullptr;
 
-  int conns = NDIlib_send_get_no_connections(sender, 0);
-  napi_value result;
-  status = napi_create_int32(env, (int32_t)conns, &result);
-  CHECK_STATUS;
+  if (s->metadataStopped != nullptr) {
+    napi_value undefined;
+    status = napi_get_undefined(env, &undefined);
+    FLOATING_STATUS;
+    status = napi_resolve_deferred(env, s->metadataStopped, undefined);
+    FLOATING_STATUS;
+    s->metadataStopped = nullptr;
+  }
 
-  return result;
+  releaseSend(s);
 }
 
-napi_value tally(napi_env env, napi_callback_info info) {
+// sender.startMetadataCapture(listener, [{ wait }]) starts a native thread
+// that calls the listener with each metadata frame sent to this sender.
+napi_value metadataCaptureStart(napi_env env, napi_callback_info info) {
   napi_status status;
+  napi_valuetype type;
 
-  size_t argc = 1;
-  napi_value args[1];
+  size_t argc = 2;
+  napi_value args[2];
   napi_value thisValue;
   status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
   CHECK_STATUS;
 
-  napi_value sendValue;
-  status = napi_get_named_property(env, thisValue, "embedded", &sendValue);
-  CHECK_STATUS;
-  void *sendData;
-  status = napi_get_value_external(env, sendValue, &sendData);
+  sendInstance* s;
+  status = getSendInstance(env, thisValue, &s);
   CHECK_STATUS;
-  NDIlib_send_instance_t sender = (NDIlib_send_instance_t)sendData;
-
-  NDIlib_tally_t tally;
-  bool changed = NDIlib_send_get_tally(sender, &tally, 0);
 
-  napi_value result;
-  status = napi_create_object(env, &result);
+  if (s->metadataFn != nullptr)
+    NAPI_THROW_ERROR("Sender metadata capture is already running.");
+  if (argc < 1)
+    NAPI_THROW_ERROR("Metadata capture must be started with a listener function.");
+  status = napi_typeof(env, args[0], &type);
   CHECK_STATUS;
+  if (type != napi_function)
+    NAPI_THROW_ERROR("Metadata capture must be started with a listener function.");
+
+  uint32_t wait = 100;
+  if (argc >= 2) {
+    status = napi_typeof(env, args[1], &type);
+    CHECK_STATUS;
+    if (type == napi_object) {
+      napi_value param;
+      status = napi_get_named_property(env, args[1], "wait", &param);
+      CHECK_STATUS;
+      status = napi_typeof(env, param, &type);
+      CHECK_STATUS;
+      if (type == napi_number) {
+        status = napi_get_value_uint32(env, param, &wait);
+        CHECK_STATUS;
+      }
+      else if (type != napi_undefined)
+        NAPI_THROW_ERROR("Metadata capture wait value must be a number if present.");
+    }
+    else if (type != napi_undefined)
+      NAPI_THROW_ERROR("Metadata capture options must be an object if present.");
+  }
 
-  napi_value value;
-  napi_get_boolean(env, changed, &value);
-  status = napi_set_named_property(env, result, "changed", value);
-  CHECK_STATUS;
-  napi_get_boolean(env, tally.on_program, &value);
-  status = napi_set_named_property(env, result, "on_program", value);
+  napi_value resource_name;
+  status = napi_create_string_utf8(env, "SendMetadataCapture", NAPI_AUTO_LENGTH, &resource_name);
   CHECK_STATUS;
-  napi_get_boolean(env, tally.on_preview, &value);
-  status = napi_set_named_property(env, result, "on_preview", value);
+  status = napi_create_threadsafe_function(env, args[0], nullptr, resource_name,
+    0, 1, nullptr, metadataCaptureFinalize, s, metadataCaptureCallJS, &s->metadataFn);
   CHECK_STATUS;
 
-  return result;
+  retainSend(s);
+  s->metadataWait = wait;
+  s->capturingMetadata = true;
+  s->metadataThread = std::thread(metadataCaptureLoop, s);
+
+  napi_value undefined;
+  status = napi_get_undefined(env, &undefined);
+  CHECK_STATUS;
+  return undefined;
 }
 
-napi_value sourcename(napi_env env, napi_callback_info info) {
-  napi_status status;
+// sender.stopMetadataCapture() resolves once the capture thread has finished
+// and every message it captured has been delivered.
+napi_value metadataCaptureStop(napi_env env, napi_callback_info info) {
+  carrier* c = new carrier;
+  napi_value promise;
+  c->status = napi_create_promise(env, &c->_deferred, &promise);
+  REJECT_RETURN;
 
-  size_t argc = 1;
-  napi_value args[1];
+  size_t argc = 0;
   napi_value thisValue;
-  status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
-  CHECK_STATUS;
+  c->status = napi_get_cb_info(env, info, &argc, nullptr, &thisValue, nullptr);
+  REJECT_RETURN;
 
-  napi_value sendValue;
-  status = napi_get_named_property(env, thisValue, "embedded", &sendValue);
-  CHECK_STATUS;
-  void *sendData;
-  status = napi_get_value_external(env, sendValue, &sendData);
-  CHECK_STATUS;
-  NDIlib_send_instance_t sender = (NDIlib_send_instance_t)sendData;
+  sendInstance* s;
+  c->status = getSendInstance(env, thisValue, &s);
+  REJECT_RETURN;
 
-  const NDIlib_source_t *source = NDIlib_send_get_source_name(sender);
-  napi_value result;
-  status = napi_create_string_utf8(env, source->p_ndi_name, NAPI_AUTO_LENGTH, &result);
-  CHECK_STATUS;
+  if (s->metadataFn == nullptr) {
+    napi_value undefined;
+    napi_get_undefined(env, &undefined);
+    napi_resolve_deferred(env, c->_deferred, undefined);
+  } else if (s->metadataStopped != nullptr) {
+    REJECT_ERROR_RETURN(
+      "Sender metadata capture is already stopping.",
+      GRANDIOSE_INVALID_ARGS);
+  } else {
+    s->metadataStopped = c->_deferred;
+    s->capturingMetadata = false;
+  }
 
-  return result;
+  delete c;
+  return promise;
 }
-
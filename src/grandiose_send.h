@@ -16,16 +16,166 @@
 #ifndef GRANDIOSE_SEND_H
 #define GRANDIOSE_SEND_H
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 #include "node_api.h"
 #include "grandiose_util.h"
+#include "grandiose_ring.h"
+#include "grandiose_convert.h"
+#include "grandiose_mux.h"
 
 napi_value send(napi_env env, napi_callback_info info);
+napi_value sendGroup(napi_env env, napi_callback_info info);
+
+typedef enum Grandiose_overflow_e {
+  Grandiose_overflow_block = 0,
+  Grandiose_overflow_drop_oldest = 1,
+  Grandiose_overflow_drop_newest = 2
+} Grandiose_overflow_e;
+
+struct sendDataCarrier;
+struct sendGroupCarrier;
+struct playoutInstance;
+
+// Region of a larger frame that is sent in its place, set by the roi
+// property of a frame or format. The region is sent from the same buffer,
+// with the line stride of the larger frame, so only packed formats can be
+// cropped.
+struct videoRegion {
+  bool set = false;
+  int32_t x = 0;
+  int32_t y = 0;
+  int32_t width = 0;
+  int32_t height = 0;
+};
+
+// Memory for one frame of a sender's pool, exposed as a Buffer. The pool holds
+// the Buffer until the sender is closed and the memory is freed when the
+// Buffer is collected.
+struct poolFrame {
+  uint8_t* data;
+  size_t size;
+  bool huge = false;
+  napi_ref bufferRef = nullptr;
+  bool acquired = false;
+  uint32_t inFlight = 0;
+};
+
+// Native sender shared by the JS sender object and by sends still in flight.
+// The NDI sender is destroyed once destroy() has been called, or the sender
+// object collected, and no sends remain outstanding.
+struct sendInstance {
+  NDIlib_send_instance_t send = nullptr;
+  napi_env env;
+  std::atomic<int32_t> refs { 1 };
+  bool external = true;
+  bool destroyed = false;
+  napi_deferred destroyedDeferred = nullptr;
+  // Set by transfer(), which hands the NDI sender on rather than destroying it
+  carrier* transfer = nullptr;
+  // Asynchronous video send: NDI reads from the last submitted buffer until
+  // the next submit or a flush, so its reference is held here until then.
+  bool asyncVideo = false;
+  napi_ref asyncBufferRef = nullptr;
+  poolFrame* asyncFrame = nullptr;
+  char* asyncMetadata = nullptr;
+  // Frames allocated by allocateFrames(). Main thread only.
+  std::vector<poolFrame*> pool;
+  // Video format set by configureVideo() for videoData(). Main thread only.
+  NDIlib_video_frame_v2_t videoFormat;
+  bool videoConfigured = false;
+  NDIlib_FourCC_video_type_e videoConvertTo = (NDIlib_FourCC_video_type_e) 0;
+  Grandiose_color_matrix_e videoColorMatrix = Grandiose_color_matrix_auto;
+  videoRegion videoRoi;
+  // Converted frames are written to alternate buffers, so that one can be
+  // filled while NDI reads the other. Sender's thread only.
+  uint8_t* scratch[2] = { nullptr, nullptr };
+  bool scratchHuge[2] = { false, false };
+  size_t scratchSize = 0;
+  uint32_t scratchNext = 0;
+  // Audio sliced to the video frames, once set up by configureAudio()
+  audioMux mux;
+  // With holdLastFrame, the last video frame is repeated with a synthesized
+  // timecode, and with silence, each time a frame is late. Unconverted frames
+  // are copied, while converted ones stay in scratch. Sender's thread only.
+  bool holdLastFrame = false;
+  bool holding = false;
+  NDIlib_video_frame_v2_t heldFrame;
+  uint8_t* holdData = nullptr;
+  bool holdHuge = false;
+  size_t holdSize = 0;
+  std::chrono::steady_clock::time_point holdDue;
+  uint64_t holdCadence = 0;
+  bool holdAudioSent = false;
+  int32_t holdSampleRate = 0;
+  int32_t holdChannels = 0;
+  std::vector<float> holdSilence;
+  std::atomic<bool> holdSuspended { false };
+  std::atomic<uint64_t> repeated { 0 };
+  std::atomic<uint64_t> stalls { 0 };
+  // File being played by sender.playFile(). Main thread only.
+  playoutInstance* playout = nullptr;
+  // Frames are sent in order on the sender's own thread, fed by a bounded
+  // queue. Frames waiting for room, and control work such as flush() that
+  // is never dropped, are held on the main thread in waiting.
+  frameRing<sendDataCarrier>* queue = nullptr;
+  Grandiose_overflow_e overflow = Grandiose_overflow_block;
+  std::deque<sendDataCarrier*> waiting;
+  std::thread sendThread;
+  std::atomic<bool> stopping { false };
+  std::atomic<bool> sleeping { false };
+  bool closing = false;
+  std::mutex wakeLock;
+  std::condition_variable wake;
+  napi_threadsafe_function completeFn = nullptr;
+  uint32_t outstanding = 0;
+  std::atomic<uint64_t> submitted { 0 };
+  std::atomic<uint64_t> sent { 0 };
+  std::atomic<uint64_t> dropped { 0 };
+  // Tally and connection monitoring started with sender.startMonitor()
+  std::thread monitorThread;
+  std::atomic<bool> monitoring { false };
+  napi_threadsafe_function monitorFn = nullptr;
+  napi_deferred monitorStopped = nullptr;
+  uint32_t monitorWait = 100;
+  // Back-channel metadata capture started with sender.startMetadataCapture()
+  std::thread metadataThread;
+  std::atomic<bool> capturingMetadata { false };
+  napi_threadsafe_function metadataFn = nullptr;
+  napi_deferred metadataStopped = nullptr;
+  uint32_t metadataWait = 100;
+  ~sendInstance() {
+    delete queue;
+    for ( int x = 0 ; x < 2 ; x++ )
+      if (scratch[x] != nullptr) freeFrameMemory(scratch[x], scratchSize, scratchHuge[x]);
+    if (holdData != nullptr) freeFrameMemory(holdData, holdSize, holdHuge);
+    delete transfer;
+  }
+};
+
+void retainSend(sendInstance* s);
+void releaseSend(sendInstance* s);
+void recycleFrame(poolFrame* f);
+void sendComplete(napi_env env, napi_status asyncStatus, void* data);
+napi_status getSendInstance(napi_env env, napi_value thisValue, sendInstance** s);
+void parseOptionalInt32(napi_env env, napi_value config, const char* name,
+  int32_t* value, carrier* c);
 
 struct sendCarrier : carrier {
   char* name = nullptr;
   char* groups = nullptr;
   bool clockVideo = false;
   bool clockAudio = false;
+  bool asyncVideo = false;
+  bool holdLastFrame = false;
+  uint32_t queueDepth = 4;
+  Grandiose_overflow_e overflow = Grandiose_overflow_block;
   NDIlib_send_instance_t send;
   ~sendCarrier() {
     free(name);
@@ -33,15 +183,64 @@ struct sendCarrier : carrier {
 };
 
 struct sendDataCarrier : carrier {
+  sendInstance* instance = nullptr;
+  // Run on the sender's thread and then on the main thread
+  napi_async_execute_callback execute;
+  napi_async_complete_callback complete;
+  bool droppable = true;
   NDIlib_send_instance_t send;
   NDIlib_video_frame_v2_t videoFrame;
   NDIlib_audio_frame_v3_t audioFrame;
   NDIlib_metadata_frame_t metadataFrame;
   napi_ref sourceBufferRef = nullptr;
+  poolFrame* sourceFrame = nullptr;
+  // Format that video is converted to on the sender's thread, if any
+  NDIlib_FourCC_video_type_e convertTo = (NDIlib_FourCC_video_type_e) 0;
+  Grandiose_color_matrix_e colorMatrix = Grandiose_color_matrix_auto;
+  // Part of the frame to send, applied once the buffer has been checked
+  videoRegion region;
+  // Previous async video buffer that NDI has finished with
+  napi_ref releaseBufferRef = nullptr;
+  poolFrame* releaseFrame = nullptr;
+  // Metadata attached to a video or audio frame
+  char* frameMetadata = nullptr;
+  char* releaseMetadata = nullptr;
+  // Set on each sender's part of a frame sent by a send group, which is sent
+  // synchronously so that the group's buffer is finished with on completion
+  sendGroupCarrier* group = nullptr;
+  bool synchronous = false;
+  // Metadata frames for sender.metadata(), sent as one piece of work, or
+  // the frame received by sender.captureMetadata()
+  std::vector<std::string> metadata;
+  uint32_t wait = 10000;
   ~sendDataCarrier() {
-    // TODO: free sourceBufferRef
+    free(frameMetadata);
+    free(releaseMetadata);
+    if (instance != nullptr) {
+      if (sourceBufferRef != nullptr)
+        napi_delete_reference(instance->env, sourceBufferRef);
+      if (releaseBufferRef != nullptr)
+        napi_delete_reference(instance->env, releaseBufferRef);
+      recycleFrame(sourceFrame);
+      recycleFrame(releaseFrame);
+      releaseSend(instance);
+    }
   }
 };
 
+// A video frame sent by group.video(). It holds the frame's buffer and is
+// settled once every sender in the group has sent or dropped the frame.
+struct sendGroupCarrier : sendDataCarrier {
+  uint32_t pending = 0;
+  uint32_t sent = 0;
+  uint32_t dropped = 0;
+};
+
+// Sender objects of a group created with grandiose.sendGroup(), looked up
+// on each send so that the group does not keep destroyed senders open
+struct sendGroupInstance {
+  napi_ref senders = nullptr;
+  uint32_t length = 0;
+};
 
 #endif /* GRANDIOSE_SEND_H */
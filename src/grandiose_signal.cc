@@ -0,0 +1,311 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "grandiose_signal.h"
+#include "grandiose_util.h"
+#include "grandiose_mux.h"
+
+static const double pi = 3.14159265358979323846;
+
+// Digits of 5 by 7 blocks, with bit 0x10 as the leftmost column
+static const uint8_t digitFont[10][7] = {
+  { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E },
+  { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E },
+  { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F },
+  { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E },
+  { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 },
+  { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E },
+  { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E },
+  { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 },
+  { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E },
+  { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C }
+};
+
+// The counter shows eight digits, in a box with a border of one block
+static const int32_t counterDigits = 8;
+static const int32_t boxColumns = counterDigits * 6 + 1;
+static const int32_t boxRows = 9;
+
+static const struct {
+  const char* name;
+  Grandiose_pattern_e pattern;
+} patternNames[] = {
+  { "bars", Grandiose_pattern_bars },
+  { "ramp", Grandiose_pattern_ramp },
+  { "zoneplate", Grandiose_pattern_zoneplate },
+  { "frameCounter", Grandiose_pattern_frame_counter }
+};
+
+bool parsePattern(const std::string& name, Grandiose_pattern_e* pattern) {
+  for ( auto& entry : patternNames ) {
+    if (name == entry.name) {
+      *pattern = entry.pattern;
+      return true;
+    }
+  }
+  return false;
+}
+
+const char* patternName(Grandiose_pattern_e pattern) {
+  for ( auto& entry : patternNames )
+    if (entry.pattern == pattern) return entry.name;
+  return "unknown";
+}
+
+testSignal::~testSignal() {
+  for ( int x = 0 ; x < 2 ; x++ )
+    if (frames[x] != nullptr) freeFrameMemory(frames[x], frameBytes, huge[x]);
+}
+
+bool prepareSignal(testSignal* t) {
+  t->matrix = resolveColorMatrix(Grandiose_color_matrix_auto, t->yres);
+  if (t->fourCC == NDIlib_FourCC_video_type_UYVY) {
+    t->lineStride = t->xres * 2;
+    t->frameBytes = (size_t) t->lineStride * t->yres;
+  } else {
+    t->frameBytes = outputFrameBytes(t->fourCC, t->xres, t->yres, &t->lineStride);
+    t->uyvy.resize((size_t) t->xres * 2 * t->yres);
+  }
+  for ( int x = 0 ; x < 2 ; x++ ) {
+    t->frames[x] = (uint8_t*) allocateFrameMemory(t->frameBytes, false, &t->huge[x]);
+    if (t->frames[x] == nullptr) return false;
+  }
+
+  // The frame counter fills the middle of its own pattern, and is otherwise
+  // kept small in the top left corner
+  if (t->pattern == Grandiose_pattern_frame_counter)
+    t->scale = std::min(t->yres / (boxRows * 2), t->xres / (boxColumns + 4));
+  else
+    t->scale = std::min(std::max(t->yres / 108, 2), t->xres / (boxColumns + 4));
+  if (t->pattern == Grandiose_pattern_frame_counter) {
+    t->boxX = (t->xres - boxColumns * t->scale) / 2;
+    t->boxY = (t->yres - boxRows * t->scale) / 2;
+  } else {
+    t->boxX = t->scale * 2;
+    t->boxY = t->scale * 2;
+  }
+  // Keep the box on whole UYVY pixel pairs
+  t->boxX &= ~1;
+  if ((t->boxX + boxColumns * t->scale > t->xres) || (t->boxY + boxRows * t->scale > t->yres))
+    t->scale = 0;
+  return true;
+}
+
+struct ycbcr {
+  uint8_t y, cb, cr;
+};
+
+// Limited range Y'CbCr of an RGB colour with components from 0 to 1
+static ycbcr colorOf(double r, double g, double b, Grandiose_color_matrix_e matrix) {
+  double kr = 0.2126, kb = 0.0722;
+  if (matrix == Grandiose_color_matrix_bt601) {
+    kr = 0.299;
+    kb = 0.114;
+  } else if (matrix == Grandiose_color_matrix_bt2020) {
+    kr = 0.2627;
+    kb = 0.0593;
+  }
+  double y = kr * r + (1.0 - kr - kb) * g + kb * b;
+  ycbcr c;
+  c.y = (uint8_t) std::lround(16.0 + 219.0 * y);
+  c.cb = (uint8_t) std::lround(128.0 + 224.0 * (b - y) / (2.0 * (1.0 - kb)));
+  c.cr = (uint8_t) std::lround(128.0 + 224.0 * (r - y) / (2.0 * (1.0 - kr)));
+  return c;
+}
+
+// Copies the first line of a UYVY frame down to the lines below it
+static void repeatLine(uint8_t* dst, int32_t stride, int32_t yres) {
+  for ( int32_t y = 1 ; y < yres ; y++ )
+    memcpy(dst + (size_t) y * stride, dst, stride);
+}
+
+// 75% colour bars: white, yellow, cyan, green, magenta, red and blue
+static void drawBars(testSignal* t, uint8_t* dst) {
+  static const double bars[7][3] = {
+    { 0.75, 0.75, 0.75 }, { 0.75, 0.75, 0.0 }, { 0.0, 0.75, 0.75 }, { 0.0, 0.75, 0.0 },
+    { 0.75, 0.0, 0.75 }, { 0.75, 0.0, 0.0 }, { 0.0, 0.0, 0.75 }
+  };
+  for ( int32_t x = 0 ; x < t->xres / 2 ; x++ ) {
+    int32_t bar = x * 2 * 7 / t->xres;
+    ycbcr c = colorOf(bars[bar][0], bars[bar][1], bars[bar][2], t->matrix);
+    uint8_t* pair = dst + x * 4;
+    pair[0] = c.cb;
+    pair[1] = c.y;
+    pair[2] = c.cr;
+    pair[3] = c.y;
+  }
+  repeatLine(dst, t->xres * 2, t->yres);
+}
+
+// Mid grey behind the frame counter
+static void drawGrey(testSignal* t, uint8_t* dst) {
+  for ( int32_t x = 0 ; x < t->xres * 2 ; x += 2 ) {
+    dst[x] = 128;
+    dst[x + 1] = 126;
+  }
+  repeatLine(dst, t->xres * 2, t->yres);
+}
+
+// Luma ramp from black to white, moving one sweep every two hundred frames
+static void drawRamp(testSignal* t, uint8_t* dst, uint64_t frame) {
+  uint32_t width = (uint32_t) t->xres;
+  uint32_t shift = (uint32_t) ((frame * width / 200) % width);
+  for ( uint32_t x = 0 ; x < width ; x++ ) {
+    uint32_t at = (x + shift) % width;
+    dst[x * 2] = 128;
+    dst[x * 2 + 1] = (uint8_t) (16 + at * 220 / width);
+  }
+  repeatLine(dst, t->xres * 2, t->yres);
+}
+
+// Circular zone plate, reaching half the sample rate at the left and right
+// edges, with a phase that moves on each frame. Lines either side of the
+// centre are the same, so only the top half is calculated.
+static void drawZoneplate(testSignal* t, uint8_t* dst, uint64_t frame) {
+  // Luma of one cycle, made once for all senders
+  static const std::vector<float> cosine = [] {
+    std::vector<float> table(1024);
+    for ( int x = 0 ; x < 1024 ; x++ )
+      table[x] = (float) (16.0 + 109.5 + 109.5 * std::cos(2.0 * pi * x / 1024.0));
+    return table;
+  }();
+
+  int32_t stride = t->xres * 2;
+  int32_t cx = t->xres / 2;
+  int32_t cy = t->yres / 2;
+  // Phase of k * r^2, in steps of the table, with 2 * k * cx = half a cycle
+  float k = 256.0f / (float) std::max(cx, 1);
+  float phase = (float) ((frame * 16) % 1024);
+  for ( int32_t y = 0 ; y < t->yres ; y++ ) {
+    uint8_t* line = dst + (size_t) y * stride;
+    int32_t mirror = 2 * cy - y;
+    if ((y > cy) && (mirror >= 0)) {
+      memcpy(line, dst + (size_t) mirror * stride, stride);
+      continue;
+    }
+    float dy2 = (float) ((y - cy) * (y - cy));
+    for ( int32_t x = 0 ; x < t->xres ; x++ ) {
+      float dx = (float) (x - cx);
+      uint32_t at = (uint32_t) ((dx * dx + dy2) * k + phase) & 1023;
+      line[x * 2] = 128;
+      line[x * 2 + 1] = (uint8_t) cosine[at];
+    }
+  }
+}
+
+// Burns the frame number into its box
+static void drawCounter(testSignal* t, uint8_t* dst, uint64_t frame) {
+  if (t->scale <= 0) return;
+  int32_t stride = t->xres * 2;
+  int32_t width = boxColumns * t->scale;
+  uint8_t digits[counterDigits];
+  uint64_t value = frame;
+  for ( int32_t d = counterDigits - 1 ; d >= 0 ; d-- ) {
+    digits[d] = (uint8_t) (value % 10);
+    value /= 10;
+  }
+
+  // Each row of blocks is drawn once, then copied down to the lines below
+  std::vector<uint8_t> line((size_t) width * 2);
+  for ( int32_t row = 0 ; row < boxRows ; row++ ) {
+    for ( int32_t column = 0 ; column < boxColumns ; column++ ) {
+      bool lit = false;
+      int32_t d = (column - 1) / 6;
+      int32_t bit = (column - 1) % 6;
+      if ((row > 0) && (row < boxRows - 1) && (column > 0) && (bit < 5))
+        lit = ((digitFont[digits[d]][row - 1] >> (4 - bit)) & 1) != 0;
+      uint8_t* block = line.data() + (size_t) column * t->scale * 2;
+      for ( int32_t x = 0 ; x < t->scale ; x++ ) {
+        block[x * 2] = 128;
+        block[x * 2 + 1] = lit ? 235 : 16;
+      }
+    }
+    for ( int32_t y = 0 ; y < t->scale ; y++ ) {
+      uint8_t* to = dst + (size_t) (t->boxY + row * t->scale + y) * stride + t->boxX * 2;
+      memcpy(to, line.data(), line.size());
+    }
+  }
+}
+
+uint8_t* renderSignal(testSignal* t, uint64_t frame) {
+  uint32_t index = t->next;
+  t->next = 1 - t->next;
+  bool convert = t->fourCC != NDIlib_FourCC_video_type_UYVY;
+  uint8_t* dst = convert ? t->uyvy.data() : t->frames[index];
+  // Converted frames are all drawn from the one UYVY buffer
+  bool& drawn = t->drawn[convert ? 0 : index];
+
+  switch (t->pattern) {
+    case Grandiose_pattern_bars:
+      if (!drawn) drawBars(t, dst);
+      break;
+    case Grandiose_pattern_frame_counter:
+      if (!drawn) drawGrey(t, dst);
+      break;
+    case Grandiose_pattern_ramp:
+      drawRamp(t, dst, frame);
+      break;
+    case Grandiose_pattern_zoneplate:
+      drawZoneplate(t, dst, frame);
+      break;
+  }
+  drawn = true;
+  drawCounter(t, dst, frame);
+
+  if (convert) {
+    NDIlib_video_frame_v2_t src;
+    src.xres = t->xres;
+    src.yres = t->yres;
+    src.FourCC = NDIlib_FourCC_video_type_UYVY;
+    src.p_data = t->uyvy.data();
+    src.line_stride_in_bytes = t->xres * 2;
+    convertFromYUV(&src, t->frames[index], t->fourCC, t->lineStride, t->matrix, false);
+  }
+  return t->frames[index];
+}
+
+void sendSignalAudio(testSignal* t, NDIlib_send_instance_t send, uint64_t frame,
+    int32_t frameRateN, int32_t frameRateD) {
+  if (t->channels <= 0) return;
+  uint64_t start = cadenceStart(frame, t->sampleRate, frameRateN, frameRateD);
+  uint64_t end = cadenceStart(frame + 1, t->sampleRate, frameRateN, frameRateD);
+  uint32_t samples = (uint32_t) (end - start);
+  t->audio.resize((size_t) samples * t->channels);
+
+  // A whole number of cycles fits in each second, so the phase is taken
+  // from the sample within its second
+  float* first = t->audio.data();
+  for ( uint32_t x = 0 ; x < samples ; x++ ) {
+    uint64_t n = (start + x) % (uint64_t) t->sampleRate;
+    first[x] = t->toneLevel * (float) std::sin(2.0 * pi * t->toneFrequency * n / t->sampleRate);
+  }
+  for ( int32_t ch = 1 ; ch < t->channels ; ch++ )
+    memcpy(first + (size_t) ch * samples, first, samples * sizeof(float));
+
+  NDIlib_audio_frame_v3_t audioFrame;
+  audioFrame.sample_rate = t->sampleRate;
+  audioFrame.no_channels = t->channels;
+  audioFrame.no_samples = (int) samples;
+  audioFrame.timecode = NDIlib_send_timecode_synthesize;
+  audioFrame.FourCC = NDIlib_FourCC_audio_type_FLTP;
+  audioFrame.p_data = (uint8_t*) first;
+  audioFrame.channel_stride_in_bytes = (int) (samples * sizeof(float));
+  audioFrame.p_metadata = nullptr;
+  audioFrame.timestamp = 0;
+  NDIlib_send_send_audio_v3(send, &audioFrame);
+}
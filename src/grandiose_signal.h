@@ -0,0 +1,77 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef GRANDIOSE_SIGNAL_H
+#define GRANDIOSE_SIGNAL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <Processing.NDI.Lib.h>
+#include "grandiose_convert.h"
+
+typedef enum Grandiose_pattern_e {
+  Grandiose_pattern_bars = 0,
+  Grandiose_pattern_ramp = 1,
+  Grandiose_pattern_zoneplate = 2,
+  Grandiose_pattern_frame_counter = 3
+} Grandiose_pattern_e;
+
+bool parsePattern(const std::string& name, Grandiose_pattern_e* pattern);
+const char* patternName(Grandiose_pattern_e pattern);
+
+// Frames of a test signal, started with sender.testSignal(), each with the
+// frame number burned in. Patterns are rendered as UYVY and converted with
+// convertFromYUV when another format is sent. Frames are rendered in turn
+// into two buffers, so that one can be filled while NDI reads the other.
+struct testSignal {
+  Grandiose_pattern_e pattern = Grandiose_pattern_bars;
+  NDIlib_FourCC_video_type_e fourCC = NDIlib_FourCC_video_type_UYVY;
+  int32_t xres = 0;
+  int32_t yres = 0;
+  int32_t lineStride = 0;
+  Grandiose_color_matrix_e matrix = Grandiose_color_matrix_bt709;
+  uint8_t* frames[2] = { nullptr, nullptr };
+  bool huge[2] = { false, false };
+  size_t frameBytes = 0;
+  uint32_t next = 0;
+  // Rendered UYVY, when another format is sent. Patterns that do not move
+  // are only drawn once, in each buffer they are drawn into.
+  std::vector<uint8_t> uyvy;
+  bool drawn[2] = { false, false };
+  // Frame number, in a box of scale by scale blocks at (boxX, boxY)
+  int32_t scale = 0;
+  int32_t boxX = 0;
+  int32_t boxY = 0;
+  // Tone of toneFrequency Hz at toneLevel, the same on every channel
+  int32_t sampleRate = 0;
+  int32_t channels = 0;
+  int32_t toneFrequency = 1000;
+  float toneLevel = 0.1f;
+  std::vector<float> audio;
+  ~testSignal();
+};
+
+// Allocates the signal's buffers once its format is set
+bool prepareSignal(testSignal* t);
+
+// Renders the given frame of the signal, returning the buffer to send
+uint8_t* renderSignal(testSignal* t, uint64_t frame);
+
+// Sends the tone that spans the given frame at the frame rate N/D
+void sendSignalAudio(testSignal* t, NDIlib_send_instance_t send, uint64_t frame,
+  int32_t frameRateN, int32_t frameRateD);
+
+#endif /* GRANDIOSE_SIGNAL_H */
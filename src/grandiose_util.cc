@@ -19,9 +19,18 @@
 #include <chrono>
 #include <string>
 #include <algorithm>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+#include <vector>
 #include <Processing.NDI.Lib.h>
 #include "grandiose_util.h"
 #include "node_api.h"
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
 using namespace std;
 
 // Implementation of itoa()
@@ -61,7 +70,7 @@ char* custom_itoa(int num, char* str, int base)
   str[i] = '\0'; // Append string terminator
 
   // Reverse the string
-  std::reverse(std::string(str).begin(), std::string(str).end());
+  std::reverse(str, str + i);
 
   return str;
 }
@@ -280,3 +289,109 @@ napi_status makeNativeSource(napi_env env, napi_value source, NDIlib_source_t *r
   return napi_ok;
 }
 
+grandioseEnv* getGrandioseEnv(napi_env env) {
+  void* data = nullptr;
+  napi_status status = napi_get_instance_data(env, &data);
+  if (status != napi_ok) return nullptr;
+  return (grandioseEnv*) data;
+}
+
+// Offered carriers, shared by every environment in the process
+struct transferEntry {
+  carrier* c;
+  const char* kind;
+  napi_env owner;
+  void (*cancel)(carrier*);
+};
+static std::mutex transferLock;
+static std::unordered_map<std::string, transferEntry> transfers;
+
+// Returns a string token, which survives postMessage and workerData. Tokens
+// are random, so that one worker cannot guess another's.
+std::string offerTransfer(napi_env env, carrier* c, const char* kind,
+    void (*cancel)(carrier*)) {
+  std::random_device device;
+  char id[33];
+  std::string token;
+  std::lock_guard<std::mutex> lock(transferLock);
+  do {
+    for ( int x = 0 ; x < 4 ; x++ )
+      sprintf(id + x * 8, "%08x", (uint32_t) device());
+    token = std::string("grandiose:") + kind + ":" + id;
+  } while (transfers.find(token) != transfers.end());
+  transfers[token] = { c, kind, env, cancel };
+  return token;
+}
+
+// Releases whatever the environment offered that was never adopted
+void cancelTransfers(napi_env env) {
+  std::vector<transferEntry> cancelled;
+  {
+    std::lock_guard<std::mutex> lock(transferLock);
+    for ( auto it = transfers.begin() ; it != transfers.end() ; ) {
+      if (it->second.owner == env) {
+        cancelled.push_back(it->second);
+        it = transfers.erase(it);
+      }
+      else
+        it++;
+    }
+  }
+  for ( auto e : cancelled )
+    e.cancel(e.c);
+}
+
+// Each token can be adopted once, returning nullptr if it is unknown
+carrier* takeTransfer(const std::string& token, const char** kind) {
+  std::lock_guard<std::mutex> lock(transferLock);
+  auto it = transfers.find(token);
+  if (it == transfers.end()) return nullptr;
+  carrier* c = it->second.c;
+  *kind = it->second.kind;
+  transfers.erase(it);
+  return c;
+}
+
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+void* allocateFrameMemory(size_t size, bool hugePages, bool* huge) {
+  *huge = false;
+#ifdef _WIN32
+  // Large pages on Windows need a privilege that is rarely granted
+  return _aligned_malloc(size, 64);
+#else
+  void* data = nullptr;
+  if (hugePages) {
+#ifdef MAP_HUGETLB
+    size_t mapSize = (size + HUGE_PAGE_SIZE - 1) & ~((size_t) HUGE_PAGE_SIZE - 1);
+    data = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (data != MAP_FAILED) {
+      *huge = true;
+      return data;
+    }
+#endif
+    // No reserved huge pages, so ask for transparent huge pages instead
+    if (posix_memalign(&data, HUGE_PAGE_SIZE, size) != 0) return nullptr;
+#ifdef MADV_HUGEPAGE
+    madvise(data, size, MADV_HUGEPAGE);
+#endif
+    return data;
+  }
+  if (posix_memalign(&data, 64, size) != 0) return nullptr;
+  return data;
+#endif
+}
+
+void freeFrameMemory(void* data, size_t size, bool huge) {
+#ifdef _WIN32
+  _aligned_free(data);
+#else
+  if (huge) {
+    size_t mapSize = (size + HUGE_PAGE_SIZE - 1) & ~((size_t) HUGE_PAGE_SIZE - 1);
+    munmap(data, mapSize);
+  }
+  else
+    free(data);
+#endif
+}
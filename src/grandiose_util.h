@@ -110,6 +110,14 @@ int32_t rejectStatus(napi_env env, carrier* c, const char* file, int32_t line);
   REJECT_RETURN; \
 }
 
+// For helpers that validate into a carrier, leaving rejection to the caller
+#define CARRIER_STATUS if (c->status != GRANDIOSE_SUCCESS) return;
+#define CARRIER_ERROR(msg, stat) { \
+  c->errorMsg = msg; \
+  c->status = stat; \
+  return; \
+}
+
 bool validColorFormat(NDIlib_recv_color_format_e format);
 bool validBandwidth(NDIlib_recv_bandwidth_e bandwidth);
 bool validFrameFormat(NDIlib_frame_format_type_e format);
@@ -117,4 +125,31 @@ bool validAudioFormat(Grandiose_audio_format_e format);
 
 napi_status makeNativeSource(napi_env env, napi_value source, NDIlib_source_t *result);
 
+// State of the addon in one environment, the main thread or a worker thread,
+// held as the environment's instance data so that each worker that loads the
+// addon owns its own senders, receivers and completions.
+struct completionQueue;
+struct grandioseEnv {
+  // Whether this environment holds a reference on the NDI library
+  bool ndiInitialized = false;
+  // Marshals worker lane completions to this environment's thread
+  completionQueue* completion = nullptr;
+};
+
+grandioseEnv* getGrandioseEnv(napi_env env);
+
+// Senders and receivers handed to another environment with transfer(). The
+// carrier is held against a token until adopt() completes it in the adopting
+// environment, as if the sender or receiver had just been created there. If
+// the offering environment is torn down first, cancel releases the carrier.
+std::string offerTransfer(napi_env env, carrier* c, const char* kind,
+  void (*cancel)(carrier*));
+carrier* takeTransfer(const std::string& token, const char** kind);
+void cancelTransfers(napi_env env);
+
+// Frame memory aligned to 64 bytes for SIMD. Where supported, hugePages asks
+// for memory backed by huge pages, setting *huge if the request was honoured.
+void* allocateFrameMemory(size_t size, bool hugePages, bool* huge);
+void freeFrameMemory(void* data, size_t size, bool huge);
+
 #endif // GRANDIOSE_UTIL_H